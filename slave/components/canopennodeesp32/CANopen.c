@@ -19,6 +19,8 @@
  */
 
 #include "CANopen.h"
+#include "co_profiler.h"
+#include <string.h>
 
 /* Get values from CO_config_t or from single default OD.h ********************/
 #ifdef CO_MULTIPLE_OD
@@ -255,6 +257,11 @@
 #define OD_CNT_GTWA 1
 #endif
 
+#ifndef CO_CONFIG_LOADGEN_TX_CNT
+#define CO_CONFIG_LOADGEN_TX_CNT 0
+#endif
+#define CO_TX_CNT_LOADGEN CO_CONFIG_LOADGEN_TX_CNT
+
 #if (CO_CONFIG_TRACE) & CO_CONFIG_TRACE_ENABLE
 #if !defined OD_CNT_TRACE
 #define OD_CNT_TRACE 0
@@ -295,7 +302,8 @@
 #define CO_TX_IDX_NG_MST   (CO_TX_IDX_NG_SLV + (uint16_t)CO_TX_CNT_NG_SLV)
 #define CO_TX_IDX_LSS_SLV  (CO_TX_IDX_NG_MST + (uint16_t)CO_TX_CNT_NG_MST)
 #define CO_TX_IDX_LSS_MST  (CO_TX_IDX_LSS_SLV + (uint16_t)CO_TX_CNT_LSS_SLV)
-#define CO_CNT_ALL_TX_MSGS (CO_TX_IDX_LSS_MST + (uint16_t)CO_TX_CNT_LSS_MST)
+#define CO_TX_IDX_LOADGEN  (CO_TX_IDX_LSS_MST + (uint16_t)CO_TX_CNT_LSS_MST)
+#define CO_CNT_ALL_TX_MSGS (CO_TX_IDX_LOADGEN + (uint16_t)CO_TX_CNT_LOADGEN)
 #endif /* #ifdef #else CO_MULTIPLE_OD */
 
 /* Objects from heap **********************************************************/
@@ -642,6 +650,10 @@ CO_new(CO_config_t* config, uint32_t* heapMemoryUsed) {
 #if ((CO_CONFIG_LSS)&CO_CONFIG_LSS_MASTER) != 0
         co->TX_IDX_LSS_MST = idxTx;
         idxTx += TX_CNT_LSS_MST;
+#endif
+#if CO_CONFIG_LOADGEN_TX_CNT > 0
+        /* load generator buffers are the last ones */
+        idxTx += CO_CONFIG_LOADGEN_TX_CNT;
 #endif
         co->CNT_ALL_TX_MSGS = idxTx;
 #endif /* #ifdef CO_MULTIPLE_OD */
@@ -831,10 +843,14 @@ static int32_t COO_traceValueBuffers[OD_CNT_TRACE][CO_TRACE_BUFFER_SIZE_FIXED];
 CO_t*
 CO_new(CO_config_t* config, uint32_t* heapMemoryUsed) {
     (void)config;
-    (void)heapMemoryUsed;
 
     CO_t* co = &COO;
 
+    if (heapMemoryUsed != NULL) {
+        *heapMemoryUsed = 0U;
+    }
+    co->nodeIdUnconfigured = true;
+
     co->CANmodule = &COO_CANmodule;
     co->CANrx = &COO_CANmodule_rxArray[0];
     co->CANtx = &COO_CANmodule_txArray[0];
@@ -910,6 +926,86 @@ CO_delete(CO_t* co) {
 #endif /* #ifdef CO_USE_GLOBALS */
 
 /* Helper functions ***********************************************************/
+void
+CO_getMemoryUsage(CO_t* co, CO_memoryUsage_t* usage) {
+    (void)co; /* may be unused */
+    if (usage == NULL) {
+        return;
+    }
+    (void)memset(usage, 0, sizeof(*usage));
+
+    usage->CO = sizeof(CO_t);
+    usage->NMT = (uint32_t)CO_GET_CNT(NMT) * sizeof(CO_NMT_t);
+#if ((CO_CONFIG_NODE_GUARDING)&CO_CONFIG_NODE_GUARDING_SLAVE_ENABLE) != 0
+    usage->NMT += sizeof(CO_nodeGuardingSlave_t);
+#endif
+#if ((CO_CONFIG_NODE_GUARDING)&CO_CONFIG_NODE_GUARDING_MASTER_ENABLE) != 0
+    usage->NMT += sizeof(CO_nodeGuardingMaster_t);
+#endif
+#if ((CO_CONFIG_HB_CONS)&CO_CONFIG_HB_CONS_ENABLE) != 0
+    if (CO_GET_CNT(HB_CONS) == 1U) {
+        usage->HBcons = sizeof(CO_HBconsumer_t) + ((uint32_t)CO_GET_CNT(ARR_1016) * sizeof(CO_HBconsNode_t));
+    }
+#endif
+    if (CO_GET_CNT(EM) == 1U) {
+        usage->EM = sizeof(CO_EM_t);
+#if ((CO_CONFIG_EM) & (CO_CONFIG_EM_PRODUCER | CO_CONFIG_EM_HISTORY)) != 0
+        if ((CO_GET_CNT(ARR_1003) + 1U) >= 2U) {
+            usage->EM += ((uint32_t)CO_GET_CNT(ARR_1003) + 1U) * sizeof(CO_EM_fifo_t);
+        }
+#endif
+    }
+    usage->SDOserver = (uint32_t)CO_GET_CNT(SDO_SRV) * sizeof(CO_SDOserver_t);
+#if ((CO_CONFIG_SDO_CLI)&CO_CONFIG_SDO_CLI_ENABLE) != 0
+    usage->SDOclient = (uint32_t)CO_GET_CNT(SDO_CLI) * sizeof(CO_SDOclient_t);
+#endif
+#if ((CO_CONFIG_TIME)&CO_CONFIG_TIME_ENABLE) != 0
+    usage->TIME = (uint32_t)CO_GET_CNT(TIME) * sizeof(CO_TIME_t);
+#endif
+#if ((CO_CONFIG_SYNC)&CO_CONFIG_SYNC_ENABLE) != 0
+    usage->SYNC = (uint32_t)CO_GET_CNT(SYNC) * sizeof(CO_SYNC_t);
+#endif
+#if ((CO_CONFIG_PDO)&CO_CONFIG_RPDO_ENABLE) != 0
+    usage->RPDO = (uint32_t)CO_GET_CNT(RPDO) * sizeof(CO_RPDO_t);
+#endif
+#if ((CO_CONFIG_PDO)&CO_CONFIG_TPDO_ENABLE) != 0
+    usage->TPDO = (uint32_t)CO_GET_CNT(TPDO) * sizeof(CO_TPDO_t);
+#endif
+#if ((CO_CONFIG_LEDS)&CO_CONFIG_LEDS_ENABLE) != 0
+    usage->LEDs = (uint32_t)CO_GET_CNT(LEDS) * sizeof(CO_LEDs_t);
+#endif
+#if ((CO_CONFIG_LSS)&CO_CONFIG_LSS_SLAVE) != 0
+    usage->LSS += (uint32_t)CO_GET_CNT(LSS_SLV) * sizeof(CO_LSSslave_t);
+#endif
+#if ((CO_CONFIG_LSS)&CO_CONFIG_LSS_MASTER) != 0
+    usage->LSS += (uint32_t)CO_GET_CNT(LSS_MST) * sizeof(CO_LSSmaster_t);
+#endif
+#if ((CO_CONFIG_GFC)&CO_CONFIG_GFC_ENABLE) != 0
+    usage->other += (uint32_t)CO_GET_CNT(GFC) * sizeof(CO_GFC_t);
+#endif
+#if ((CO_CONFIG_SRDO)&CO_CONFIG_SRDO_ENABLE) != 0
+    if (CO_GET_CNT(SRDO) > 0U) {
+        usage->other += sizeof(CO_SRDOGuard_t) + ((uint32_t)CO_GET_CNT(SRDO) * sizeof(CO_SRDO_t));
+    }
+#endif
+#if ((CO_CONFIG_GTW)&CO_CONFIG_GTW_ASCII) != 0
+    usage->other += (uint32_t)CO_GET_CNT(GTWA) * sizeof(CO_GTWA_t);
+#endif
+#if ((CO_CONFIG_TRACE)&CO_CONFIG_TRACE_ENABLE) != 0
+    usage->other += (uint32_t)CO_GET_CNT(TRACE) * sizeof(CO_trace_t);
+#ifdef CO_USE_GLOBALS
+    usage->other += (uint32_t)CO_GET_CNT(TRACE) * CO_TRACE_BUFFER_SIZE_FIXED * (sizeof(uint32_t) + sizeof(int32_t));
+#endif
+#endif
+    usage->CANmodule = sizeof(CO_CANmodule_t);
+    usage->CANrx = (uint32_t)CO_GET_CO(CNT_ALL_RX_MSGS) * sizeof(CO_CANrx_t);
+    usage->CANtx = (uint32_t)CO_GET_CO(CNT_ALL_TX_MSGS) * sizeof(CO_CANtx_t);
+
+    usage->total = usage->CO + usage->NMT + usage->HBcons + usage->EM + usage->SDOserver + usage->SDOclient
+                   + usage->TIME + usage->SYNC + usage->RPDO + usage->TPDO + usage->LEDs + usage->LSS + usage->other
+                   + usage->CANmodule + usage->CANrx + usage->CANtx;
+}
+
 bool_t
 CO_isLSSslaveEnabled(CO_t* co) {
     (void)co; /* may be unused */
@@ -1310,6 +1406,7 @@ CO_CANopenInitSRDO(CO_t* co, CO_EM_t* em, OD_t* od, uint8_t nodeId, uint32_t* er
 CO_NMT_reset_cmd_t
 CO_process(CO_t* co, bool_t enableGateway, uint32_t timeDifference_us, uint32_t* timerNext_us) {
     (void)enableGateway; /* may be unused */
+    CO_PROF_BEGIN(PROCESS);
     CO_NMT_reset_cmd_t reset = CO_RESET_NOT;
     CO_NMT_internalState_t NMTstate = CO_NMT_getInternalState(co->NMT);
     bool_t NMTisPreOrOperational = ((NMTstate == CO_NMT_PRE_OPERATIONAL) || (NMTstate == CO_NMT_OPERATIONAL));
@@ -1319,9 +1416,11 @@ CO_process(CO_t* co, bool_t enableGateway, uint32_t timeDifference_us, uint32_t*
 
 #if ((CO_CONFIG_LSS)&CO_CONFIG_LSS_SLAVE)
     if (CO_GET_CNT(LSS_SLV) == 1U) {
+        CO_PROF_BEGIN(LSS);
         if (CO_LSSslave_process(co->LSSslave)) {
             reset = CO_RESET_COMM;
         }
+        CO_PROF_END(LSS);
     }
 #endif
 
@@ -1360,23 +1459,31 @@ CO_process(CO_t* co, bool_t enableGateway, uint32_t timeDifference_us, uint32_t*
 
     /* Emergency */
     if (CO_GET_CNT(EM) == 1U) {
+        CO_PROF_BEGIN(EM);
         CO_EM_process(co->em, NMTisPreOrOperational, timeDifference_us, timerNext_us);
+        CO_PROF_END(EM);
     }
 
     /* NMT_Heartbeat */
     if (CO_GET_CNT(NMT) == 1U) {
+        CO_PROF_BEGIN(NMT);
         reset = CO_NMT_process(co->NMT, &NMTstate, timeDifference_us, timerNext_us);
+        CO_PROF_END(NMT);
     }
     NMTisPreOrOperational = ((NMTstate == CO_NMT_PRE_OPERATIONAL) || (NMTstate == CO_NMT_OPERATIONAL));
 
     /* SDOserver */
+    CO_PROF_BEGIN(SDO_SRV);
     for (uint8_t i = 0; i < CO_GET_CNT(SDO_SRV); i++) {
         (void)CO_SDOserver_process(&co->SDOserver[i], NMTisPreOrOperational, timeDifference_us, timerNext_us);
     }
+    CO_PROF_END(SDO_SRV);
 
 #if ((CO_CONFIG_HB_CONS)&CO_CONFIG_HB_CONS_ENABLE) != 0
     if (CO_GET_CNT(HB_CONS) == 1U) {
+        CO_PROF_BEGIN(HB_CONS);
         CO_HBconsumer_process(co->HBcons, NMTisPreOrOperational, timeDifference_us, timerNext_us);
+        CO_PROF_END(HB_CONS);
     }
 #endif
 
@@ -1390,7 +1497,9 @@ CO_process(CO_t* co, bool_t enableGateway, uint32_t timeDifference_us, uint32_t*
 
 #if ((CO_CONFIG_TIME)&CO_CONFIG_TIME_ENABLE) != 0
     if (CO_GET_CNT(TIME) == 1U) {
+        CO_PROF_BEGIN(TIME);
         (void)CO_TIME_process(co->TIME, NMTisPreOrOperational, timeDifference_us);
+        CO_PROF_END(TIME);
     }
 #endif
 
@@ -1400,6 +1509,7 @@ CO_process(CO_t* co, bool_t enableGateway, uint32_t timeDifference_us, uint32_t*
     }
 #endif
 
+    CO_PROF_END(PROCESS);
     return reset;
 }
 
@@ -1412,8 +1522,10 @@ CO_process_SYNC(CO_t* co, uint32_t timeDifference_us, uint32_t* timerNext_us) {
         CO_NMT_internalState_t NMTstate = CO_NMT_getInternalState(co->NMT);
         bool_t NMTisPreOrOperational = ((NMTstate == CO_NMT_PRE_OPERATIONAL) || (NMTstate == CO_NMT_OPERATIONAL));
 
+        CO_PROF_BEGIN(SYNC);
         CO_SYNC_status_t sync_process = CO_SYNC_process(co->SYNC, NMTisPreOrOperational, timeDifference_us,
                                                         timerNext_us);
+        CO_PROF_END(SYNC);
 
         switch (sync_process) {
             case CO_SYNC_NONE: break;
@@ -1440,6 +1552,7 @@ CO_process_RPDO(CO_t* co, bool_t syncWas, uint32_t timeDifference_us, uint32_t*
 
     bool_t NMTisOperational = CO_NMT_getInternalState(co->NMT) == CO_NMT_OPERATIONAL;
 
+    CO_PROF_BEGIN(RPDO);
     for (uint16_t i = 0; i < CO_GET_CNT(RPDO); i++) {
         CO_RPDO_process(&co->RPDO[i],
 #if ((CO_CONFIG_PDO)&CO_CONFIG_RPDO_TIMERS_ENABLE) != 0
@@ -1447,6 +1560,7 @@ CO_process_RPDO(CO_t* co, bool_t syncWas, uint32_t timeDifference_us, uint32_t*
 #endif
                         NMTisOperational, syncWas);
     }
+    CO_PROF_END(RPDO);
 }
 #endif
 
@@ -1461,6 +1575,7 @@ CO_process_TPDO(CO_t* co, bool_t syncWas, uint32_t timeDifference_us, uint32_t*
 
     bool_t NMTisOperational = CO_NMT_getInternalState(co->NMT) == CO_NMT_OPERATIONAL;
 
+    CO_PROF_BEGIN(TPDO);
     for (uint16_t i = 0; i < CO_GET_CNT(TPDO); i++) {
         CO_TPDO_process(&co->TPDO[i],
 #if ((CO_CONFIG_PDO)&CO_CONFIG_TPDO_TIMERS_ENABLE) != 0
@@ -1468,6 +1583,7 @@ CO_process_TPDO(CO_t* co, bool_t syncWas, uint32_t timeDifference_us, uint32_t*
 #endif
                         NMTisOperational, syncWas);
     }
+    CO_PROF_END(TPDO);
 }
 #endif
 
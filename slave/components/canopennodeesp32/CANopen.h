@@ -390,6 +390,39 @@ CO_t* CO_new(CO_config_t* config, uint32_t* heapMemoryUsed);
  */
 void CO_delete(CO_t* co);
 
+/**
+ * RAM used by CANopen objects, per module, in bytes
+ *
+ * Values are the same for heap allocation and for CO_USE_GLOBALS.
+ */
+typedef struct {
+    uint32_t CO;        /**< CO_t object */
+    uint32_t NMT;       /**< NMT, heartbeat producer and node guarding */
+    uint32_t HBcons;    /**< Heartbeat consumer with monitored nodes */
+    uint32_t EM;        /**< Emergency with its FIFO */
+    uint32_t SDOserver; /**< SDO servers, including transfer buffers */
+    uint32_t SDOclient; /**< SDO clients, including transfer buffers */
+    uint32_t TIME;      /**< TIME object */
+    uint32_t SYNC;      /**< SYNC object */
+    uint32_t RPDO;      /**< RPDO objects */
+    uint32_t TPDO;      /**< TPDO objects */
+    uint32_t LEDs;      /**< CANopen LEDs */
+    uint32_t LSS;       /**< LSS slave and master */
+    uint32_t other;     /**< GFC, SRDO, ASCII gateway and trace */
+    uint32_t CANmodule; /**< CO_CANmodule_t object */
+    uint32_t CANrx;     /**< CANrx array, all receive message buffers */
+    uint32_t CANtx;     /**< CANtx array, all transmit message buffers */
+    uint32_t total;     /**< Sum of all above */
+} CO_memoryUsage_t;
+
+/**
+ * Get memory used by CANopen objects
+ *
+ * @param co CANopen object, from CO_new().
+ * @param [out] usage Per module memory usage.
+ */
+void CO_getMemoryUsage(CO_t* co, CO_memoryUsage_t* usage);
+
 /**
  * Test if LSS slave is enabled
  *
@@ -22,6 +22,9 @@
 #ifndef CONFIG_CO_PERIODIC_TASK_INTERVAL_MS
 #define CONFIG_CO_PERIODIC_TASK_INTERVAL_MS 1
 #endif
+#ifndef CONFIG_CO_CYCLE_PERIOD_US
+#define CONFIG_CO_CYCLE_PERIOD_US 0 // 0 = tarea periódica por tick, >= 250 ciclo por esp_timer
+#endif
 #ifndef CONFIG_CO_DEFAULT_NODE_ID
 #define CONFIG_CO_DEFAULT_NODE_ID 10
 #endif
@@ -48,14 +51,20 @@
 #include "driver/gpio.h" 
 #include "freertos/FreeRTOS.h" 
 #include "freertos/semphr.h" 
+#include "esp_timer.h"
 #include "driver/twai.h" // NECESARIO para el monitor de tráfico
+#include "co_cycle.h"
+#include "co_profiler.h"
 
-#if (CONFIG_FREERTOS_HZ != 1000)
-// #error "FreeRTOS tick interrupt frequency must be 1000Hz" 
-#endif
+/* Las tareas pasan el tiempo medido con esp_timer, el tick solo limita la
+ * resolución. Con CONFIG_CO_CYCLE_PERIOD_US la tarea periódica tampoco
+ * depende de CONFIG_FREERTOS_HZ. */
 
-#define CO_PERIODIC_TASK_INTERVAL_US (CONFIG_CO_PERIODIC_TASK_INTERVAL_MS * 1000)
-#define CO_MAIN_TASK_INTERVAL_US (CONFIG_CO_MAIN_TASK_INTERVAL_MS * 1000)
+/* at least one tick, also with CONFIG_FREERTOS_HZ < 1000 */
+#define CO_PERIODIC_TASK_INTERVAL_TICKS                                                                               \
+    ((pdMS_TO_TICKS(CONFIG_CO_PERIODIC_TASK_INTERVAL_MS) > 0) ? pdMS_TO_TICKS(CONFIG_CO_PERIODIC_TASK_INTERVAL_MS) : 1)
+#define CO_MAIN_TASK_INTERVAL_TICKS                                                                                   \
+    ((pdMS_TO_TICKS(CONFIG_CO_MAIN_TASK_INTERVAL_MS) > 0) ? pdMS_TO_TICKS(CONFIG_CO_MAIN_TASK_INTERVAL_MS) : 1)
 
 // Configuración Hardware
 #define PIN_EMERGENCIA GPIO_NUM_0
@@ -78,6 +87,20 @@ static StackType_t xCoPeriodicStack[CONFIG_CO_PERIODIC_TASK_STACK_SIZE];
 static TaskHandle_t xCoPeriodicTaskHandle = NULL;
 static void CO_periodicTask(void *pxParam);
 
+// Ciclo de la tarea periódica por esp_timer (CONFIG_CO_CYCLE_PERIOD_US)
+static co_cycle_t xCoCycle;
+static bool bCoCycleRunning = false;
+
+/* SYNC and RPDO reception wake the periodic task (callbackPre, CAN RX task) */
+static void CO_periodicTaskSignal(void *object)
+{
+    (void)object;
+    if (xCoPeriodicTaskHandle != NULL)
+    {
+        xTaskNotifyGive(xCoPeriodicTaskHandle);
+    }
+}
+
 // Variables lógicas de aplicación
 bool b_emergencia_activa = false;
 uint8_t u8_dato_dummy = 0;
@@ -142,7 +165,15 @@ static void CO_mainTask(void *pxParam)
     
     // 2. Inicialización de Memoria CANopen
     CO = CO_new(NULL, &heapMemoryUsed);
-    if (CO == NULL) ESP_LOGW(TAG, "Can't allocate memory");
+    if (CO == NULL)
+    {
+        ESP_LOGE(TAG, "Can't allocate memory");
+        vTaskDelete(NULL);
+        return;
+    }
+    ESP_LOGI(TAG, "CANopen objects %s, heap used: %lu bytes",
+             CO_CONFIG_STATIC_OBJECTS ? "static" : "on heap", (unsigned long)heapMemoryUsed);
+    CO_PROF_TASK(MAIN, xTaskGetCurrentTaskHandle());
 
     while (reset != CO_RESET_APP)
     {
@@ -178,6 +209,17 @@ static void CO_mainTask(void *pxParam)
                              
         CO_CANopenInitPDO(CO, CO->em, OD, activeNodeId, &errInfo);
 
+#if CONFIG_CO_CYCLE_PERIOD_US > 0
+        if (!bCoCycleRunning)
+        {
+            bCoCycleRunning = co_cycle_start(&xCoCycle, &xCoPeriodicTaskHandle, CONFIG_CO_CYCLE_PERIOD_US, "CO_cycle");
+        }
+        if (bCoCycleRunning)
+        {
+            (void)co_cycle_od_init(&xCoCycle);
+        }
+#endif
+
         // Crear tarea periódica si no existe
         if (xCoPeriodicTaskHandle == NULL)
         {
@@ -185,24 +227,33 @@ static void CO_mainTask(void *pxParam)
                 CO_periodicTask, "CO_timer", CONFIG_CO_PERIODIC_TASK_STACK_SIZE,
                 (void *)0, CONFIG_CO_PERIODIC_TASK_PRIORITY,
                 &xCoPeriodicStack[0], &xCoPeriodicTaskBuffer, CONFIG_CO_TASK_CORE);
+            CO_PROF_TASK(PERIODIC, xCoPeriodicTaskHandle);
+        }
+#if CO_CONFIG_PROFILER
+        (void)co_prof_od_init();
+#endif
+
+#if ((CO_CONFIG_SYNC) & CO_CONFIG_SYNC_ENABLE) && (((CO_CONFIG_SYNC)&CO_CONFIG_FLAG_CALLBACK_PRE) != 0)
+        CO_SYNC_initCallbackPre(CO->SYNC, NULL, CO_periodicTaskSignal);
+#endif
+#if ((CO_CONFIG_PDO) & CO_CONFIG_RPDO_ENABLE) && (((CO_CONFIG_PDO)&CO_CONFIG_FLAG_CALLBACK_PRE) != 0)
+        for (uint16_t i = 0; i < OD_CNT_RPDO; i++)
+        {
+            CO_RPDO_initCallbackPre(&CO->RPDO[i], NULL, CO_periodicTaskSignal);
         }
+#endif
 
 #if CO_CONFIG_LEDS
         CO_LEDs_init(CO->LEDs);
 #endif
 
         CO_CANsetNormalMode(CO->CANmodule);
-        
-        // ---------------------------------------------------------------------
-        // IMPORTANTE: ACTIVAR MONITOR DE TRÁFICO (ESPÍA)
-        // Esto permite ver en el log si las tramas entran (RX) y si salen (TX)
-        // ---------------------------------------------------------------------
-        twai_reconfigure_alerts(TWAI_ALERT_RX_DATA | TWAI_ALERT_TX_SUCCESS | TWAI_ALERT_TX_FAILED, NULL);
 
         reset = CO_RESET_NOT;
         ESP_LOGI(TAG, "CANopenNode is running");
         
         xLastWakeTime = xTaskGetTickCount();
+        int64_t lastProcess_us = esp_timer_get_time();
         xTimerUltimoEnvio = xTaskGetTickCount();
         b_emergencia_activa = false; 
         
@@ -212,26 +263,15 @@ static void CO_mainTask(void *pxParam)
         // BUCLE OPERATIVO
         while (reset == CO_RESET_NOT)
         {
-            vTaskDelayUntil(&xLastWakeTime, CONFIG_CO_MAIN_TASK_INTERVAL_MS);
+            vTaskDelayUntil(&xLastWakeTime, CO_MAIN_TASK_INTERVAL_TICKS);
             
-            // --- A. Proceso CANopen ---
-            reset = CO_process(CO, false, CO_MAIN_TASK_INTERVAL_US, NULL);
-
-            // --- B. Monitor de Tráfico (LOGS) ---
-            uint32_t alerts = 0;
-            twai_read_alerts(&alerts, 0); // Leer alertas sin bloquear
-            
-            if (alerts & TWAI_ALERT_RX_DATA) {
-                ESP_LOGI(TAG, ">>> [BUS] Trama Recibida (RX)");
-            }
-            if (alerts & TWAI_ALERT_TX_SUCCESS) {
-                ESP_LOGI(TAG, "<<< [BUS] Trama Enviada OK (TX ACK Recibido)");
-            }
-            if (alerts & TWAI_ALERT_TX_FAILED) {
-                ESP_LOGE(TAG, "xxx [BUS] Fallo de Envío (Nadie escucha o Error Bus)");
-            }
+            // --- A. Proceso CANopen (tiempo real transcurrido) ---
+            int64_t now_us = esp_timer_get_time();
+            uint32_t timeDifference_us = (uint32_t)(now_us - lastProcess_us);
+            lastProcess_us = now_us;
+            reset = CO_process(CO, false, timeDifference_us, NULL);
 
-            // --- C. Botón de Emergencia (TX por Evento) ---
+            // --- B. Botón de Emergencia (TX por Evento) ---
             if (xSemaphoreTake(xSemaforoEmergencia, 0) == pdTRUE)
             {
                 if (!b_emergencia_activa) 
@@ -254,7 +294,7 @@ static void CO_mainTask(void *pxParam)
             }
 
             
-            // --- D. Envío Cíclico "Dummy" (Hack TX sin OD) ---
+            // --- C. Envío Cíclico "Dummy" (Hack TX sin OD) ---
             TickType_t now = xTaskGetTickCount();
             if (!b_emergencia_activa && (now - xTimerUltimoEnvio > pdMS_TO_TICKS(1000)))
             {
@@ -281,24 +321,41 @@ static void CO_mainTask(void *pxParam)
 }
 
 // --------------------------------------------------------------------------
-// TAREA PERIÓDICA (TIMER 1ms)
+// TAREA PERIÓDICA (TIMER 1ms o esp_timer, SYNC/RPDO por evento)
 // --------------------------------------------------------------------------
 static void CO_periodicTask(void *pxParam)
 {
+    int64_t last_us = esp_timer_get_time();
+
     while (1)
     {
-        vTaskDelay(1); 
+        uint32_t timeDifference_us;
+
+        /* Un SYNC o RPDO recibido despierta la tarea antes del intervalo */
+        if (bCoCycleRunning)
+        {
+            timeDifference_us = co_cycle_wait(&xCoCycle);
+        }
+        else
+        {
+            (void)ulTaskNotifyTake(pdTRUE, CO_PERIODIC_TASK_INTERVAL_TICKS);
+
+            int64_t now_us = esp_timer_get_time();
+            timeDifference_us = (uint32_t)(now_us - last_us);
+            last_us = now_us;
+        }
+
         if ((!CO->nodeIdUnconfigured) && (CO->CANmodule->CANnormal))
         {
             bool syncWas = false;
 #if (CO_CONFIG_SYNC) & CO_CONFIG_SYNC_ENABLE
-            syncWas = CO_process_SYNC(CO, CO_PERIODIC_TASK_INTERVAL_US, NULL);
+            syncWas = CO_process_SYNC(CO, timeDifference_us, NULL);
 #endif
 #if (CO_CONFIG_PDO) & CO_CONFIG_RPDO_ENABLE
-            CO_process_RPDO(CO, syncWas, CO_PERIODIC_TASK_INTERVAL_US, NULL);
+            CO_process_RPDO(CO, syncWas, timeDifference_us, NULL);
 #endif
 #if (CO_CONFIG_PDO) & CO_CONFIG_TPDO_ENABLE
-            CO_process_TPDO(CO, syncWas, CO_PERIODIC_TASK_INTERVAL_US, NULL);
+            CO_process_TPDO(CO, syncWas, timeDifference_us, NULL);
 #endif
         }
     }
@@ -11,6 +11,11 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "fw_update_server.h"
+#include "can_diag_server.h"
+#include "can_analyzer.h"
+#include "can_loadgen.h"
+#include "co_cycle.h"
+#include "co_profiler.h"
 
 // --- CONFIGURACIÓN ---
 #define PIN_BOTON_EMERGENCIA GPIO_NUM_0
@@ -24,11 +29,33 @@
 // Prioridades
 #define MAIN_TASK_PRIO       4
 #define PERIODIC_TASK_PRIO   5 
+#define PDO_TASK_PRIO        8    // por debajo de las tareas del driver CAN (10)
 
 // TIEMPOS (10ms mínimo para evitar Watchdog)
 #define MAIN_INTERVAL_MS     10
 #define PERIODIC_INTERVAL_MS 10   
 
+// Espera máxima/mínima entre llamadas a CO_process(). Sin tickless los
+// módulos no acortan timerNext_us y la tarea principal vuelve a ser periódica.
+#if CO_CONFIG_TICKLESS
+#define MAIN_MAX_SLEEP_US    1000000
+#define PDO_MAX_SLEEP_US     1000000
+#else
+#define MAIN_MAX_SLEEP_US    (MAIN_INTERVAL_MS * 1000)
+#define PDO_MAX_SLEEP_US     (PERIODIC_INTERVAL_MS * 1000)
+#endif
+#define TASK_MIN_SLEEP_US    200    // deja correr tareas de menor prioridad en el core 1
+// Ciclo fijo de la tarea de PDOs por esp_timer periódico (>= CO_CYCLE_PERIOD_MIN_US),
+// 0 = solo por evento y timerNext_us
+#ifndef PDO_CYCLE_US
+#define PDO_CYCLE_US         0
+#endif
+
+// Detección automática de velocidad al primer arranque (8 velocidades x 250 ms por vuelta)
+#define AUTOBAUD_TIMEOUT_MS  6000
+// Antigüedad máxima de la trama NMT que originó el reset de comunicación
+#define RESET_NMT_MAX_AGE_US 100000
+
 // Control NMT corregido
 #define NMT_CONTROL (CO_NMT_STARTUP_TO_OPERATIONAL | CO_NMT_ERR_ON_ERR_REG | CO_ERR_REG_GENERIC_ERR | CO_ERR_REG_COMMUNICATION)
 
@@ -37,7 +64,13 @@ static uint32_t heapMemoryUsed = 0;
 
 // Variables Globales
 static uint16_t g_bitRate;
+static bool     g_bitRateKnown = false; // guardada por LSS o detectada antes
 static uint8_t  g_nodeId;
+
+// Medida del reset de comunicación hasta el bootup (objeto 0x2109)
+static uint32_t g_resetStart_us = 0;
+static bool     g_resetTiming = false;
+static bool     g_resetWarm = false;
 static bool b_emergencia_activa = false;
 
 // Variables para el envío automático
@@ -48,6 +81,7 @@ static uint8_t  contador_dummy = 0;
 #define LSS_NVS_NAMESPACE "lss"
 #define LSS_NVS_KEY_ID    "node_id"
 #define LSS_NVS_KEY_BR    "bitrate"
+#define LSS_NVS_KEY_BR_AUTO "br_auto"   // velocidad detectada automáticamente
 
 // Si mantenemos pulsado el botón de emergencia al arranque, borramos la NVS LSS
 static void lss_maybe_factory_reset(void) {
@@ -65,17 +99,60 @@ static void lss_maybe_factory_reset(void) {
 
 TaskHandle_t mainTaskHandle = NULL;
 TaskHandle_t periodicTaskHandle = NULL;
+TaskHandle_t pdoTaskHandle = NULL;
+// Temporizadores de un disparo hasta el siguiente timerNext_us de cada tarea
+static esp_timer_handle_t mainWakeTimer = NULL;
+static esp_timer_handle_t pdoWakeTimer = NULL;
+#if SLAVE_VERSION_V2 && PDO_CYCLE_US > 0
+static co_cycle_t pdoCycle;
+static bool pdoCycleRunning = false;
+#endif
 
 static void CO_mainTask(void *pxParam);
 static void CO_periodicTask(void *pxParam);
+#if SLAVE_VERSION_V2
+static void CO_pdoTask(void *pxParam);
+#endif
 static bool_t lss_store_cb(void *object, uint8_t id, uint16_t bitRate);
-static void lss_load_from_nvs(uint8_t *nodeId, uint16_t *bitRate);
-#if (((CO_CONFIG_LSS)&CO_CONFIG_FLAG_CALLBACK_PRE) != 0)
-static void lss_slave_signal(void* object) {
-    (void)object;
-    if (mainTaskHandle) xTaskNotifyGive(mainTaskHandle);
+static bool lss_load_from_nvs(uint8_t *nodeId, uint16_t *bitRate);
+static void lss_store_auto_bitrate(uint16_t bitRate);
+static bool_t lss_check_bitrate_cb(void *object, uint16_t bitRate);
+static void lss_activate_bitrate_cb(void *object, uint16_t delay);
+static void co_memory_report(void);
+// Callbacks pre de los módulos (tarea RX del driver) y del temporizador:
+// despiertan la tarea cuyo TaskHandle_t recibe en object
+static void co_task_signal(void* object) {
+    TaskHandle_t task = *(TaskHandle_t *)object;
+    if (task) xTaskNotifyGive(task);
+}
+
+static void co_wait_init(esp_timer_handle_t *timer, TaskHandle_t *task, const char *name) {
+    const esp_timer_create_args_t args = {
+        .callback = co_task_signal,
+        .arg = task,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = name,
+    };
+    if (*timer == NULL && esp_timer_create(&args, timer) != ESP_OK) {
+        ESP_LOGW(TAG, "Sin temporizador %s, espera con resolución de tick", name);
+        *timer = NULL;
+    }
+}
+
+// Duerme hasta timerNext_us (acotado) o hasta una notificación. El tick de
+// FreeRTOS (10 ms) no limita la resolución: despierta un esp_timer.
+static void co_wait(esp_timer_handle_t timer, uint32_t timerNext_us, uint32_t max_us) {
+    if (timerNext_us > max_us) timerNext_us = max_us;
+    if (timerNext_us < TASK_MIN_SLEEP_US) timerNext_us = TASK_MIN_SLEEP_US;
+    if (timer == NULL) {
+        uint32_t tick_us = portTICK_PERIOD_MS * 1000;
+        ulTaskNotifyTake(pdTRUE, (timerNext_us + tick_us - 1) / tick_us);
+        return;
+    }
+    esp_timer_stop(timer); // puede seguir armado si despertó una trama
+    esp_timer_start_once(timer, timerNext_us);
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
 }
-#endif
 
 // --- STORAGE ---
 #if (CO_CONFIG_STORAGE) & CO_CONFIG_STORAGE_ENABLE
@@ -127,19 +204,94 @@ static bool_t lss_store_cb(void *object, uint8_t id, uint16_t bitRate) {
     return (bool_t)1;
 }
 
-static void lss_load_from_nvs(uint8_t *nodeId, uint16_t *bitRate) {
+/* Devuelve true si hay velocidad guardada: la de LSS Store tiene prioridad
+ * sobre la detectada automáticamente */
+static bool lss_load_from_nvs(uint8_t *nodeId, uint16_t *bitRate) {
     nvs_handle_t h;
     esp_err_t err = nvs_open(LSS_NVS_NAMESPACE, NVS_READONLY, &h);
-    if (err != ESP_OK) return;
+    if (err != ESP_OK) return false;
     uint8_t nid;
     uint16_t br;
+    bool found = false;
     if (nvs_get_u8(h, LSS_NVS_KEY_ID, &nid) == ESP_OK && nid >= 1 && nid <= 127) {
         *nodeId = nid;
     }
     if (nvs_get_u16(h, LSS_NVS_KEY_BR, &br) == ESP_OK && br > 0) {
         *bitRate = br;
+        found = true;
+    } else if (nvs_get_u16(h, LSS_NVS_KEY_BR_AUTO, &br) == ESP_OK && br > 0) {
+        *bitRate = br;
+        found = true;
     }
     nvs_close(h);
+    return found;
+}
+
+static void lss_store_auto_bitrate(uint16_t bitRate) {
+    nvs_handle_t h;
+    esp_err_t err = nvs_open(LSS_NVS_NAMESPACE, NVS_READWRITE, &h);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "NVS open fallo (%d)", err);
+        return;
+    }
+    err = nvs_set_u16(h, LSS_NVS_KEY_BR_AUTO, bitRate);
+    if (err == ESP_OK) err = nvs_commit(h);
+    nvs_close(h);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "NVS store velocidad detectada fallo (%d)", err);
+    }
+}
+
+static bool_t lss_check_bitrate_cb(void *object, uint16_t bitRate) {
+    (void)object;
+    return CO_CANbitRateSupported(bitRate);
+}
+
+/* LSS "activate bit timing": g_bitRate ya contiene la velocidad pendiente
+ * (puntero pendingBitRate de CO_LSSinit). El cambio se hace en caliente, sin
+ * reinstalar el driver, respetando los dos retardos del maestro. */
+static void lss_activate_bitrate_cb(void *object, uint16_t delay) {
+    CO_CANmodule_t *CANmodule = (CO_CANmodule_t *)object;
+    if (!CO_CANmodule_switchBitRate(CANmodule, g_bitRate, delay)) {
+        ESP_LOGW(TAG, "LSS: no se pudo activar %u kbit/s", g_bitRate);
+    }
+}
+
+// Memoria de los objetos CANopen por módulo, en el objeto 0x210C y en el log.
+// Con CO_CONFIG_STATIC_OBJECTS está en .bss (símbolos COO_*) y heap es 0.
+static void co_memory_report(void) {
+    CO_memoryUsage_t mem;
+    CO_getMemoryUsage(CO, &mem);
+
+    OD_RAM.x210C_COmemoryFootprint.total = mem.total;
+    OD_RAM.x210C_COmemoryFootprint.heap = heapMemoryUsed;
+    OD_RAM.x210C_COmemoryFootprint.CO = mem.CO;
+    OD_RAM.x210C_COmemoryFootprint.NMT = mem.NMT;
+    OD_RAM.x210C_COmemoryFootprint.HBcons = mem.HBcons;
+    OD_RAM.x210C_COmemoryFootprint.EM = mem.EM;
+    OD_RAM.x210C_COmemoryFootprint.SDOserver = mem.SDOserver;
+    OD_RAM.x210C_COmemoryFootprint.SDOclient = mem.SDOclient;
+    OD_RAM.x210C_COmemoryFootprint.TIME = mem.TIME;
+    OD_RAM.x210C_COmemoryFootprint.SYNC = mem.SYNC;
+    OD_RAM.x210C_COmemoryFootprint.RPDO = mem.RPDO;
+    OD_RAM.x210C_COmemoryFootprint.TPDO = mem.TPDO;
+    OD_RAM.x210C_COmemoryFootprint.LEDs = mem.LEDs;
+    OD_RAM.x210C_COmemoryFootprint.LSS = mem.LSS;
+    OD_RAM.x210C_COmemoryFootprint.other = mem.other;
+    OD_RAM.x210C_COmemoryFootprint.CANmodule = mem.CANmodule;
+    OD_RAM.x210C_COmemoryFootprint.CANrx = mem.CANrx;
+    OD_RAM.x210C_COmemoryFootprint.CANtx = mem.CANtx;
+
+    ESP_LOGI(TAG, "Objetos CANopen: %lu bytes (%s), heap %lu", (unsigned long)mem.total,
+             CO_CONFIG_STATIC_OBJECTS ? "estáticos" : "heap", (unsigned long)heapMemoryUsed);
+    ESP_LOGI(TAG, "  CO %lu, NMT %lu, HBcons %lu, EM %lu, SDO srv %lu, SDO cli %lu", (unsigned long)mem.CO,
+             (unsigned long)mem.NMT, (unsigned long)mem.HBcons, (unsigned long)mem.EM,
+             (unsigned long)mem.SDOserver, (unsigned long)mem.SDOclient);
+    ESP_LOGI(TAG, "  TIME %lu, SYNC %lu, RPDO %lu, TPDO %lu, LEDs %lu, LSS %lu, otros %lu", (unsigned long)mem.TIME,
+             (unsigned long)mem.SYNC, (unsigned long)mem.RPDO, (unsigned long)mem.TPDO, (unsigned long)mem.LEDs,
+             (unsigned long)mem.LSS, (unsigned long)mem.other);
+    ESP_LOGI(TAG, "  CANmodule %lu, CANrx %lu, CANtx %lu", (unsigned long)mem.CANmodule,
+             (unsigned long)mem.CANrx, (unsigned long)mem.CANtx);
 }
 
 // -------------------------------------------------------------------------
@@ -151,7 +303,7 @@ void CO_ESP32_LSS_Run(uint16_t pendingBitRate, uint8_t pendingNodeId) {
     // Opción de factory reset manteniendo pulsado el botón al arranque
     lss_maybe_factory_reset();
     // Cargar valores previos guardados si existen
-    lss_load_from_nvs(&g_nodeId, &g_bitRate);
+    g_bitRateKnown = lss_load_from_nvs(&g_nodeId, &g_bitRate);
 
     // Hardware
     gpio_reset_pin(PIN_BOTON_EMERGENCIA);
@@ -171,6 +323,15 @@ static void CO_mainTask(void *pxParam) {
     void* CANptr = NULL;
 
     CO = CO_new(NULL, &heapMemoryUsed);
+    if (CO == NULL) {
+        ESP_LOGE(TAG, "Sin memoria para los objetos CANopen");
+        mainTaskHandle = NULL;
+        vTaskDelete(NULL);
+        return;
+    }
+    co_memory_report();
+    CO_PROF_TASK(MAIN, xTaskGetCurrentTaskHandle());
+    co_wait_init(&mainWakeTimer, &mainTaskHandle, "co_main");
     
     #if (CO_CONFIG_STORAGE) & CO_CONFIG_STORAGE_ENABLE
     config_storage();
@@ -185,6 +346,26 @@ static void CO_mainTask(void *pxParam) {
             ESP_LOGE(TAG, "Error CAN Init"); vTaskDelay(pdMS_TO_TICKS(100)); continue;
         }
 
+        /* Sin velocidad guardada: escuchar el bus antes de transmitir nada
+         * (bootup, LSS) y recordar el resultado para arranques posteriores */
+        if (!g_bitRateKnown) {
+            int64_t start_us = esp_timer_get_time();
+            uint16_t detected = CO_CANmodule_detectBitRate(CO->CANmodule, g_bitRate, AUTOBAUD_TIMEOUT_MS);
+            g_bitRateKnown = true;
+            if (detected == 0) {
+                ESP_LOGW(TAG, "Auto-baud: bus sin tráfico, se usa %u kbit/s", g_bitRate);
+            } else {
+                ESP_LOGI(TAG, "Auto-baud: %u kbit/s en %lu ms", detected,
+                         (unsigned long)((esp_timer_get_time() - start_us) / 1000));
+                lss_store_auto_bitrate(detected);
+                if (detected != g_bitRate) {
+                    /* CO_CANinit() con el driver instalado cambia la velocidad en caliente */
+                    g_bitRate = detected;
+                    continue;
+                }
+            }
+        }
+
         uint32_t serial_number = getSerialNumberFromMAC();
         CO_LSS_address_t lss_address = {
             .identity = { .vendorID = OD_PERSIST_COMM.x1018_identity.vendor_ID,
@@ -196,71 +377,200 @@ static void CO_mainTask(void *pxParam) {
         CO_LSSinit(CO, &lss_address, &actualNodeId, &g_bitRate);
         // Permitir guardar nodeId/bitrate en NVS cuando el master envía LSS Store
         CO_LSSslave_initCfgStoreCall(CO->LSSslave, NULL, lss_store_cb);
+        // Cambio de velocidad por LSS (configure / activate bit timing)
+        CO_LSSslave_initCkBitRateCall(CO->LSSslave, NULL, lss_check_bitrate_cb);
+        CO_LSSslave_initActBitRateCall(CO->LSSslave, CO->CANmodule, lss_activate_bitrate_cb);
 #if (((CO_CONFIG_LSS)&CO_CONFIG_FLAG_CALLBACK_PRE) != 0)
         /* Registrar callback pre para despertar la tarea cuando llegue trama LSS */
-        CO_LSSslave_initCallbackPre(CO->LSSslave, NULL, lss_slave_signal);
+        CO_LSSslave_initCallbackPre(CO->LSSslave, &mainTaskHandle, co_task_signal);
 #endif
 
         uint32_t errInfo = 0;
         CO_CANopenInit(CO, NULL, NULL, OD, NULL, NMT_CONTROL, 500, 1000, 500, false, actualNodeId, &errInfo);
         CO_CANopenInitPDO(CO, CO->em, OD, actualNodeId, &errInfo);
 
+        /* Tramas recibidas despiertan la tarea que las procesa: SYNC y RPDO
+         * la de PDOs, el resto la principal */
+#if (((CO_CONFIG_NMT)&CO_CONFIG_FLAG_CALLBACK_PRE) != 0)
+        CO_NMT_initCallbackPre(CO->NMT, &mainTaskHandle, co_task_signal);
+#endif
+#if (((CO_CONFIG_EM)&CO_CONFIG_FLAG_CALLBACK_PRE) != 0)
+        CO_EM_initCallbackPre(CO->em, &mainTaskHandle, co_task_signal);
+#endif
+#if (((CO_CONFIG_SDO_SRV)&CO_CONFIG_FLAG_CALLBACK_PRE) != 0)
+        for (uint16_t i = 0; i < OD_CNT_SDO_SRV; i++) {
+            CO_SDOserver_initCallbackPre(&CO->SDOserver[i], &mainTaskHandle, co_task_signal);
+        }
+#endif
+#if ((CO_CONFIG_HB_CONS) & CO_CONFIG_HB_CONS_ENABLE) && (((CO_CONFIG_HB_CONS)&CO_CONFIG_FLAG_CALLBACK_PRE) != 0)
+        CO_HBconsumer_initCallbackPre(CO->HBcons, &mainTaskHandle, co_task_signal);
+#endif
+#if ((CO_CONFIG_TIME) & CO_CONFIG_TIME_ENABLE) && (((CO_CONFIG_TIME)&CO_CONFIG_FLAG_CALLBACK_PRE) != 0)
+        CO_TIME_initCallbackPre(CO->TIME, &mainTaskHandle, co_task_signal);
+#endif
+#if ((CO_CONFIG_SYNC) & CO_CONFIG_SYNC_ENABLE) && (((CO_CONFIG_SYNC)&CO_CONFIG_FLAG_CALLBACK_PRE) != 0)
+        CO_SYNC_initCallbackPre(CO->SYNC, &pdoTaskHandle, co_task_signal);
+#endif
+#if ((CO_CONFIG_PDO) & CO_CONFIG_RPDO_ENABLE) && (((CO_CONFIG_PDO)&CO_CONFIG_FLAG_CALLBACK_PRE) != 0)
+        for (uint16_t i = 0; i < OD_CNT_RPDO; i++) {
+            CO_RPDO_initCallbackPre(&CO->RPDO[i], &pdoTaskHandle, co_task_signal);
+        }
+#endif
+
         /* Registrar servidor de firmware (objetos 0x1F50-0x1F5C) */
         if (!fw_server_init(CO)) {
             ESP_LOGE(TAG, "No se pudo inicializar el servidor de firmware");
         }
 
+        /* Diagnóstico del driver CAN y recuperación de bus-off (objetos 0x2100-) */
+        if (!can_diag_server_init(CO)) {
+            ESP_LOGE(TAG, "No se pudo inicializar el diagnóstico CAN");
+        }
+
+        /* Analizador pasivo SLCAN por UART (objeto 0x2107) */
+        if (!can_analyzer_init(CO)) {
+            ESP_LOGE(TAG, "No se pudo inicializar el analizador CAN");
+        }
+
+        /* Generador de carga de bus para pruebas de capacidad (objeto 0x2108) */
+        if (!can_loadgen_init(CO)) {
+            ESP_LOGE(TAG, "No se pudo inicializar el generador de carga");
+        }
+
         if (periodicTaskHandle == NULL) {
             ESP_LOGI(TAG, "Creando Tarea Periodica...");
             xTaskCreatePinnedToCore(CO_periodicTask, "CO_Periodic", 4096, NULL, PERIODIC_TASK_PRIO, &periodicTaskHandle, 1);
+            CO_PROF_TASK(PERIODIC, periodicTaskHandle);
+        }
+#if CO_CONFIG_PROFILER
+        /* Tiempos de CO_process() y PDOs, CPU y pila de las tareas (objeto 0x210D) */
+        if (!co_prof_od_init()) {
+            ESP_LOGE(TAG, "No se pudo registrar el objeto 0x210D");
+        }
+#endif
+#if SLAVE_VERSION_V2
+#if PDO_CYCLE_US > 0
+        if (!pdoCycleRunning) {
+            pdoCycleRunning = co_cycle_start(&pdoCycle, &pdoTaskHandle, PDO_CYCLE_US, "co_pdo_cycle");
+        }
+        /* Ciclo medido y desbordes (objeto 0x210B) */
+        if (pdoCycleRunning && !co_cycle_od_init(&pdoCycle)) {
+            ESP_LOGE(TAG, "No se pudo registrar el objeto 0x210B");
+        }
+#endif
+        if (pdoTaskHandle == NULL) {
+            xTaskCreatePinnedToCore(CO_pdoTask, "CO_PDO", 4096, NULL, PDO_TASK_PRIO, &pdoTaskHandle, 1);
         }
+#endif
 
-        // Activamos alertas del driver
-        twai_reconfigure_alerts(TWAI_ALERT_RX_DATA | TWAI_ALERT_TX_SUCCESS | TWAI_ALERT_TX_FAILED, NULL);
+        /* Despertar la tarea cuando el driver cambie CANerrorStatus (bus-off, error pasivo, overflow) */
+        CO_CANmodule_initCallbackStatus(CO->CANmodule, &mainTaskHandle, co_task_signal);
 
         CO_CANsetNormalMode(CO->CANmodule);
         reset = CO_RESET_NOT;
         ESP_LOGI(TAG, "NODO OPERATIVO. ID: %d", actualNodeId);
 
-        uint32_t co_timer_us = MAIN_INTERVAL_MS * 1000;
+        int64_t last_us = esp_timer_get_time();
+        uint32_t timerNext_us = 0;
 
         while (reset == CO_RESET_NOT) {
-            /* Espera por notificación (LSS pre-callback) o timeout de ciclo */
-            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(MAIN_INTERVAL_MS));
+            /* Espera hasta el siguiente plazo de algún módulo o hasta que una
+             * trama recibida (callbacks pre) o el estado CAN lo despierte */
+            co_wait(mainWakeTimer, timerNext_us, MAIN_MAX_SLEEP_US);
+
+            /* Tiempo real transcurrido: las notificaciones despiertan antes del plazo */
+            int64_t now_us = esp_timer_get_time();
+            uint32_t co_timer_us = (uint32_t)(now_us - last_us);
+            last_us = now_us;
 
-            reset = CO_process(CO, false, co_timer_us, NULL);
+            timerNext_us = MAIN_MAX_SLEEP_US;
+            reset = CO_process(CO, false, co_timer_us, &timerNext_us);
             if (CO->LSSslave) CO_LSSslave_process(CO->LSSslave);
 
-            // --- MONITOR DE TRÁFICO ---
-            // Esto te dirá si las tramas realmente salen al cable
-            uint32_t alerts = 0;
-            if (twai_read_alerts(&alerts, 0) == ESP_OK) {
-                if (alerts & TWAI_ALERT_TX_SUCCESS) {
-                    // Silenciado para no saturar
-                }
-                if (alerts & TWAI_ALERT_TX_FAILED) {
-                    ESP_LOGE(TAG, "XXX [BUS] TX FALLIDO (Nadie escucha)");
-                }
-                if (alerts & TWAI_ALERT_RX_DATA) {
-                    // Silenciado para ganar tiempo
+            /* Primer mensaje tras el reset (bootup) ya en el controlador */
+            if (g_resetTiming && CO->CANmodule->firstTx_us != 0) {
+                uint32_t dt_us = CO->CANmodule->firstTx_us - g_resetStart_us;
+                g_resetTiming = false;
+                OD_RAM.x2109_CANresetCommunication.resets++;
+                OD_RAM.x2109_CANresetCommunication.lastResetToBootup = dt_us;
+                if (dt_us > OD_RAM.x2109_CANresetCommunication.maxResetToBootup) {
+                    OD_RAM.x2109_CANresetCommunication.maxResetToBootup = dt_us;
                 }
+                ESP_LOGI(TAG, "Reset comunicacion (%s): bootup en %lu us", g_resetWarm ? "caliente" : "frio",
+                         (unsigned long)dt_us);
             }
         }
         
-        CO_CANsetConfigurationMode(CANptr);
-        CO_CANmodule_disable(CO->CANmodule);
+        /* El generador no debe usar el CANmodule mientras se reinicia */
+        can_loadgen_stop();
+
+        if (reset == CO_RESET_COMM) {
+            /* Desde la recepción del comando NMT, si es reciente */
+            uint32_t now32 = (uint32_t)esp_timer_get_time();
+            uint32_t nmt_us = CO->CANmodule->nmtRx_us;
+            g_resetStart_us = (nmt_us != 0 && (now32 - nmt_us) < RESET_NMT_MAX_AGE_US) ? nmt_us : now32;
+            g_resetTiming = true;
+            g_resetWarm = OD_RAM.x2109_CANresetCommunication.warm != 0;
+        }
+
+        /* Reset de comunicación en caliente: el driver TWAI, sus tareas y el
+         * filtro siguen activos, CO_CANinit() solo reinicia rxArray/txArray.
+         * En reset de aplicación, o con 0x2109.1 = 0, se reinstala todo. */
+        if (reset != CO_RESET_COMM || !g_resetWarm) {
+            CO_CANsetConfigurationMode(CANptr);
+            CO_CANmodule_disable(CO->CANmodule);
+        }
     }
 
+    CO_PROF_TASK(PERIODIC, NULL);
+    CO_PROF_TASK(MAIN, NULL);
     if(periodicTaskHandle != NULL) { vTaskDelete(periodicTaskHandle); periodicTaskHandle = NULL; }
+    if(pdoTaskHandle != NULL) { vTaskDelete(pdoTaskHandle); pdoTaskHandle = NULL; }
     CO_delete(CO);
     vTaskDelete(NULL);
 }
 
+// -------------------------------------------------------------------------
+// TAREA DE PDOs (v2) - SYNC, RPDO y TPDO por evento
+// -------------------------------------------------------------------------
+// Despierta con cada SYNC o RPDO recibido (callbacks pre) y en el siguiente
+// plazo de los temporizadores SYNC/PDO, con el tiempo real transcurrido. La
+// latencia SYNC -> TPDO en cola se mide en el driver (objeto 0x210A).
+// Con PDO_CYCLE_US corre además en ciclo fijo, sin depender del tick.
+#if SLAVE_VERSION_V2
+static void CO_pdoTask(void *pxParam) {
+    uint32_t timerNext_us = 0;
+    int64_t last_us = esp_timer_get_time();
+    co_wait_init(&pdoWakeTimer, &pdoTaskHandle, "co_pdo");
+
+    while(1) {
+        uint32_t co_timer_us;
+#if PDO_CYCLE_US > 0
+        if (pdoCycleRunning) {
+            co_timer_us = co_cycle_wait(&pdoCycle);
+        } else
+#endif
+        {
+            co_wait(pdoWakeTimer, timerNext_us, PDO_MAX_SLEEP_US);
+            int64_t now_us = esp_timer_get_time();
+            co_timer_us = (uint32_t)(now_us - last_us);
+            last_us = now_us;
+        }
+        timerNext_us = PDO_MAX_SLEEP_US;
+
+        if (!CO->CANmodule->CANnormal) continue;
+
+        bool_t syncWas = CO_process_SYNC(CO, co_timer_us, &timerNext_us);
+        CO_process_RPDO(CO, syncWas, co_timer_us, &timerNext_us);
+        CO_process_TPDO(CO, syncWas, co_timer_us, &timerNext_us);
+    }
+}
+#endif
+
 // -------------------------------------------------------------------------
 // TAREA PERIÓDICA (10ms) - Lógica de Usuario
 // -------------------------------------------------------------------------
 static void CO_periodicTask(void *pxParam) {
-    uint32_t co_timer_us = PERIODIC_INTERVAL_MS * 1000;
     last_auto_send_time_us = esp_timer_get_time();
 
     while(1) {
@@ -271,13 +581,6 @@ static void CO_periodicTask(void *pxParam) {
 
         uint64_t now_us = esp_timer_get_time();
 
-        // Procesar PDOs (solo en v2)
-        bool syncWas = false; 
-        #if SLAVE_VERSION_V2
-        CO_process_RPDO(CO, syncWas, co_timer_us, NULL); 
-        CO_process_TPDO(CO, syncWas, co_timer_us, NULL);
-        #endif
-
         // ============================================================
         // A. ENVÍO AUTOMÁTICO (Cada 1 Segundo)
         // ============================================================
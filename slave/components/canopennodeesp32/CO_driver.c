@@ -26,8 +26,17 @@
  */
 
 #include "301/CO_driver.h"
+#include "CO_driver_filter.h"
+#include "CO_driver_rxindex.h"
+#include "CO_driver_rxlanes.h"
+#include "CO_driver_txqueue.h"
+#include "co_profiler.h"
+#include "esp_attr.h"
 #include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_cpu.h"
 #include "driver/twai.h"
+#include "hal/twai_ll.h"
 
 static const char *TAG = "CO_driver";
 
@@ -62,6 +71,7 @@ static baudrate_config_t const baudrate_config[] = {
 // Cambiamos CONFIG_ por DRV_ para evitar conflictos con el sistema
 #define DRV_TX_TASK_STACK_SIZE 4096
 #define DRV_RX_TASK_STACK_SIZE 4096
+#define DRV_ALERT_TASK_STACK_SIZE 3072
 
 // Pines Fijos
 #define DRV_TWAI_TX_GPIO 5
@@ -70,10 +80,71 @@ static baudrate_config_t const baudrate_config[] = {
 // Prioridades
 #define DRV_TX_TASK_PRIORITY 10 
 #define DRV_RX_TASK_PRIORITY 10
+#define DRV_ALERT_TASK_PRIORITY 10
+
+// Alertas del driver TWAI atendidas por la tarea de alertas (errores, bus-off, cola RX llena)
+#define DRV_TWAI_ALERTS (TWAI_ALERT_BUS_ERROR | TWAI_ALERT_ABOVE_ERR_WARN | TWAI_ALERT_BELOW_ERR_WARN |   \
+                         TWAI_ALERT_ERR_PASS | TWAI_ALERT_ERR_ACTIVE | TWAI_ALERT_BUS_OFF |               \
+                         TWAI_ALERT_BUS_RECOVERED | TWAI_ALERT_RX_QUEUE_FULL | TWAI_ALERT_RX_FIFO_OVERRUN |  \
+                         TWAI_ALERT_TX_SUCCESS | TWAI_ALERT_TX_FAILED | TWAI_ALERT_TX_IDLE)
+
+// Tiempo máximo de espera por hueco en la cola TX del driver TWAI
+#define DRV_TX_TIMEOUT_MS 1000
+
+// Longitud de la cola TX del driver TWAI. Tramas en vuelo: la cola más el buffer del controlador
+#define DRV_TWAI_TX_QUEUE_LEN 5
+#define DRV_TX_INFLIGHT_MAX (DRV_TWAI_TX_QUEUE_LEN + 1)
+
+// Limitador de TX: clases masivas (SDO), parte del tiempo de bus en por mil y ráfaga en tramas
+#define DRV_TX_SHAPER_BULK_CLASSES (1U << CO_CAN_CLASS_SDO)
+#define DRV_TX_SHAPER_SHARE_PERMILLE 300
+#define DRV_TX_SHAPER_BURST_FRAMES 2
+#define DRV_TX_SHAPER_BURST_MAX 1000
+
+// Capacidad del cubo de tokens en milésimas de bit
+#define DRV_TX_SHAPER_DEPTH_MBIT(shaper) ((uint32_t)(shaper)->burstFrames * CO_CAN_FRAME_BITS(8U) * 1000U)
+
+// Máximo de tramas leídas de la cola RX del driver TWAI de una vez
+#define DRV_RX_BATCH_MAX 32
+
+// Longitud de la cola RX del driver TWAI (por defecto sólo 5)
+#define DRV_TWAI_RX_QUEUE_LEN 32
+
+// Clases de COB-ID del carril rápido por defecto (PDO), ver CO_CANmodule_setRxFast(). NMT, SYNC, EMCY y TIME van siempre al carril alto
+#define DRV_RX_FAST_CLASSES (1U << CO_CAN_CLASS_PDO)
+
+// Capacidad reservada de cada carril RX (alto, rápido, normal), suma <= CO_CAN_RXLANES_SLOTS
+#define DRV_RX_LANE_HIGH_LEN 16
+#define DRV_RX_LANE_FAST_LEN 32
+#define DRV_RX_LANE_NORMAL_LEN 32
+
+// Recuperación de bus-off: espera inicial, máxima, y tiempo sin bus-off para reiniciar el backoff
+#define DRV_BUSOFF_BACKOFF CO_CAN_BUSOFF_BACKOFF_CAPPED
+#define DRV_BUSOFF_INITIAL_DELAY_MS 100
+#define DRV_BUSOFF_MAX_DELAY_MS 10000
+#define DRV_BUSOFF_STABLE_MS 30000
 
 // 2. Núcleo
 #define CONFIG_CO_TASK_CORE 0
 
+// Filtro de aceptación hardware construido desde rxArray (0 = aceptar todo)
+#define DRV_USE_HW_RX_FILTER 1
+
+// Tiempo sin cambios en rxArray antes de reiniciar el controlador con el filtro nuevo
+#define DRV_RX_FILTER_SETTLE_MS 100
+
+// Reloj del TWAI (TWAI_CLK_SRC_DEFAULT = APB en ESP32), para calcular BRP como twai_driver_install()
+#define DRV_TWAI_CLK_HZ 80000000UL
+
+// Detección de velocidad: escucha por candidata, tramas válidas para fijarla y
+// errores de bus tolerados por trama válida (1 de cada N)
+#define DRV_AUTOBAUD_DWELL_MS 250
+#define DRV_AUTOBAUD_LOCK_FRAMES 3
+#define DRV_AUTOBAUD_ERROR_RATIO 8
+
+// Ticks de espera, abortando la TX del controlador, antes de cambiar de modo o velocidad
+#define DRV_MODE_TX_DRAIN_TICKS (2 * DRV_TX_INFLIGHT_MAX)
+
 static StaticTask_t xCoTxTaskBuffer;
 static StackType_t xCoTxStack[DRV_TX_TASK_STACK_SIZE];
 static TaskHandle_t xCoTxTaskHandle = NULL;
@@ -84,8 +155,66 @@ static StackType_t xCoRxStack[DRV_RX_TASK_STACK_SIZE];
 static TaskHandle_t xCoRxTaskHandle = NULL;
 static void CO_rxTask(void *pxParam);
 
+static StaticTask_t xCoAlertTaskBuffer;
+static StackType_t xCoAlertStack[DRV_ALERT_TASK_STACK_SIZE];
+static TaskHandle_t xCoAlertTaskHandle = NULL;
+static void CO_alertTask(void *pxParam);
+
+/* Wakes the TX task, when tokens for a waiting bulk frame are available */
+static esp_timer_handle_t s_txShaperTimer = NULL;
+static void CO_txShaperTimerCallback(void *arg);
+static bool_t CO_CANtxIsBulk(const CO_CANmodule_t *CANmodule, uint32_t ident);
+
+/* Ends the switch delays of CO_CANmodule_switchBitRate() */
+static esp_timer_handle_t s_bitRateTimer = NULL;
+static void CO_bitRateTimerCallback(void *arg);
+
 static bool bInstalled = false;
 
+/* Dispatch index for rxArray, kept up to date by CO_CANrxBufferInit() */
+static CO_CANrxIndex_t s_rxIndex;
+
+/* Acceptance filter in the controller, count 0 while it is open */
+static CO_CANfilter_t s_rxFilter;
+
+/* Frames handed to the TWAI driver and not completed yet, in order of
+ * transmission. Changed by the TX task and the alert task with xMutexTwaiHdl
+ * held, so count always matches msgs_to_tx of the TWAI driver. */
+static struct
+{
+    struct
+    {
+        uint32_t queuedAt_us;
+        uint16_t ident;
+        bool_t syncFlag;
+        bool_t loadGen;
+    } frame[DRV_TX_INFLIGHT_MAX];
+    uint8_t head;
+    volatile uint8_t count;
+    volatile uint8_t syncCount;
+} s_txInflight;
+
+/* Received frames waiting for dispatch, owned by the RX task */
+static CO_CANrxLanes_t s_rxLanes;
+
+/* Incremented by the RX task before and after each dispatch, odd while
+ * rxArray is in use, see CO_CANrxQuiesce() */
+static volatile uint32_t s_rxDispatchSeq = 0U;
+
+/* Pending txArray buffers in CAN-ID priority order, protected by CO_LOCK_CAN_SEND */
+static CO_CANtxQueue_t s_txQueue;
+
+/* State of the current one second window of traffic statistics */
+static struct
+{
+    int64_t start_us;
+    uint32_t rxFrames[CO_CAN_CLASS_COUNT];
+    uint32_t txFrames[CO_CAN_CLASS_COUNT];
+    uint32_t bits;
+    uint8_t tecMax;
+    uint8_t recMax;
+} s_trafficWindow;
+
 /******************************************************************************/
 void CO_CANsetConfigurationMode(void *CANptr)
 {
@@ -93,13 +222,84 @@ void CO_CANsetConfigurationMode(void *CANptr)
 }
 
 /******************************************************************************/
+static void CO_CANapplyRxFilter(CO_CANmodule_t *CANmodule);
+static void CO_CANtxCompleteProcess(CO_CANmodule_t *CANmodule, uint32_t alerts);
+static bool_t CO_CANbitRateApply(CO_CANmodule_t *CANmodule, uint32_t *offline_us);
+static bool_t CO_CANrestartInMode(CO_CANmodule_t *CANmodule, twai_mode_t mode, const twai_timing_config_t *t_config,
+                                  const twai_filter_config_t *f_config);
+
 void CO_CANsetNormalMode(CO_CANmodule_t *CANmodule)
 {
     /* Put CAN module in normal mode */
+    if (CANmodule->useCANrxFilters && CANmodule->rxFilterDirty)
+    {
+        CO_CANapplyRxFilter(CANmodule);
+    }
 
     CANmodule->CANnormal = true;
 }
 
+/******************************************************************************/
+/* First synchronous TPDO after a SYNC, called with CO_LOCK_CAN_SEND held */
+static void CO_CANsyncQueued(CO_CANsyncQueueStats_t *stats, uint32_t syncRx_us, uint32_t now_us)
+{
+    uint32_t latency;
+    uint32_t diff;
+
+    if ((syncRx_us == 0U) || (syncRx_us == stats->lastSyncRx_us))
+    {
+        return;
+    }
+    latency = now_us - syncRx_us;
+    if (stats->cycles > 0U)
+    {
+        diff = (latency > stats->lastLatency_us) ? (latency - stats->lastLatency_us)
+                                                 : (stats->lastLatency_us - latency);
+        /* J += (|D| - J) / 16, kept scaled by 16 */
+        stats->jitter16_us = stats->jitter16_us + diff - ((stats->jitter16_us + 8U) >> 4);
+    }
+    if ((stats->cycles == 0U) || (latency < stats->minLatency_us))
+    {
+        stats->minLatency_us = latency;
+    }
+    if (latency > stats->maxLatency_us)
+    {
+        stats->maxLatency_us = latency;
+    }
+    stats->lastSyncRx_us = syncRx_us;
+    stats->lastLatency_us = latency;
+    stats->sumLatency_us += latency;
+    stats->cycles++;
+}
+
+/******************************************************************************/
+/* Stop dispatching received frames to rxArray and wait for the one in
+ * progress. Frames are dropped until CO_CANsetNormalMode(). */
+static void CO_CANrxQuiesce(CO_CANmodule_t *CANmodule)
+{
+    __atomic_store_n(&CANmodule->CANnormal, false, __ATOMIC_SEQ_CST);
+    while ((__atomic_load_n(&s_rxDispatchSeq, __ATOMIC_SEQ_CST) & 1U) != 0U)
+    {
+        taskYIELD();
+    }
+}
+
+/******************************************************************************/
+/* Bit timing of the bit rate from baudrate_config, NULL if not supported */
+static const twai_timing_config_t *CO_CANtimingOf(uint16_t kbps)
+{
+    uint16_t i;
+
+    for (i = 0U; i < (sizeof(baudrate_config) / sizeof(baudrate_config[0])); i++)
+    {
+        if (kbps == baudrate_config[i].kbps)
+        {
+            return &baudrate_config[i].timing_config;
+        }
+    }
+    return NULL;
+}
+
 /******************************************************************************/
 CO_ReturnError_t CO_CANmodule_init(
     CO_CANmodule_t *CANmodule,
@@ -111,6 +311,8 @@ CO_ReturnError_t CO_CANmodule_init(
     uint16_t CANbitRate)
 {
     uint16_t i;
+    bool_t warm = bInstalled;
+    bool_t txQueueOk;
 
     /* verify arguments */
     if (CANmodule == NULL || rxArray == NULL || txArray == NULL)
@@ -118,6 +320,14 @@ CO_ReturnError_t CO_CANmodule_init(
         return CO_ERROR_ILLEGAL_ARGUMENT;
     }
 
+    if (warm)
+    {
+        /* Communication reset with the driver installed: controller, tasks
+         * and mutexes stay, only CANopen objects are initialized again. RX
+         * task must not use rxArray meanwhile. */
+        CO_CANrxQuiesce(CANmodule);
+    }
+
 #if CONFIG_CO_LED_ENABLE
     gpio_config_t io_conf;
     uint64_t pinMask = 0ULL;
@@ -159,13 +369,31 @@ CO_ReturnError_t CO_CANmodule_init(
     CANmodule->rxSize = rxSize;
     CANmodule->txArray = txArray;
     CANmodule->txSize = txSize;
-    CANmodule->CANerrorStatus = 0;
+    if (!warm)
+    {
+        /* controller state, kept by warm init */
+        CANmodule->CANbitRate = CANbitRate;
+        CANmodule->CANerrorStatus = 0;
+        CANmodule->rxFilterAcceptedIds = CO_CAN_FILTER_ID_SPACE;
+        CANmodule->rxFilterConfig = (twai_filter_config_t)TWAI_FILTER_CONFIG_ACCEPT_ALL();
+        memset(&s_rxFilter, 0, sizeof(s_rxFilter));
+    }
     CANmodule->CANnormal = false;
-    CANmodule->useCANrxFilters = false;
+    CANmodule->useCANrxFilters = (DRV_USE_HW_RX_FILTER != 0);
     CANmodule->bufferInhibitFlag = false;
     CANmodule->firstCANtxMessage = true;
     CANmodule->CANtxCount = 0U;
     CANmodule->errOld = 0U;
+    CANmodule->txWakePending = false;
+    CANmodule->sendLatencyMax_us = 0U;
+    CANmodule->rxBatchLast = 0U;
+    CANmodule->rxBatchMax = 0U;
+    CANmodule->rxQueueHighWater = 0U;
+    CANmodule->rxFilterDirty = false;
+    CANmodule->rxFilterChanged_us = 0;
+    CANmodule->rxFilterLeakCount = 0U;
+    CANmodule->nmtRx_us = 0U;
+    CANmodule->firstTx_us = 0U;
 
     for (i = 0U; i < rxSize; i++)
     {
@@ -174,24 +402,79 @@ CO_ReturnError_t CO_CANmodule_init(
         rxArray[i].object = NULL;
         rxArray[i].CANrx_callback = NULL;
     }
+    CO_CANrxIndex_init(&s_rxIndex);
+
+    /* TX task may be running, messages of the previous session are dropped */
+    if (warm)
+    {
+        CO_LOCK_CAN_SEND(CANmodule);
+    }
     for (i = 0U; i < txSize; i++)
     {
         txArray[i].bufferFull = false;
+        txArray[i].lifetime_us = 0U;
+    }
+    txQueueOk = CO_CANtxQueue_init(&s_txQueue, txSize);
+    if (warm)
+    {
+        CO_UNLOCK_CAN_SEND(CANmodule);
+    }
+    if (!txQueueOk)
+    {
+        ESP_LOGE(TAG, "txSize %u exceeds CO_CAN_TXQUEUE_MAX", txSize);
+        return CO_ERROR_ILLEGAL_ARGUMENT;
     }
+    memset(CANmodule->txDelay, 0, sizeof(CANmodule->txDelay));
+    memset(&CANmodule->txDelayLoadGen, 0, sizeof(CANmodule->txDelayLoadGen));
+    memset(&CANmodule->txStale, 0, sizeof(CANmodule->txStale));
+    memset(CANmodule->rxLatency, 0, sizeof(CANmodule->rxLatency));
+    memset(CANmodule->rxLaneStats, 0, sizeof(CANmodule->rxLaneStats));
+    memset(&CANmodule->traffic, 0, sizeof(CANmodule->traffic));
+    CANmodule->syncIdent = 0x080U;
+    CANmodule->syncRx_us = 0U;
+    memset(&CANmodule->syncTx, 0, sizeof(CANmodule->syncTx));
+    memset(&CANmodule->syncQueue, 0, sizeof(CANmodule->syncQueue));
+    memset(&s_trafficWindow, 0, sizeof(s_trafficWindow));
+    s_trafficWindow.start_us = esp_timer_get_time();
+    if (!warm)
+    {
+        /* bus-off recovery, TX shaper and bit rate switch are owned by the
+         * running tasks, warm init keeps them */
+        memset(&CANmodule->busOff, 0, sizeof(CANmodule->busOff));
+        CANmodule->busOff.backoff = DRV_BUSOFF_BACKOFF;
+        CANmodule->busOff.initialDelay_ms = DRV_BUSOFF_INITIAL_DELAY_MS;
+        CANmodule->busOff.maxDelay_ms = DRV_BUSOFF_MAX_DELAY_MS;
+        CANmodule->busOff.runningSince_us = esp_timer_get_time();
+        memset(&CANmodule->txShaper, 0, sizeof(CANmodule->txShaper));
+        CANmodule->txShaper.bulkClasses = DRV_TX_SHAPER_BULK_CLASSES;
+        CANmodule->txShaper.share_permille = DRV_TX_SHAPER_SHARE_PERMILLE;
+        CANmodule->txShaper.burstFrames = DRV_TX_SHAPER_BURST_FRAMES;
+        CANmodule->txShaper.tokens_mbit = DRV_TX_SHAPER_DEPTH_MBIT(&CANmodule->txShaper);
+        CANmodule->txShaper.lastRefill_us = esp_timer_get_time();
+        memset(&CANmodule->bitRateSwitch, 0, sizeof(CANmodule->bitRateSwitch));
+        CANmodule->rxFastClasses = DRV_RX_FAST_CLASSES;
+        memset((void *)CANmodule->rxFastIdents, 0, sizeof(CANmodule->rxFastIdents));
+        CANmodule->txHold = false;
+        CANmodule->busOffRecovered = false;
+    }
+    CANmodule->functSignalObjectBusOff = NULL;
+    CANmodule->pFunctSignalBusOff = NULL;
+    CANmodule->functSignalObjectStatus = NULL;
+    CANmodule->pFunctSignalStatus = NULL;
 
     /* Configure CAN module registers */
     twai_general_config_t g_config = TWAI_GENERAL_CONFIG_DEFAULT(DRV_TWAI_TX_GPIO, DRV_TWAI_RX_GPIO, TWAI_MODE_NORMAL);
     twai_filter_config_t f_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
-    twai_timing_config_t t_config;
-    for (i = 0; i < (sizeof(baudrate_config) / sizeof(baudrate_config[0])); i++)
-    {
-        if (CANbitRate == baudrate_config[i].kbps)
-        {
-            t_config = baudrate_config[i].timing_config;
-            break;
-        }
-    }
-    if (i >= (sizeof(baudrate_config) / sizeof(baudrate_config[0])))
+    const twai_timing_config_t *t_config;
+    g_config.alerts_enabled = DRV_TWAI_ALERTS;
+    g_config.rx_queue_len = DRV_TWAI_RX_QUEUE_LEN;
+    g_config.tx_queue_len = DRV_TWAI_TX_QUEUE_LEN;
+#if CONFIG_TWAI_ISR_IN_IRAM
+    /* Keep receiving during flash writes (NVS, firmware update) */
+    g_config.intr_flags |= ESP_INTR_FLAG_IRAM;
+#endif
+    t_config = CO_CANtimingOf(CANbitRate);
+    if (t_config == NULL)
     {
         /* Baudrate not found */
         return CO_ERROR_ILLEGAL_BAUDRATE;
@@ -201,7 +484,8 @@ CO_ReturnError_t CO_CANmodule_init(
     if (bInstalled != true)
     {
         /* create Mutex */
-        CANmodule->xMutexCanSendHdl = xSemaphoreCreateRecursiveMutexStatic(&(CANmodule->xMutexCanSendBuf));
+        portMUX_INITIALIZE(&CANmodule->txLock);
+        CANmodule->xMutexTwaiHdl = xSemaphoreCreateRecursiveMutexStatic(&(CANmodule->xMutexTwaiBuf));
         CANmodule->xMutexEmcyHdl = xSemaphoreCreateRecursiveMutexStatic(&(CANmodule->xMutexEmcyBuf));
         CANmodule->xMutexODHdl = xSemaphoreCreateRecursiveMutexStatic(&(CANmodule->xMutexODBuf));
 
@@ -209,12 +493,39 @@ CO_ReturnError_t CO_CANmodule_init(
         // --- AÑADE ESTO PARA VER LA VERDAD ---
         ESP_LOGE(TAG, ">>> DEBUG: Intentando iniciar CAN con TX=%d y RX=%d", g_config.tx_io, g_config.rx_io);
         // -------------------------------------
-        ESP_ERROR_CHECK(twai_driver_install(&g_config, &t_config, &f_config));
+        ESP_ERROR_CHECK(twai_driver_install(&g_config, t_config, &f_config));
         ESP_LOGI(TAG, "Driver installed");
         ESP_ERROR_CHECK(twai_start());
         ESP_LOGI(TAG, "Driver started");
 
         bInstalled = true;
+        memset(&s_txInflight, 0, sizeof(s_txInflight));
+
+        const esp_timer_create_args_t shaperTimerArgs = {
+            .callback = CO_txShaperTimerCallback,
+            .arg = NULL,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "CO_txShaper",
+            .skip_unhandled_events = true,
+        };
+        if (esp_timer_create(&shaperTimerArgs, &s_txShaperTimer) != ESP_OK)
+        {
+            ESP_LOGE(TAG, "txShaper timer creation failed");
+            return CO_ERROR_OUT_OF_MEMORY;
+        }
+
+        const esp_timer_create_args_t bitRateTimerArgs = {
+            .callback = CO_bitRateTimerCallback,
+            .arg = (void *)CANmodule,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "CO_bitRate",
+            .skip_unhandled_events = false,
+        };
+        if (esp_timer_create(&bitRateTimerArgs, &s_bitRateTimer) != ESP_OK)
+        {
+            ESP_LOGE(TAG, "bitRate timer creation failed");
+            return CO_ERROR_OUT_OF_MEMORY;
+        }
 
         /* Create Tx tasks */
         ESP_LOGI(TAG, "Creating Tx Task");
@@ -248,10 +559,48 @@ CO_ReturnError_t CO_CANmodule_init(
             ESP_LOGE(TAG, "rxTask creation failed");
             return CO_ERROR_OUT_OF_MEMORY;
         }
+        CO_PROF_TASK(TX, xCoTxTaskHandle);
+        CO_PROF_TASK(RX, xCoRxTaskHandle);
+        /* Create alert task */
+        ESP_LOGI(TAG, "Creating Alert Task");
+        xCoAlertTaskHandle = xTaskCreateStaticPinnedToCore(
+            CO_alertTask,
+            "CO_alert",
+            DRV_ALERT_TASK_STACK_SIZE,
+            (void *)CANmodule,
+            DRV_ALERT_TASK_PRIORITY,
+            &xCoAlertStack[0],
+            &xCoAlertTaskBuffer,
+            CONFIG_CO_TASK_CORE);
+        if (xCoAlertTaskHandle == NULL)
+        {
+            ESP_LOGE(TAG, "alertTask creation failed");
+            return CO_ERROR_OUT_OF_MEMORY;
+        }
     }
     else
     {
-        ESP_LOGI(TAG, "Driver already installed");
+        uint32_t offline_us = 0U;
+
+        /* Frames of the previous session, which did not reach the controller
+         * yet, would delay the bootup message. They are accounted as done. */
+        xSemaphoreTakeRecursive(CANmodule->xMutexTwaiHdl, portMAX_DELAY);
+        (void)twai_clear_transmit_queue();
+        CO_CANtxCompleteProcess(CANmodule, 0U);
+        xSemaphoreGiveRecursive(CANmodule->xMutexTwaiHdl);
+
+        /* New bit rate (LSS store, auto-baud) is set in place */
+        if (CANbitRate != CANmodule->CANbitRate)
+        {
+            CANmodule->bitRateSwitch.newBitRate = CANbitRate;
+            if ((CANmodule->bitRateSwitch.state != CO_CAN_BITRATE_SWITCH_IDLE) ||
+                !CO_CANbitRateApply(CANmodule, &offline_us))
+            {
+                ESP_LOGW(TAG, "Bit rate %u kbit/s not set, controller stays at %u kbit/s", CANbitRate,
+                         CANmodule->CANbitRate);
+            }
+        }
+        ESP_LOGI(TAG, "Driver kept running, %u kbit/s", CANmodule->CANbitRate);
     }
 
     return CO_ERROR_NO;
@@ -260,36 +609,139 @@ CO_ReturnError_t CO_CANmodule_init(
 /******************************************************************************/
 void CO_CANmodule_disable(CO_CANmodule_t *CANmodule)
 {
-    if (CANmodule != NULL)
+    /* CO_delete() after the application already disabled it */
+    if ((CANmodule != NULL) && bInstalled)
     {
         /* Take all mutex before deleting it */
-        xSemaphoreTakeRecursive(CANmodule->xMutexCanSendHdl, portMAX_DELAY);
+        xSemaphoreTakeRecursive(CANmodule->xMutexTwaiHdl, portMAX_DELAY);
         xSemaphoreTakeRecursive(CANmodule->xMutexEmcyHdl, portMAX_DELAY);
         xSemaphoreTakeRecursive(CANmodule->xMutexODHdl, portMAX_DELAY);
 
-        /* Delete Tx and Rx Tasks */
+        /* Delete Tx, Rx and Alert Tasks */
+        CO_PROF_TASK(TX, NULL);
+        CO_PROF_TASK(RX, NULL);
         vTaskDelete(xCoTxTaskHandle);
         xCoTxTaskHandle = NULL;
         vTaskDelete(xCoRxTaskHandle);
         xCoRxTaskHandle = NULL;
-        ESP_LOGI(TAG, "tx and rx tasks deleted");
+        vTaskDelete(xCoAlertTaskHandle);
+        xCoAlertTaskHandle = NULL;
+        ESP_LOGI(TAG, "tx, rx and alert tasks deleted");
+        (void)esp_timer_stop(s_txShaperTimer);
+        (void)esp_timer_delete(s_txShaperTimer);
+        s_txShaperTimer = NULL;
+        (void)esp_timer_stop(s_bitRateTimer);
+        (void)esp_timer_delete(s_bitRateTimer);
+        s_bitRateTimer = NULL;
+        CANmodule->bitRateSwitch.state = CO_CAN_BITRATE_SWITCH_IDLE;
 
         /* As holder of mutex, it is safe to delete it */
-        vSemaphoreDelete(CANmodule->xMutexCanSendHdl);
+        vSemaphoreDelete(CANmodule->xMutexTwaiHdl);
         vSemaphoreDelete(CANmodule->xMutexEmcyHdl);
         vSemaphoreDelete(CANmodule->xMutexODHdl);
-        CANmodule->xMutexCanSendHdl = NULL;
+        CANmodule->xMutexTwaiHdl = NULL;
         CANmodule->xMutexEmcyHdl = NULL;
         CANmodule->xMutexODHdl = NULL;
         ESP_LOGI(TAG, "mutex deleted");
 
-        /* Uninstall TWAI */
-        ESP_ERROR_CHECK(twai_stop());
-        ESP_LOGI(TAG, "Driver stopped");
+        /* Uninstall TWAI. Controller, which is bus-off, is already stopped */
+        if (twai_stop() == ESP_OK)
+        {
+            ESP_LOGI(TAG, "Driver stopped");
+        }
         ESP_ERROR_CHECK(twai_driver_uninstall());
         ESP_LOGI(TAG, "Driver uninstalled");
 
         bInstalled = false;
+        CANmodule->listenOnly = false;
+        CANmodule->pFunctListen = NULL;
+    }
+}
+
+/******************************************************************************/
+void CO_CANmodule_initCallbackBusOff(CO_CANmodule_t *CANmodule, void *object, void (*pFunctSignal)(void *object))
+{
+    if (CANmodule != NULL)
+    {
+        CANmodule->functSignalObjectBusOff = object;
+        CANmodule->pFunctSignalBusOff = pFunctSignal;
+    }
+}
+
+/******************************************************************************/
+bool_t CO_CANmodule_setTxShaper(CO_CANmodule_t *CANmodule, uint8_t bulkClasses, uint16_t share_permille,
+                                uint16_t burstFrames)
+{
+    CO_CANtxShaper_t *shaper;
+    uint32_t depth;
+    uint16_t i;
+
+    if ((CANmodule == NULL) || (bulkClasses >= (1U << CO_CAN_CLASS_COUNT)) || (share_permille == 0U) ||
+        (share_permille > 1000U) || (burstFrames == 0U) || (burstFrames > DRV_TX_SHAPER_BURST_MAX))
+    {
+        return false;
+    }
+    shaper = &CANmodule->txShaper;
+
+    CO_LOCK_CAN_SEND(CANmodule);
+    shaper->bulkClasses = bulkClasses;
+    shaper->share_permille = share_permille;
+    shaper->burstFrames = burstFrames;
+    depth = DRV_TX_SHAPER_DEPTH_MBIT(shaper);
+    if (shaper->tokens_mbit > depth)
+    {
+        shaper->tokens_mbit = depth;
+    }
+    for (i = 0U; i < CANmodule->txSize; i++)
+    {
+        CO_CANtxQueue_setShaped(&s_txQueue, i, CO_CANtxIsBulk(CANmodule, CANmodule->txArray[i].ident));
+    }
+    CO_UNLOCK_CAN_SEND(CANmodule);
+
+    /* Frames waiting for tokens may go now */
+    if (xCoTxTaskHandle != NULL)
+    {
+        xTaskNotifyGive(xCoTxTaskHandle);
+    }
+    return true;
+}
+
+/******************************************************************************/
+bool_t CO_CANmodule_setRxFast(CO_CANmodule_t *CANmodule, uint8_t fastClasses, const uint16_t *idents,
+                              uint16_t identCount)
+{
+    uint32_t fastIdents[CO_CAN_RX_FAST_IDENT_WORDS] = {0};
+    uint16_t i;
+
+    if ((CANmodule == NULL) || (fastClasses >= (1U << CO_CAN_CLASS_COUNT)) || ((idents == NULL) && (identCount > 0U)))
+    {
+        return false;
+    }
+    for (i = 0U; i < identCount; i++)
+    {
+        if (idents[i] > 0x7FFU)
+        {
+            return false;
+        }
+        fastIdents[idents[i] / 32U] |= 1UL << (idents[i] % 32U);
+    }
+
+    /* RX task reads the set without lock, each word is written at once */
+    for (i = 0U; i < CO_CAN_RX_FAST_IDENT_WORDS; i++)
+    {
+        CANmodule->rxFastIdents[i] = fastIdents[i];
+    }
+    CANmodule->rxFastClasses = fastClasses;
+    return true;
+}
+
+/******************************************************************************/
+void CO_CANmodule_initCallbackStatus(CO_CANmodule_t *CANmodule, void *object, void (*pFunctSignal)(void *object))
+{
+    if (CANmodule != NULL)
+    {
+        CANmodule->functSignalObjectStatus = object;
+        CANmodule->pFunctSignalStatus = pFunctSignal;
     }
 }
 
@@ -310,6 +762,9 @@ CO_ReturnError_t CO_CANrxBufferInit(
         /* buffer, which will be configured */
         CO_CANrx_t *buffer = &CANmodule->rxArray[index];
 
+        uint16_t oldIdent = buffer->ident;
+        uint16_t oldMask = buffer->mask;
+
         /* Configure object variables */
         buffer->object = object;
         buffer->CANrx_callback = CANrx_callback;
@@ -322,9 +777,14 @@ CO_ReturnError_t CO_CANrxBufferInit(
         }
         buffer->mask = (mask & 0x07FFU) | 0x0800U;
 
-        /* Set CAN hardware module filter and mask. */
-        if (CANmodule->useCANrxFilters)
+        CO_CANrxIndex_update(&s_rxIndex, CANmodule->rxArray, CANmodule->rxSize, index, oldIdent, oldMask);
+
+        /* Set CAN hardware module filter and mask. Filter is rebuilt from the
+         * whole rxArray in CO_CANsetNormalMode() or CO_CANmodule_process(). */
+        if (CANmodule->useCANrxFilters && ((buffer->ident != oldIdent) || (buffer->mask != oldMask)))
         {
+            CANmodule->rxFilterDirty = true;
+            CANmodule->rxFilterChanged_us = esp_timer_get_time();
         }
     }
     else
@@ -335,6 +795,14 @@ CO_ReturnError_t CO_CANrxBufferInit(
     return ret;
 }
 
+/* Frame with this identifier is limited by the TX shaper */
+static bool_t CO_CANtxIsBulk(const CO_CANmodule_t *CANmodule, uint32_t ident)
+{
+    const CO_CANtxShaper_t *shaper = &CANmodule->txShaper;
+
+    return (shaper->share_permille < 1000U) && (((1U << CO_CAN_CLASS_OF(ident)) & shaper->bulkClasses) != 0U);
+}
+
 /******************************************************************************/
 CO_CANtx_t *CO_CANtxBufferInit(
     CO_CANmodule_t *CANmodule,
@@ -350,6 +818,13 @@ CO_CANtx_t *CO_CANtxBufferInit(
     {
         /* get specific buffer */
         buffer = &CANmodule->txArray[index];
+
+        CO_LOCK_CAN_SEND(CANmodule);
+        if (buffer->bufferFull)
+        {
+            CO_CANtxQueue_remove(&s_txQueue, index);
+            CANmodule->CANtxCount--;
+        }
         buffer->ident = (uint32_t)ident & 0x07FFU;
         if (rtr)
         {
@@ -358,6 +833,9 @@ CO_CANtx_t *CO_CANtxBufferInit(
         buffer->DLC = noOfBytes;
         buffer->bufferFull = false;
         buffer->syncFlag = syncFlag;
+        CO_CANtxQueue_setIdent(&s_txQueue, index, ident & 0x07FFU);
+        CO_CANtxQueue_setShaped(&s_txQueue, index, CO_CANtxIsBulk(CANmodule, ident));
+        CO_UNLOCK_CAN_SEND(CANmodule);
     }
 
     return buffer;
@@ -367,19 +845,9 @@ CO_CANtx_t *CO_CANtxBufferInit(
 CO_ReturnError_t CO_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer)
 {
     CO_ReturnError_t err = CO_ERROR_NO;
-
-    CO_LOCK_CAN_SEND(CANmodule);
-
-    /* Verify overflow */
-    if (buffer->bufferFull)
-    {
-        if (!CANmodule->firstCANtxMessage)
-        {
-            /* don't set error, if bootup message is still on buffers */
-            CANmodule->CANerrorStatus |= CO_CAN_ERRTX_OVERFLOW;
-        }
-        err = CO_ERROR_TX_OVERFLOW;
-    }
+    bool_t notify = false;
+    uint32_t start_us = (uint32_t)esp_timer_get_time();
+    uint32_t latency_us;
 
 #if CONFIG_CO_DEBUG_DRIVER_CAN_SEND
     ESP_LOGI(TAG, "CANTX id: 0x%lx, dlc: %d, data: [%d %d %d %d %d %d %d %d]",
@@ -395,138 +863,1100 @@ CO_ReturnError_t CO_CANsend(CO_CANmodule_t *CANmodule, CO_CANtx_t *buffer)
              buffer->data[7]);
 #endif
 
+    /* Only mark the buffer here, TX task hands it to the TWAI driver */
+    CO_LOCK_CAN_SEND(CANmodule);
+
+    /* Verify overflow */
+    if (buffer->bufferFull && (buffer->lifetime_us != 0U))
+    {
+        /* newer sample replaces the queued one, its age starts now */
+        buffer->queuedAt_us = start_us;
+        CANmodule->txStale.replaced[CO_CAN_CLASS_OF(buffer->ident)]++;
+    }
+    else if (buffer->bufferFull)
+    {
+        if (!CANmodule->firstCANtxMessage)
+        {
+            /* don't set error, if bootup message is still on buffers */
+            CANmodule->CANerrorStatus |= CO_CAN_ERRTX_OVERFLOW;
+        }
+        err = CO_ERROR_TX_OVERFLOW;
+    }
+    else
+    {
+        /* new message, queue it by its CAN-ID priority */
+        CO_CANtxQueue_push(&s_txQueue, (uint16_t)(buffer - CANmodule->txArray), buffer->syncFlag);
+        buffer->queuedAt_us = start_us;
+        CANmodule->CANtxCount++;
+        if (buffer->syncFlag)
+        {
+            CO_CANsyncQueued(&CANmodule->syncQueue, CANmodule->syncRx_us, start_us);
+        }
+    }
     buffer->bufferFull = true;
-    CANmodule->CANtxCount++;
-    xTaskNotify(xCoTxTaskHandle, 0, eNoAction);
+
+    /* Wake TX task only once, until it finds the queue empty again */
+    if (!CANmodule->txWakePending)
+    {
+        CANmodule->txWakePending = true;
+        notify = true;
+    }
     CO_UNLOCK_CAN_SEND(CANmodule);
 
+    if (notify)
+    {
+        xTaskNotifyGive(xCoTxTaskHandle);
+    }
+
+    latency_us = (uint32_t)esp_timer_get_time() - start_us;
+    if (latency_us > CANmodule->sendLatencyMax_us)
+    {
+        CANmodule->sendLatencyMax_us = latency_us;
+    }
+
     return err;
 }
 
 /******************************************************************************/
 void CO_CANclearPendingSyncPDOs(CO_CANmodule_t *CANmodule)
 {
-    uint32_t tpdoDeleted = 0U;
+    bool_t abortInController = false;
+    bool_t tpdoDeleted = false;
 
     CO_LOCK_CAN_SEND(CANmodule);
-    /* Abort message from CAN module, if there is synchronous TPDO.
-     * Take special care with this functionality. */
-    if (/*messageIsOnCanBuffer && */ CANmodule->bufferInhibitFlag)
-    {
-        /* clear TXREQ */
-        CANmodule->bufferInhibitFlag = false;
-        tpdoDeleted = 1U;
-    }
+    /* Synchronous TPDO in the controller is aborted below. Flag is cleared,
+     * when its TX completion alert arrives. */
+    abortInController = CANmodule->bufferInhibitFlag;
     /* delete also pending synchronous TPDOs in TX buffers */
     if (CANmodule->CANtxCount != 0U)
     {
         uint16_t i;
-        CO_CANtx_t *buffer = &CANmodule->txArray[0];
-        for (i = CANmodule->txSize; i > 0U; i--)
+        while ((i = CO_CANtxQueue_popSync(&s_txQueue)) != CO_CAN_TXQUEUE_NONE)
         {
-            if (buffer->bufferFull)
-            {
-                if (buffer->syncFlag)
-                {
-                    buffer->bufferFull = false;
-                    CANmodule->CANtxCount--;
-                    tpdoDeleted = 2U;
-                }
-            }
-            buffer++;
+            CANmodule->txArray[i].bufferFull = false;
+            CANmodule->CANtxCount--;
+            CANmodule->syncTx.dropped++;
+            tpdoDeleted = true;
         }
     }
+    if (tpdoDeleted)
+    {
+        CANmodule->CANerrorStatus |= CO_CAN_ERRTX_PDO_LATE;
+    }
     CO_UNLOCK_CAN_SEND(CANmodule);
 
-    if (tpdoDeleted != 0U)
+    if (abortInController)
     {
-        CANmodule->CANerrorStatus |= CO_CAN_ERRTX_PDO_LATE;
+        /* TX task puts synchronous TPDO only into an idle controller and adds
+         * nothing after it, so the abort command hits only that frame. If it
+         * is already on the bus, it completes normally. Result is handled in
+         * CO_CANtxCompleteProcess(). */
+        xSemaphoreTakeRecursive(CANmodule->xMutexTwaiHdl, portMAX_DELAY);
+        if (s_txInflight.syncCount != 0U)
+        {
+            twai_ll_set_cmd_abort_tx(TWAI_LL_GET_HW(0));
+        }
+        xSemaphoreGiveRecursive(CANmodule->xMutexTwaiHdl);
     }
 }
 
 /******************************************************************************/
-/* Get error counters from the module. If necessary, function may use
- * different way to determine errors. */
-static uint16_t rxErrors = 0, txErrors = 0, overflow = 0;
+/* Convert filter to TWAI acceptance code/mask. Mask bit set means "don't care".
+ * Single filter: ID in bits 31..21, RTR in bit 20.
+ * Dual filter: filter 1 ID in bits 31..21, RTR in bit 20, filter 2 ID in bits
+ * 15..5, RTR in bit 4. First data byte bits of filter 1 stay "don't care". */
+static void CO_CANfilterToTwai(const CO_CANfilter_t *filter, twai_filter_config_t *f_config)
+{
+    uint32_t code;
+    uint32_t care;
 
-void CO_CANmodule_process(CO_CANmodule_t *CANmodule)
+    if (filter->count == 0U)
+    {
+        *f_config = (twai_filter_config_t)TWAI_FILTER_CONFIG_ACCEPT_ALL();
+        return;
+    }
+
+    code = ((uint32_t)(filter->ident[0] & 0x07FFU) << 21) | ((uint32_t)((filter->ident[0] >> 11) & 1U) << 20);
+    care = ((uint32_t)(filter->mask[0] & 0x07FFU) << 21) | ((uint32_t)((filter->mask[0] >> 11) & 1U) << 20);
+    if (filter->count == 2U)
+    {
+        code |= ((uint32_t)(filter->ident[1] & 0x07FFU) << 5) | ((uint32_t)((filter->ident[1] >> 11) & 1U) << 4);
+        care |= ((uint32_t)(filter->mask[1] & 0x07FFU) << 5) | ((uint32_t)((filter->mask[1] >> 11) & 1U) << 4);
+    }
+
+    f_config->acceptance_code = code;
+    f_config->acceptance_mask = ~care;
+    f_config->single_filter = (filter->count == 1U);
+}
+
+/* Program the acceptance filter from rxArray. Legacy TWAI driver sets the
+ * filter only at install, so acceptance registers are rewritten by
+ * CO_CANrestartInMode(). Driver, queues and tasks are kept. Frames in the RX
+ * FIFO of the controller are lost, so this is done at communication reset and
+ * at runtime only, if the filter in the controller rejects a configured
+ * identifier. If transmission is pending or controller is not running, filter
+ * stays dirty and is applied on next call. */
+static void CO_CANapplyRxFilter(CO_CANmodule_t *CANmodule)
 {
-    uint32_t err;
+    CO_CANfilter_t filter;
+    twai_filter_config_t f_config;
     twai_status_info_t statusInfo;
-    esp_err_t espRet = ESP_OK;
+    bool applied = false;
 
-    espRet = twai_get_status_info(&statusInfo);
-    if (espRet != ESP_OK)
+    CO_CANfilter_build(CANmodule->rxArray, CANmodule->rxSize, &filter);
+    CO_CANfilterToTwai(&filter, &f_config);
+
+    /* Same filter as in the controller (communication reset), no restart */
+    if ((f_config.acceptance_code == CANmodule->rxFilterConfig.acceptance_code) &&
+        (f_config.acceptance_mask == CANmodule->rxFilterConfig.acceptance_mask) &&
+        (f_config.single_filter == CANmodule->rxFilterConfig.single_filter))
     {
-        ESP_LOGW(TAG, "twai_get_status_info returns %d", espRet);
+        CANmodule->rxFilterDirty = false;
         return;
     }
 
-    txErrors = (uint16_t)(statusInfo.tx_error_counter);
-    rxErrors = (uint16_t)(statusInfo.rx_error_counter);
-    overflow = (uint16_t)(statusInfo.rx_overrun_count);
+    /* TX task hands frames to the driver with the mutex held, so none is
+     * aborted by the restart */
+    xSemaphoreTakeRecursive(CANmodule->xMutexTwaiHdl, portMAX_DELAY);
+    if ((twai_get_status_info(&statusInfo) == ESP_OK) && (statusInfo.state == TWAI_STATE_RUNNING) &&
+        (statusInfo.msgs_to_tx == 0U) &&
+        CO_CANrestartInMode(CANmodule, TWAI_MODE_NORMAL, CO_CANtimingOf(CANmodule->CANbitRate), &f_config))
+    {
+        CANmodule->rxFilterDirty = false;
+        CANmodule->rxFilterAcceptedIds = filter.acceptedIds;
+        CANmodule->rxFilterConfig = f_config;
+        s_rxFilter = filter;
+        applied = true;
+    }
+    xSemaphoreGiveRecursive(CANmodule->xMutexTwaiHdl);
+
+    if (applied)
+    {
+        ESP_LOGI(TAG, "RX filter (%s): %u of %u identifiers accepted, %u rejected in hardware",
+                 (filter.count == 0U) ? "open" : ((filter.count == 1U) ? "single" : "dual"),
+                 filter.acceptedIds, CO_CAN_FILTER_ID_SPACE, CO_CAN_FILTER_ID_SPACE - filter.acceptedIds);
+    }
+}
 
-    err = ((uint32_t)txErrors << 16) | ((uint32_t)rxErrors << 8) | overflow;
+/* Bit timing registers, computed as twai_driver_install() does. Controller
+ * must be in reset mode. */
+static void CO_CANsetBusTiming(twai_dev_t *hw, const twai_timing_config_t *t_config)
+{
+    uint32_t brp = t_config->brp;
 
-    if (CANmodule->errOld != err)
+    if (t_config->quanta_resolution_hz != 0U)
     {
-        uint16_t status = CANmodule->CANerrorStatus;
+        brp = DRV_TWAI_CLK_HZ / t_config->quanta_resolution_hz;
+    }
+    twai_ll_set_bus_timing(hw, brp, t_config->sjw, t_config->tseg_1, t_config->tseg_2, t_config->triple_sampling);
+}
 
-        CANmodule->errOld = err;
+/* Restart the running controller with new bit timing, acceptance filter and
+ * mode. twai_stop()/twai_start() can not be used: twai_start() leaves reset
+ * mode in the mode given to twai_driver_install(), so the controller would be
+ * in normal mode (ACK, error frames) until listen-only is set again. Here
+ * all registers, mode included, are written in reset mode and the controller
+ * joins the bus only in the requested mode. The TWAI driver stays in running
+ * state.
+ *
+ * Caller holds xMutexTwaiHdl and keeps the TX task from handing frames to the
+ * driver. Frames, which are still in the driver, are aborted first. Returns
+ * false, if controller is not running or its TX did not get idle. */
+static bool_t CO_CANrestartInMode(CO_CANmodule_t *CANmodule, twai_mode_t mode, const twai_timing_config_t *t_config,
+                                  const twai_filter_config_t *f_config)
+{
+    static portMUX_TYPE regLock = portMUX_INITIALIZER_UNLOCKED;
+    twai_dev_t *hw = TWAI_LL_GET_HW(0);
+    twai_status_info_t statusInfo;
+    uint32_t ticks = 0U;
 
-        if (txErrors >= 256U)
+    while (true)
+    {
+        if ((twai_get_status_info(&statusInfo) != ESP_OK) || (statusInfo.state != TWAI_STATE_RUNNING))
         {
-            /* bus off */
-            status |= CO_CAN_ERRTX_BUS_OFF;
+            return false;
         }
-        else
+        if (statusInfo.msgs_to_tx == 0U)
         {
-            /* recalculate CANerrorStatus, first clear some flags */
-            status &= 0xFFFF ^ (CO_CAN_ERRTX_BUS_OFF |
-                                CO_CAN_ERRRX_WARNING | CO_CAN_ERRRX_PASSIVE |
-                                CO_CAN_ERRTX_WARNING | CO_CAN_ERRTX_PASSIVE);
-
-            /* rx bus warning or passive */
-            if (rxErrors >= 128)
-            {
-                status |= CO_CAN_ERRRX_WARNING | CO_CAN_ERRRX_PASSIVE;
-            }
-            else if (rxErrors >= 96)
-            {
-                status |= CO_CAN_ERRRX_WARNING;
-            }
-
-            /* tx bus warning or passive */
-            if (txErrors >= 128)
-            {
-                status |= CO_CAN_ERRTX_WARNING | CO_CAN_ERRTX_PASSIVE;
-            }
-            else if (rxErrors >= 96)
-            {
-                status |= CO_CAN_ERRTX_WARNING;
-            }
-
-            /* if not tx passive clear also overflow */
-            if ((status & CO_CAN_ERRTX_PASSIVE) == 0)
-            {
-                status &= 0xFFFF ^ CO_CAN_ERRTX_OVERFLOW;
-            }
+            break;
         }
-
-        if (overflow != 0)
+        if (ticks >= DRV_MODE_TX_DRAIN_TICKS)
         {
-            /* CAN RX bus overflow */
-            status |= CO_CAN_ERRRX_OVERFLOW;
+            return false;
         }
-
-        CANmodule->CANerrorStatus = status;
+        /* Frame already on the bus completes, driver loads the next one */
+        twai_ll_set_cmd_abort_tx(hw);
+        vTaskDelay(1);
+        ticks++;
+    }
+    if (ticks > 0U)
+    {
+        CO_CANtxCompleteProcess(CANmodule, TWAI_ALERT_TX_FAILED);
     }
-}
+
+    /* Controller is off the bus only for these register writes. Reset mode
+     * also empties its RX FIFO, as twai_stop() does. */
+    portENTER_CRITICAL(&regLock);
+    twai_ll_enter_reset_mode(hw);
+    CO_CANsetBusTiming(hw, t_config);
+    twai_ll_set_acc_filter(hw, f_config->acceptance_code, f_config->acceptance_mask, f_config->single_filter);
+    twai_ll_set_mode(hw, mode);
+    /* Error counters as twai_start() sets them. ESP32 sends dominant error
+     * flags even in listen-only mode, error passive state prevents them. */
+    twai_ll_set_tec(hw, 0U);
+#if CONFIG_TWAI_ERRATA_FIX_LISTEN_ONLY_DOM
+    twai_ll_set_rec(hw, (mode == TWAI_MODE_LISTEN_ONLY) ? 128U : 0U);
+#else
+    twai_ll_set_rec(hw, 0U);
+#endif
+    twai_ll_exit_reset_mode(hw);
+    portEXIT_CRITICAL(&regLock);
+    return true;
+}
+
+/******************************************************************************/
+bool_t CO_CANmodule_setListenOnly(CO_CANmodule_t *CANmodule, uint16_t bitRate_kbps, void *object,
+                                  void (*pFunctFrame)(void *object, const CO_CANrxMsg_t *rcvMsg))
+{
+    const twai_timing_config_t *t_config;
+    twai_filter_config_t f_config = TWAI_FILTER_CONFIG_ACCEPT_ALL();
+    CO_CANfilter_t filter;
+    bool_t listenOnly = pFunctFrame != NULL;
+    bool_t wasListenOnly;
+    void *oldObject;
+    void (*pOldFunct)(void *object, const CO_CANrxMsg_t *rcvMsg);
+    bool_t done;
+
+    if ((CANmodule == NULL) || !bInstalled)
+    {
+        return false;
+    }
+    oldObject = CANmodule->functSignalObjectListen;
+    pOldFunct = CANmodule->pFunctListen;
+    if (!listenOnly || (bitRate_kbps == 0U))
+    {
+        bitRate_kbps = CANmodule->CANbitRate;
+    }
+    t_config = CO_CANtimingOf(bitRate_kbps);
+    if (t_config == NULL)
+    {
+        return false;
+    }
+    filter.count = 0U;
+    filter.acceptedIds = CO_CAN_FILTER_ID_SPACE;
+    if (!listenOnly && CANmodule->useCANrxFilters)
+    {
+        CO_CANfilter_build(CANmodule->rxArray, CANmodule->rxSize, &filter);
+        CO_CANfilterToTwai(&filter, &f_config);
+    }
+
+    /* TX task stops handing messages to the controller */
+    CO_LOCK_CAN_SEND(CANmodule);
+    wasListenOnly = CANmodule->listenOnly;
+    CANmodule->listenOnly = true;
+    CO_UNLOCK_CAN_SEND(CANmodule);
+    CANmodule->pFunctListen = NULL;
+    CANmodule->functSignalObjectListen = object;
+    CANmodule->pFunctListen = pFunctFrame;
+
+    xSemaphoreTakeRecursive(CANmodule->xMutexTwaiHdl, portMAX_DELAY);
+    done = CO_CANrestartInMode(CANmodule, listenOnly ? TWAI_MODE_LISTEN_ONLY : TWAI_MODE_NORMAL, t_config, &f_config);
+    if (done)
+    {
+        CANmodule->rxFilterConfig = f_config;
+        s_rxFilter = filter;
+        if (!listenOnly)
+        {
+            CANmodule->rxFilterDirty = false;
+            CANmodule->rxFilterAcceptedIds = filter.acceptedIds;
+        }
+    }
+    xSemaphoreGiveRecursive(CANmodule->xMutexTwaiHdl);
+
+    if (!done)
+    {
+        ESP_LOGW(TAG, "Controller is not running or its TX is busy, mode not changed");
+        CANmodule->pFunctListen = NULL;
+        CANmodule->functSignalObjectListen = oldObject;
+        CANmodule->pFunctListen = pOldFunct;
+        listenOnly = wasListenOnly;
+    }
+    else
+    {
+        ESP_LOGI(TAG, "%s mode at %u kbit/s", listenOnly ? "Listen-only" : "Normal", bitRate_kbps);
+    }
+    if (!listenOnly)
+    {
+        /* send messages, which were queued meanwhile */
+        CO_LOCK_CAN_SEND(CANmodule);
+        CANmodule->listenOnly = false;
+        CANmodule->txWakePending = true;
+        CO_UNLOCK_CAN_SEND(CANmodule);
+        xTaskNotifyGive(xCoTxTaskHandle);
+    }
+    return done;
+}
+
+/******************************************************************************/
+/* Frames received at the candidate bit rate */
+static void CO_CANautoBaudFrame(void *object, const CO_CANrxMsg_t *rcvMsg)
+{
+    (void)rcvMsg;
+    (*(volatile uint32_t *)object)++;
+}
+
+uint16_t CO_CANmodule_detectBitRate(CO_CANmodule_t *CANmodule, uint16_t firstKbps, uint32_t timeout_ms)
+{
+    static const uint16_t candidates = sizeof(baudrate_config) / sizeof(baudrate_config[0]);
+    uint32_t valid[sizeof(baudrate_config) / sizeof(baudrate_config[0])] = {0};
+    uint32_t errors[sizeof(baudrate_config) / sizeof(baudrate_config[0])] = {0};
+    int64_t end_us = esp_timer_get_time() + ((int64_t)timeout_ms * 1000);
+    volatile uint32_t frames = 0U;
+    uint16_t start = 0U;
+    uint16_t detected = 0U;
+    uint16_t best = 0U;
+    uint16_t i, k;
+    int32_t bestScore = 0;
+
+    if ((CANmodule == NULL) || !bInstalled)
+    {
+        return 0U;
+    }
+    /* expected rate first, so a correct guess is confirmed within one dwell */
+    for (i = 0U; i < candidates; i++)
+    {
+        if (baudrate_config[i].kbps == firstKbps)
+        {
+            start = i;
+        }
+    }
+
+    while ((detected == 0U) && (esp_timer_get_time() < end_us))
+    {
+        for (k = 0U; (k < candidates) && (detected == 0U) && (esp_timer_get_time() < end_us); k++)
+        {
+            twai_status_info_t before, after;
+            uint32_t waited_ms = 0U;
+            uint32_t busErrors = 0U;
+
+            i = (uint16_t)((start + k) % candidates);
+            if (!CO_CANmodule_setListenOnly(CANmodule, baudrate_config[i].kbps, (void *)&frames,
+                                            CO_CANautoBaudFrame))
+            {
+                /* bus-off or TX not idle, other candidates would fail too */
+                end_us = 0;
+                break;
+            }
+            /* frames still queued from the previous rate are not counted */
+            vTaskDelay(1);
+            frames = 0U;
+            (void)twai_get_status_info(&before);
+            after = before;
+            while (waited_ms < DRV_AUTOBAUD_DWELL_MS)
+            {
+                vTaskDelay(1);
+                waited_ms += portTICK_PERIOD_MS;
+                (void)twai_get_status_info(&after);
+                busErrors = after.bus_error_count - before.bus_error_count;
+                if ((frames >= DRV_AUTOBAUD_LOCK_FRAMES) && (busErrors == 0U))
+                {
+                    break;
+                }
+            }
+
+            valid[i] += frames;
+            errors[i] += busErrors;
+            ESP_LOGI(TAG, "Auto-baud %u kbit/s: %lu frames, %lu bus errors", baudrate_config[i].kbps,
+                     (unsigned long)frames, (unsigned long)busErrors);
+            if ((frames >= DRV_AUTOBAUD_LOCK_FRAMES) && ((busErrors * DRV_AUTOBAUD_ERROR_RATIO) <= frames))
+            {
+                detected = baudrate_config[i].kbps;
+            }
+        }
+    }
+
+    /* Timeout without lock (little traffic): best ranked rate, which received
+     * more valid frames than it saw errors */
+    for (i = 0U; (detected == 0U) && (i < candidates); i++)
+    {
+        int32_t score = (int32_t)valid[i] - (int32_t)errors[i];
+
+        if ((valid[i] > 0U) && (score > bestScore))
+        {
+            bestScore = score;
+            best = baudrate_config[i].kbps;
+        }
+    }
+    if (detected == 0U)
+    {
+        detected = best;
+    }
+
+    (void)CO_CANmodule_setListenOnly(CANmodule, 0U, NULL, NULL);
+    return detected;
+}
+
+/******************************************************************************/
+bool_t CO_CANbitRateSupported(uint16_t bitRate_kbps)
+{
+    return CO_CANtimingOf(bitRate_kbps) != NULL;
+}
+
+/******************************************************************************/
+bool_t CO_CANmodule_switchBitRate(CO_CANmodule_t *CANmodule, uint16_t bitRate_kbps, uint16_t delay_ms)
+{
+    CO_CANbitRateSwitch_t *sw;
+
+    if ((CANmodule == NULL) || !bInstalled || (CO_CANtimingOf(bitRate_kbps) == NULL))
+    {
+        return false;
+    }
+    sw = &CANmodule->bitRateSwitch;
+
+    /* TX task stops handing messages to the controller */
+    CO_LOCK_CAN_SEND(CANmodule);
+    if (sw->state != CO_CAN_BITRATE_SWITCH_IDLE)
+    {
+        CO_UNLOCK_CAN_SEND(CANmodule);
+        return false;
+    }
+    sw->state = CO_CAN_BITRATE_SWITCH_SILENT;
+    CO_UNLOCK_CAN_SEND(CANmodule);
+    sw->newBitRate = bitRate_kbps;
+    sw->delay_ms = delay_ms;
+    sw->requestedAt_us = esp_timer_get_time();
+
+    if (esp_timer_start_once(s_bitRateTimer, (uint64_t)delay_ms * 1000U) != ESP_OK)
+    {
+        sw->state = CO_CAN_BITRATE_SWITCH_IDLE;
+        return false;
+    }
+    ESP_LOGI(TAG, "Switching to %u kbit/s in %u ms", bitRate_kbps, delay_ms);
+    return true;
+}
+
+/* Reconfigure controller at the new rate, in the mode it is in */
+static bool_t CO_CANbitRateApply(CO_CANmodule_t *CANmodule, uint32_t *offline_us)
+{
+    const twai_timing_config_t *t_config = CO_CANtimingOf(CANmodule->bitRateSwitch.newBitRate);
+    bool_t done;
+    int64_t stop_us;
+
+    xSemaphoreTakeRecursive(CANmodule->xMutexTwaiHdl, portMAX_DELAY);
+    stop_us = esp_timer_get_time();
+    done = CO_CANrestartInMode(CANmodule, CANmodule->listenOnly ? TWAI_MODE_LISTEN_ONLY : TWAI_MODE_NORMAL, t_config,
+                               &CANmodule->rxFilterConfig);
+    if (done)
+    {
+        *offline_us = (uint32_t)(esp_timer_get_time() - stop_us);
+    }
+    xSemaphoreGiveRecursive(CANmodule->xMutexTwaiHdl);
+
+    if (done)
+    {
+        CO_LOCK_CAN_SEND(CANmodule);
+        CANmodule->CANbitRate = CANmodule->bitRateSwitch.newBitRate;
+        CO_UNLOCK_CAN_SEND(CANmodule);
+    }
+    return done;
+}
+
+/* First delay: switch and wait the second one. Second delay: release TX. */
+static void CO_bitRateTimerCallback(void *arg)
+{
+    CO_CANmodule_t *CANmodule = (CO_CANmodule_t *)arg;
+    CO_CANbitRateSwitch_t *sw = &CANmodule->bitRateSwitch;
+    uint32_t offline_us = 0U;
+
+    if (sw->state == CO_CAN_BITRATE_SWITCH_SILENT)
+    {
+        if (CO_CANbitRateApply(CANmodule, &offline_us))
+        {
+            sw->lastOffline_us = offline_us;
+            sw->switchCount++;
+        }
+        else
+        {
+            /* bus-off, recovery restarts the controller at the old rate. TX
+             * was silent for delay_ms, so abort waits here only, if a frame
+             * could not be sent meanwhile (no ACK). */
+            sw->failedCount++;
+            ESP_LOGW(TAG, "Controller is not running or its TX is busy, bit rate not changed");
+        }
+        sw->state = CO_CAN_BITRATE_SWITCH_SETTLE;
+        if (esp_timer_start_once(s_bitRateTimer, (uint64_t)sw->delay_ms * 1000U) == ESP_OK)
+        {
+            return;
+        }
+    }
+    if (sw->state == CO_CAN_BITRATE_SWITCH_SETTLE)
+    {
+        sw->lastSilent_us = (uint32_t)(esp_timer_get_time() - sw->requestedAt_us);
+
+        /* send messages, which were queued meanwhile. txHold of bus-off is kept. */
+        CO_LOCK_CAN_SEND(CANmodule);
+        sw->state = CO_CAN_BITRATE_SWITCH_IDLE;
+        CANmodule->txWakePending = true;
+        CO_UNLOCK_CAN_SEND(CANmodule);
+        xTaskNotifyGive(xCoTxTaskHandle);
+        ESP_LOGI(TAG, "Bit rate %u kbit/s, controller offline %lu us, silent %lu us", CANmodule->CANbitRate,
+                 (unsigned long)sw->lastOffline_us, (unsigned long)sw->lastSilent_us);
+    }
+}
+
+/******************************************************************************/
+/* Backoff delay before next recovery attempt */
+static uint32_t CO_CANbusOffDelay_ms(const CO_CANbusOff_t *busOff)
+{
+    uint8_t shift = (busOff->consecutive > 0U) ? (uint8_t)(busOff->consecutive - 1U) : 0U;
+    uint32_t delay;
+
+    if (shift > 16U)
+    {
+        shift = 16U;
+    }
+    delay = (uint32_t)busOff->initialDelay_ms << shift;
+
+    switch (busOff->backoff)
+    {
+    case CO_CAN_BUSOFF_BACKOFF_IMMEDIATE:
+        return 0U;
+    case CO_CAN_BUSOFF_BACKOFF_EXPONENTIAL:
+        return delay;
+    default:
+        return (delay > busOff->maxDelay_ms) ? busOff->maxDelay_ms : delay;
+    }
+}
+
+/* Clear txHold and wake TX task to send messages, which were held back */
+static void CO_CANtxRelease(CO_CANmodule_t *CANmodule)
+{
+    bool_t notify = false;
+
+    CO_LOCK_CAN_SEND(CANmodule);
+    CANmodule->txHold = false;
+    if (!CANmodule->txWakePending)
+    {
+        CANmodule->txWakePending = true;
+        notify = true;
+    }
+    CO_UNLOCK_CAN_SEND(CANmodule);
+    if (notify)
+    {
+        xTaskNotifyGive(xCoTxTaskHandle);
+    }
+}
+
+/* Bus-off recovery state machine. While controller is not running, TX task
+ * keeps messages queued (txHold). After the backoff delay recovery is
+ * initiated, and when controller enters stopped state, it is started again.
+ * Driver, queues, tasks and CANopen objects are kept. */
+static void CO_CANbusOffProcess(CO_CANmodule_t *CANmodule, const twai_status_info_t *statusInfo)
+{
+    CO_CANbusOff_t *busOff = &CANmodule->busOff;
+    int64_t now = esp_timer_get_time();
+
+    switch (busOff->state)
+    {
+    case CO_CAN_BUSOFF_IDLE:
+        if (statusInfo->state == TWAI_STATE_BUS_OFF)
+        {
+            uint32_t delay;
+
+            if ((now - busOff->runningSince_us) > ((int64_t)DRV_BUSOFF_STABLE_MS * 1000))
+            {
+                busOff->consecutive = 0U;
+            }
+            if (busOff->consecutive < UINT8_MAX)
+            {
+                busOff->consecutive++;
+            }
+            CANmodule->txHold = true;
+            CO_CANcapture_trigger(&CANmodule->capture, CO_CAN_CAPTURE_TRIG_BUSOFF);
+            busOff->busOffAt_us = now;
+            delay = CO_CANbusOffDelay_ms(busOff);
+            busOff->restartAt_us = now + ((int64_t)delay * 1000);
+            busOff->state = CO_CAN_BUSOFF_WAIT;
+            ESP_LOGW(TAG, "Bus-off, recovery in %lu ms (consecutive %u)", (unsigned long)delay, busOff->consecutive);
+        }
+        else if (CANmodule->txHold && !CANmodule->busOffRecovered && (statusInfo->state == TWAI_STATE_RUNNING))
+        {
+            /* TX task saw the controller stopped, but it runs again */
+            CO_CANtxRelease(CANmodule);
+        }
+        break;
+
+    case CO_CAN_BUSOFF_WAIT:
+        if (now >= busOff->restartAt_us)
+        {
+            xSemaphoreTakeRecursive(CANmodule->xMutexTwaiHdl, portMAX_DELAY);
+            if (twai_initiate_recovery() == ESP_OK)
+            {
+                busOff->state = CO_CAN_BUSOFF_RECOVERING;
+            }
+            xSemaphoreGiveRecursive(CANmodule->xMutexTwaiHdl);
+        }
+        break;
+
+    case CO_CAN_BUSOFF_RECOVERING:
+        if (statusInfo->state == TWAI_STATE_STOPPED)
+        {
+            esp_err_t espRet;
+            uint32_t downtime;
+
+            xSemaphoreTakeRecursive(CANmodule->xMutexTwaiHdl, portMAX_DELAY);
+            espRet = twai_start();
+            xSemaphoreGiveRecursive(CANmodule->xMutexTwaiHdl);
+            if (espRet != ESP_OK)
+            {
+                break;
+            }
+
+            downtime = (uint32_t)((now - busOff->busOffAt_us) / 1000);
+            busOff->recoveryCount++;
+            busOff->lastDowntime_ms = downtime;
+            busOff->totalDowntime_ms += downtime;
+            if (downtime > busOff->maxDowntime_ms)
+            {
+                busOff->maxDowntime_ms = downtime;
+            }
+            busOff->runningSince_us = now;
+            busOff->state = CO_CAN_BUSOFF_IDLE;
+            ESP_LOGW(TAG, "Bus-off recovered after %lu ms (recovery %lu)", (unsigned long)downtime,
+                     (unsigned long)busOff->recoveryCount);
+
+            /* TX stays on hold until CO_CANmodule_process() lets application
+             * queue the bootup message */
+            CANmodule->busOffRecovered = true;
+        }
+        break;
+
+    default:
+        busOff->state = CO_CAN_BUSOFF_IDLE;
+        break;
+    }
+}
+
+/******************************************************************************/
+/* Sample error counters and, once per second, calculate rates, bus load and
+ * error counter history from the free running counters. */
+static void CO_CANtrafficProcess(CO_CANmodule_t *CANmodule, const twai_status_info_t *statusInfo)
+{
+    CO_CANtrafficStats_t *traffic = &CANmodule->traffic;
+    int64_t now = esp_timer_get_time();
+    uint8_t tec = (statusInfo->tx_error_counter > UINT8_MAX) ? UINT8_MAX : (uint8_t)statusInfo->tx_error_counter;
+    uint8_t rec = (statusInfo->rx_error_counter > UINT8_MAX) ? UINT8_MAX : (uint8_t)statusInfo->rx_error_counter;
+    uint16_t i;
+
+    traffic->rxOverrun = statusInfo->rx_overrun_count;
+    traffic->rxMissed = statusInfo->rx_missed_count;
+    if (tec > s_trafficWindow.tecMax)
+    {
+        s_trafficWindow.tecMax = tec;
+    }
+    if (rec > s_trafficWindow.recMax)
+    {
+        s_trafficWindow.recMax = rec;
+    }
+
+    if ((now - s_trafficWindow.start_us) >= 1000000)
+    {
+        uint32_t bits = traffic->rxBits + traffic->txBits;
+        uint32_t bitsPerSec = (uint32_t)CANmodule->CANbitRate * 1000U;
+        uint32_t load;
+
+        for (i = 0U; i < CO_CAN_CLASS_COUNT; i++)
+        {
+            uint32_t rx = traffic->rxFrames[i];
+            uint32_t tx = traffic->txFrames[i];
+
+            traffic->rxPerSec[i] = (uint16_t)(rx - s_trafficWindow.rxFrames[i]);
+            traffic->txPerSec[i] = (uint16_t)(tx - s_trafficWindow.txFrames[i]);
+            s_trafficWindow.rxFrames[i] = rx;
+            s_trafficWindow.txFrames[i] = tx;
+        }
+        load = (bitsPerSec != 0U) ? (uint32_t)(((uint64_t)(bits - s_trafficWindow.bits) * 1000U) / bitsPerSec) : 0U;
+        traffic->busLoad_permille = (uint16_t)((load > 1000U) ? 1000U : load);
+        s_trafficWindow.bits = bits;
+
+        traffic->tecHistory[traffic->historyIndex] = s_trafficWindow.tecMax;
+        traffic->recHistory[traffic->historyIndex] = s_trafficWindow.recMax;
+        traffic->historyIndex = (uint8_t)((traffic->historyIndex + 1U) % CO_CAN_ERRHIST_LEN);
+        s_trafficWindow.tecMax = tec;
+        s_trafficWindow.recMax = rec;
+
+        traffic->seconds++;
+        s_trafficWindow.start_us += 1000000;
+        if ((now - s_trafficWindow.start_us) >= 1000000)
+        {
+            /* alert task was blocked, don't try to catch up */
+            s_trafficWindow.start_us = now;
+        }
+    }
+}
+
+/******************************************************************************/
+void CO_CANmodule_process(CO_CANmodule_t *CANmodule)
+{
+    /* COB-ID of some receive buffer was changed (PDO, SDO, HB consumer,...).
+     * Listen-only mode keeps the filter open, it is rebuilt on return. While
+     * the filter in the controller passes all configured identifiers, it is
+     * kept and tightened at the next communication reset. Otherwise the
+     * controller is restarted once, after the changes settled (PDO COB-ID
+     * and mapping are written in several steps). */
+    if (CANmodule->CANnormal && CANmodule->rxFilterDirty && !CANmodule->listenOnly)
+    {
+        if (CO_CANfilter_covers(&s_rxFilter, CANmodule->rxArray, CANmodule->rxSize))
+        {
+            CANmodule->rxFilterDirty = false;
+        }
+        else if ((esp_timer_get_time() - CANmodule->rxFilterChanged_us) >= (DRV_RX_FILTER_SETTLE_MS * 1000))
+        {
+            CO_CANapplyRxFilter(CANmodule);
+        }
+    }
+
+    /* Controller was restarted after bus-off. Let application queue the bootup
+     * message first, then release the TX task. Queued messages (EMCY, ...) go
+     * out in CAN-ID order. */
+    if (CANmodule->busOffRecovered)
+    {
+        CANmodule->busOffRecovered = false;
+        CANmodule->firstCANtxMessage = true;
+        if (CANmodule->pFunctSignalBusOff != NULL)
+        {
+            CANmodule->pFunctSignalBusOff(CANmodule->functSignalObjectBusOff);
+        }
+        CO_CANtxRelease(CANmodule);
+    }
+
+    /* CANerrorStatus is maintained by CO_alertTask() */
+}
+
+/******************************************************************************/
+/* Recalculate CANerrorStatus from error counters. Returns true, if it changed. */
+static bool_t CO_CANerrorStatusUpdate(CO_CANmodule_t *CANmodule, const twai_status_info_t *statusInfo,
+                                      uint32_t alerts)
+{
+    uint16_t txErrors = (uint16_t)statusInfo->tx_error_counter;
+    uint16_t rxErrors = (uint16_t)statusInfo->rx_error_counter;
+    uint16_t status, statusOld;
+
+    /* CO_CANsend() and CO_CANclearPendingSyncPDOs() modify other flags */
+    CO_LOCK_CAN_SEND(CANmodule);
+    statusOld = CANmodule->CANerrorStatus;
+    status = statusOld;
+
+    if (CANmodule->busOff.state != CO_CAN_BUSOFF_IDLE)
+    {
+        /* bus off */
+        status |= CO_CAN_ERRTX_BUS_OFF;
+    }
+    else
+    {
+        /* recalculate CANerrorStatus, first clear some flags */
+        status &= 0xFFFF ^ (CO_CAN_ERRTX_BUS_OFF |
+                            CO_CAN_ERRRX_WARNING | CO_CAN_ERRRX_PASSIVE |
+                            CO_CAN_ERRTX_WARNING | CO_CAN_ERRTX_PASSIVE);
+
+        /* rx bus warning or passive */
+        if (rxErrors >= 128)
+        {
+            status |= CO_CAN_ERRRX_WARNING | CO_CAN_ERRRX_PASSIVE;
+        }
+        else if (rxErrors >= 96)
+        {
+            status |= CO_CAN_ERRRX_WARNING;
+        }
+
+        /* tx bus warning or passive */
+        if (txErrors >= 128)
+        {
+            status |= CO_CAN_ERRTX_WARNING | CO_CAN_ERRTX_PASSIVE;
+        }
+        else if (txErrors >= 96)
+        {
+            status |= CO_CAN_ERRTX_WARNING;
+        }
+
+        /* if not tx passive clear also overflow */
+        if ((status & CO_CAN_ERRTX_PASSIVE) == 0)
+        {
+            status &= 0xFFFF ^ CO_CAN_ERRTX_OVERFLOW;
+        }
+    }
+
+    if ((statusInfo->rx_overrun_count != 0U) || (statusInfo->rx_missed_count != 0U) ||
+        ((alerts & (TWAI_ALERT_RX_QUEUE_FULL | TWAI_ALERT_RX_FIFO_OVERRUN)) != 0U))
+    {
+        /* CAN RX bus overflow */
+        status |= CO_CAN_ERRRX_OVERFLOW;
+    }
+
+    CANmodule->CANerrorStatus = status;
+    CO_UNLOCK_CAN_SEND(CANmodule);
+
+    return status != statusOld;
+}
+
+/* Account frames, which the TWAI driver completed since the last call. The
+ * driver reports completions only as a count (msgs_to_tx) and coalesced
+ * alerts, so frames are taken from s_txInflight in order. A synchronous TPDO
+ * is always alone in the controller, so its TX_SUCCESS or TX_FAILED alert
+ * belongs to it. */
+static void CO_CANtxDelayAdd(CO_CANtxDelay_t *txDelay, uint32_t delay)
+{
+    txDelay->frames++;
+    txDelay->lastDelay_us = delay;
+    txDelay->sumDelay_us += delay;
+    if (delay > txDelay->maxDelay_us)
+    {
+        txDelay->maxDelay_us = delay;
+    }
+}
+
+static void CO_CANtxCompleteProcess(CO_CANmodule_t *CANmodule, uint32_t alerts)
+{
+    twai_status_info_t statusInfo;
+    uint32_t now = (uint32_t)esp_timer_get_time();
+    bool_t busOff;
+    uint8_t done;
+
+    xSemaphoreTakeRecursive(CANmodule->xMutexTwaiHdl, portMAX_DELAY);
+    if (twai_get_status_info(&statusInfo) != ESP_OK)
+    {
+        xSemaphoreGiveRecursive(CANmodule->xMutexTwaiHdl);
+        return;
+    }
+    /* TWAI driver discards its TX queue on bus-off */
+    busOff = statusInfo.state != TWAI_STATE_RUNNING;
+    if (busOff)
+    {
+        done = s_txInflight.count;
+    }
+    else
+    {
+        done = (s_txInflight.count > statusInfo.msgs_to_tx) ? (uint8_t)(s_txInflight.count - statusInfo.msgs_to_tx)
+                                                            : 0U;
+    }
+
+    for (; done > 0U; done--)
+    {
+        bool_t syncFlag = s_txInflight.frame[s_txInflight.head].syncFlag;
+
+        if (!busOff)
+        {
+            /* Queue to end of transmission. With coalesced alerts, earlier
+             * frames get the time of the latest completion. */
+            uint16_t ident = s_txInflight.frame[s_txInflight.head].ident;
+            uint32_t delay = now - s_txInflight.frame[s_txInflight.head].queuedAt_us;
+
+            CO_CANtxDelayAdd(&CANmodule->txDelay[CO_CAN_CLASS_OF(ident)], delay);
+            if (s_txInflight.frame[s_txInflight.head].loadGen)
+            {
+                CO_CANtxDelayAdd(&CANmodule->txDelayLoadGen, delay);
+            }
+        }
+        if (syncFlag)
+        {
+            CO_CANsyncTxStats_t *syncTx = &CANmodule->syncTx;
+
+            if (busOff || ((alerts & TWAI_ALERT_TX_FAILED) != 0U))
+            {
+                syncTx->aborted++;
+                CO_LOCK_CAN_SEND(CANmodule);
+                CANmodule->CANerrorStatus |= CO_CAN_ERRTX_PDO_LATE;
+                CO_UNLOCK_CAN_SEND(CANmodule);
+            }
+            else
+            {
+                uint32_t latency = now - CANmodule->syncRx_us;
+
+                syncTx->frames++;
+                syncTx->lastLatency_us = latency;
+                syncTx->sumLatency_us += latency;
+                if (latency > syncTx->maxLatency_us)
+                {
+                    syncTx->maxLatency_us = latency;
+                }
+            }
+            s_txInflight.syncCount--;
+        }
+        else if (busOff)
+        {
+            CANmodule->traffic.txFailed++;
+        }
+        s_txInflight.head = (uint8_t)((s_txInflight.head + 1U) % DRV_TX_INFLIGHT_MAX);
+        s_txInflight.count--;
+    }
+
+    if (s_txInflight.syncCount == 0U)
+    {
+        CO_LOCK_CAN_SEND(CANmodule);
+        CANmodule->bufferInhibitFlag = false;
+        CO_UNLOCK_CAN_SEND(CANmodule);
+    }
+    xSemaphoreGiveRecursive(CANmodule->xMutexTwaiHdl);
+
+    /* There is room in the controller now */
+    xTaskNotifyGive(xCoTxTaskHandle);
+}
+
+/* Ticks until the next deadline of the alert task: end of traffic statistics
+ * window or end of bus-off backoff delay */
+static TickType_t CO_alertTimeout(const CO_CANmodule_t *CANmodule)
+{
+    int64_t now = esp_timer_get_time();
+    int64_t deadline = s_trafficWindow.start_us + 1000000;
+    int64_t wait_us;
+
+    if ((CANmodule->busOff.state == CO_CAN_BUSOFF_WAIT) && (CANmodule->busOff.restartAt_us < deadline))
+    {
+        deadline = CANmodule->busOff.restartAt_us;
+    }
+    wait_us = deadline - now;
+    if (wait_us <= 0)
+    {
+        return 0;
+    }
+    /* round up, so deadline is reached when task wakes */
+    return pdMS_TO_TICKS((uint32_t)((wait_us + 999) / 1000)) + 1U;
+}
+
+/* Alert task blocks on TWAI driver alerts. Error counter changes, bus-off and
+ * RX overflow are handled as soon as the driver reports them; timeouts drive
+ * bus-off backoff and traffic statistics. CANopen main task is signalled only
+ * when CANerrorStatus changes. */
+static void CO_alertTask(void *pxParam)
+{
+    CO_CANmodule_t *CANmodule = (CO_CANmodule_t *)pxParam;
+    twai_status_info_t statusInfo;
+    uint32_t alerts;
+
+    while (1)
+    {
+        /* ESP_ERR_TIMEOUT: a deadline is reached, process anyway */
+        alerts = 0U;
+        (void)twai_read_alerts(&alerts, CO_alertTimeout(CANmodule));
+
+        if (twai_get_status_info(&statusInfo) != ESP_OK)
+        {
+            continue;
+        }
+
+        if ((alerts & TWAI_ALERT_ERR_PASS) != 0U)
+        {
+            ESP_LOGW(TAG, "Error passive (TEC %lu, REC %lu)", (unsigned long)statusInfo.tx_error_counter,
+                     (unsigned long)statusInfo.rx_error_counter);
+        }
+        if ((alerts & (TWAI_ALERT_RX_QUEUE_FULL | TWAI_ALERT_RX_FIFO_OVERRUN)) != 0U)
+        {
+            ESP_LOGW(TAG, "RX overflow (missed %lu, overrun %lu)", (unsigned long)statusInfo.rx_missed_count,
+                     (unsigned long)statusInfo.rx_overrun_count);
+        }
+
+        if ((alerts & (TWAI_ALERT_TX_SUCCESS | TWAI_ALERT_TX_FAILED | TWAI_ALERT_TX_IDLE | TWAI_ALERT_BUS_OFF)) != 0U)
+        {
+            CO_CANtxCompleteProcess(CANmodule, alerts);
+        }
+        CO_CANbusOffProcess(CANmodule, &statusInfo);
+        CO_CANtrafficProcess(CANmodule, &statusInfo);
+
+        if (CO_CANerrorStatusUpdate(CANmodule, &statusInfo, alerts) && (CANmodule->pFunctSignalStatus != NULL))
+        {
+            CANmodule->pFunctSignalStatus(CANmodule->functSignalObjectStatus);
+        }
+    }
+}
 
 /******************************************************************************/
+/* Record frame in the capture ring, if it is armed. Cost of the record is
+ * measured, it is reported in OD together with the capture. */
+static void CO_CANcaptureFrame(CO_CANmodule_t *CANmodule, const twai_message_t *msg,
+                               uint32_t timestamp_us, bool_t tx)
+{
+    CO_CANcapture_t *capture = &CANmodule->capture;
+
+    if (CO_CANcapture_active(capture))
+    {
+        uint32_t start = esp_cpu_get_cycle_count();
+        uint16_t ident = (uint16_t)(msg->identifier & 0x07FFU);
+        uint32_t cycles;
+
+        if (msg->rtr)
+        {
+            ident |= CO_CAN_CAPTURE_RTR;
+        }
+        if (tx)
+        {
+            ident |= CO_CAN_CAPTURE_TX;
+        }
+        CO_CANcapture_record(capture, ident, msg->data_length_code, msg->data, timestamp_us);
+        cycles = esp_cpu_get_cycle_count() - start;
+        if (cycles > capture->recordCyclesMax)
+        {
+            capture->recordCyclesMax = cycles;
+        }
+    }
+}
+
+static void CO_txShaperTimerCallback(void *arg)
+{
+    (void)arg;
+    if (xCoTxTaskHandle != NULL)
+    {
+        xTaskNotifyGive(xCoTxTaskHandle);
+    }
+}
+
+/* Refill the token bucket and take tokens for one bulk frame. If there are not
+ * enough tokens, wait_us is set to the time until there will be. Called with
+ * CO_LOCK_CAN_SEND held. */
+static bool_t CO_CANtxShaperTake(CO_CANmodule_t *CANmodule, uint8_t DLC, uint32_t *wait_us)
+{
+    CO_CANtxShaper_t *shaper = &CANmodule->txShaper;
+    int64_t now = esp_timer_get_time();
+    uint32_t rate = (uint32_t)CANmodule->CANbitRate * shaper->share_permille; /* 1/1000 bit per ms */
+    uint32_t cost = CO_CAN_FRAME_BITS(DLC) * 1000U;
+    uint64_t tokens;
+
+    tokens = shaper->tokens_mbit + ((uint64_t)(now - shaper->lastRefill_us) * rate) / 1000U;
+    shaper->lastRefill_us = now;
+    if (tokens > DRV_TX_SHAPER_DEPTH_MBIT(shaper))
+    {
+        tokens = DRV_TX_SHAPER_DEPTH_MBIT(shaper);
+    }
+
+    if (tokens >= cost)
+    {
+        shaper->tokens_mbit = (uint32_t)(tokens - cost);
+        shaper->shapedFrames++;
+        return true;
+    }
+    shaper->tokens_mbit = (uint32_t)tokens;
+    *wait_us = (uint32_t)((((uint64_t)cost - tokens) * 1000U + rate - 1U) / rate);
+    return false;
+}
+
+/* Drop buffer, if its data is older than its lifetime. Called with
+ * CO_LOCK_CAN_SEND held. */
+static bool_t CO_CANtxDropExpired(CO_CANmodule_t *CANmodule, uint16_t index, uint32_t now_us)
+{
+    CO_CANtx_t *buffer = &CANmodule->txArray[index];
+
+    if ((buffer->lifetime_us == 0U) || ((now_us - buffer->queuedAt_us) <= buffer->lifetime_us))
+    {
+        return false;
+    }
+    buffer->bufferFull = false;
+    CO_CANtxQueue_remove(&s_txQueue, index);
+    CANmodule->CANtxCount--;
+    CANmodule->txStale.expired[CO_CAN_CLASS_OF(buffer->ident)]++;
+    return true;
+}
+
 static void CO_txTask(void *pxParam)
 {
-    uint32_t notificationValue;
     twai_message_t tx_msg;
     CO_CANtx_t *pCanTx;
     esp_err_t espRet;
@@ -535,95 +1965,347 @@ static void CO_txTask(void *pxParam)
 
     while (1)
     {
-        xTaskNotifyWait(ULONG_MAX, ULONG_MAX, &notificationValue, portMAX_DELAY);
+        /* Any number of CO_CANsend() calls results in a single wakeup */
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
 
-        CO_LOCK_CAN_SEND(CANmodule);
-        /* First CAN message (bootup) was sent successfully */
-        CANmodule->firstCANtxMessage = false;
-        /* clear flag from previous message */
-        CANmodule->bufferInhibitFlag = false;
-        /* Are there any new messages waiting to be send */
-        while (CANmodule->CANtxCount > 0U)
+        /* Are there any new messages waiting to be send. Send them in
+         * CAN-ID order, as they would win the bus arbitration. */
+        while (1)
         {
-            /* search through whole array of pointers to transmit message buffers. */
-            for (int i = 0; i < CANmodule->txSize; i++)
+            uint16_t i;
+            uint32_t queuedAt_us;
+            uint32_t shaperWait_us = 0U;
+            uint32_t now_us;
+            bool_t syncFlag;
+
+            /* Take the message out of txArray under the lock... */
+            CO_LOCK_CAN_SEND(CANmodule);
+            if (CANmodule->txHold || CANmodule->listenOnly ||
+                (CANmodule->bitRateSwitch.state != CO_CAN_BITRATE_SWITCH_IDLE))
+            {
+                /* bus-off: messages stay queued until CO_CANmodule_process()
+                 * restarts the controller. Listen-only: until normal mode.
+                 * Bit rate switch: until the second switch delay ends. */
+                CANmodule->txWakePending = false;
+                CO_UNLOCK_CAN_SEND(CANmodule);
+                break;
+            }
+            /* Controller is full, or synchronous TPDO in it must stay alone.
+             * Alert task wakes this task on TX completion. */
+            if ((s_txInflight.count >= DRV_TX_INFLIGHT_MAX) || (s_txInflight.syncCount != 0U))
+            {
+                CANmodule->txWakePending = false;
+                CO_UNLOCK_CAN_SEND(CANmodule);
+                break;
+            }
+            /* First CAN message (bootup) was sent successfully */
+            CANmodule->firstCANtxMessage = false;
+            i = CO_CANtxQueue_peek(&s_txQueue);
+            if (i == CO_CAN_TXQUEUE_NONE)
+            {
+                CANmodule->CANtxCount = 0U;
+                CANmodule->txWakePending = false;
+                CO_UNLOCK_CAN_SEND(CANmodule);
+                break;
+            }
+            now_us = (uint32_t)esp_timer_get_time();
+            if (CO_CANtxDropExpired(CANmodule, i, now_us))
+            {
+                CO_UNLOCK_CAN_SEND(CANmodule);
+                continue;
+            }
+            if (!CANmodule->txArray[i].syncFlag && CO_CANtxQueue_isShaped(&s_txQueue, i) &&
+                !CO_CANtxShaperTake(CANmodule, CANmodule->txArray[i].DLC, &shaperWait_us))
+            {
+                /* Bulk frame waits for tokens, other classes go first */
+                i = CO_CANtxQueue_peekUnshaped(&s_txQueue);
+                if (i == CO_CAN_TXQUEUE_NONE)
+                {
+                    CANmodule->txShaper.deferred++;
+                    CANmodule->txWakePending = false;
+                    CO_UNLOCK_CAN_SEND(CANmodule);
+                    (void)esp_timer_stop(s_txShaperTimer);
+                    (void)esp_timer_start_once(s_txShaperTimer, shaperWait_us);
+                    break;
+                }
+                if (CO_CANtxDropExpired(CANmodule, i, now_us))
+                {
+                    CO_UNLOCK_CAN_SEND(CANmodule);
+                    continue;
+                }
+            }
+            /* Synchronous TPDO waits for an idle controller, so it can be
+             * aborted alone in CO_CANclearPendingSyncPDOs() */
+            if (CANmodule->txArray[i].syncFlag && (s_txInflight.count != 0U))
+            {
+                CANmodule->txWakePending = false;
+                CO_UNLOCK_CAN_SEND(CANmodule);
+                break;
+            }
+            pCanTx = &(CANmodule->txArray[i]);
+
+            memset(&tx_msg, 0, sizeof(tx_msg));
+            tx_msg.identifier = pCanTx->ident & 0x07FFU;
+            tx_msg.rtr = (pCanTx->ident & 0x0800U) != 0U;
+            tx_msg.data_length_code = pCanTx->DLC;
+            memcpy(tx_msg.data, pCanTx->data, TWAI_FRAME_MAX_DLC);
+            queuedAt_us = pCanTx->queuedAt_us;
+            syncFlag = pCanTx->syncFlag;
+
+            /* buffer is free for the next message as soon as it is copied */
+            pCanTx->bufferFull = false;
+            CO_CANtxQueue_remove(&s_txQueue, i);
+            CANmodule->CANtxCount--;
+            CO_UNLOCK_CAN_SEND(CANmodule);
+
+            /* ...and hand it to the TWAI driver without the lock. Controller
+             * has room for it, so this does not block. */
+            xSemaphoreTakeRecursive(CANmodule->xMutexTwaiHdl, portMAX_DELAY);
+            espRet = twai_transmit(&tx_msg, pdMS_TO_TICKS(DRV_TX_TIMEOUT_MS));
+            if (ESP_OK == espRet)
+            {
+                uint8_t tail = (uint8_t)((s_txInflight.head + s_txInflight.count) % DRV_TX_INFLIGHT_MAX);
+
+                s_txInflight.frame[tail].queuedAt_us = queuedAt_us;
+                s_txInflight.frame[tail].ident = (uint16_t)tx_msg.identifier;
+                s_txInflight.frame[tail].syncFlag = syncFlag;
+                s_txInflight.frame[tail].loadGen = i >= (CANmodule->txSize - CO_CONFIG_LOADGEN_TX_CNT);
+                s_txInflight.count++;
+                if (CANmodule->firstTx_us == 0U)
+                {
+                    CANmodule->firstTx_us = (uint32_t)esp_timer_get_time() | 1U;
+                }
+                if (syncFlag)
+                {
+                    s_txInflight.syncCount++;
+                    CO_LOCK_CAN_SEND(CANmodule);
+                    CANmodule->bufferInhibitFlag = true;
+                    CO_UNLOCK_CAN_SEND(CANmodule);
+                }
+            }
+            xSemaphoreGiveRecursive(CANmodule->xMutexTwaiHdl);
+
+            if (ESP_OK == espRet)
+            {
+                CO_CANclass_t cls = CO_CAN_CLASS_OF(tx_msg.identifier);
+
+                CANmodule->traffic.txFrames[cls]++;
+                CANmodule->traffic.txBits += CO_CAN_FRAME_BITS(tx_msg.data_length_code);
+                CO_CANcaptureFrame(CANmodule, &tx_msg, (uint32_t)esp_timer_get_time(), true);
+            }
+            else if (espRet == ESP_ERR_INVALID_STATE)
             {
-                pCanTx = &(CANmodule->txArray[i]);
-                if (pCanTx->bufferFull)
+                /* controller went bus-off, put message back, if buffer was
+                 * not refilled meanwhile, and hold the queue */
+                CO_LOCK_CAN_SEND(CANmodule);
+                if (!pCanTx->bufferFull)
                 {
-                    memset(&tx_msg, 0, sizeof(tx_msg));
-                    tx_msg.identifier = pCanTx->ident;
-                    tx_msg.data_length_code = pCanTx->DLC;
-                    memcpy(tx_msg.data, pCanTx->data, TWAI_FRAME_MAX_DLC);
-
-                    espRet = twai_transmit(&tx_msg, pdMS_TO_TICKS(1000));
-                    if (ESP_OK == espRet)
-                    {
-                        pCanTx->bufferFull = false;
-                    }
-                    else
-                    {
-                        ESP_LOGE(TAG, "Failed Tx. id:%d err:0x%x", i, espRet);
-                    }
-                    CANmodule->CANtxCount--;
-                    CANmodule->bufferInhibitFlag = pCanTx->syncFlag;
-                    break; /* exit for loop */
+                    CO_CANtxQueue_push(&s_txQueue, i, pCanTx->syncFlag);
+                    pCanTx->bufferFull = true;
+                    CANmodule->CANtxCount++;
                 }
+                CANmodule->txHold = true;
+                CO_UNLOCK_CAN_SEND(CANmodule);
+                CANmodule->traffic.txFailed++;
+            }
+            else
+            {
+                /* message is dropped */
+                CANmodule->traffic.txFailed++;
+                ESP_LOGE(TAG, "Failed Tx. id:%d err:0x%x", i, espRet);
             }
         }
-        CO_UNLOCK_CAN_SEND(CANmodule);
     }
 }
 
+/* Dispatch one received message to the matching rxArray buffer */
+static void CO_CANrxDispatch(CO_CANmodule_t *CANmodule, CO_CANrxMsg_t *rcvMsg, CO_CANrxLane_t lane)
+{
+    uint16_t rcvMsgIdent;      /* identifier of the received message */
+    CO_CANrx_t *buffer = NULL; /* receive message buffer from CO_CANmodule_t object. */
+
+#if CONFIG_CO_DEBUG_DRIVER_CAN_RECEIVE
+    ESP_LOGI(TAG, "CANRX id: 0x%lx, dlc: %d, data: [%d %d %d %d %d %d %d %d]",
+             rcvMsg->msg.identifier,
+             rcvMsg->msg.data_length_code,
+             rcvMsg->msg.data[0],
+             rcvMsg->msg.data[1],
+             rcvMsg->msg.data[2],
+             rcvMsg->msg.data[3],
+             rcvMsg->msg.data[4],
+             rcvMsg->msg.data[5],
+             rcvMsg->msg.data[6],
+             rcvMsg->msg.data[7]);
+#endif /* CONFIG_CO_DEBUG_DRIVER_CAN_RECEIVE */
+
+    /* identifier aligned as in rxArray: 11-bit CAN-ID, RTR in bit 11 */
+    rcvMsgIdent = (uint16_t)(rcvMsg->msg.identifier & 0x07FFU);
+    if (rcvMsg->msg.rtr)
+    {
+        rcvMsgIdent |= 0x0800U;
+    }
+    /* Find buffer with the same CAN-ID in the dispatch index */
+    buffer = CO_CANrxIndex_find(&s_rxIndex, CANmodule->rxArray, CANmodule->rxSize, rcvMsgIdent);
+
+    /* Call specific function, which will process the message */
+    if ((buffer != NULL) && (buffer->CANrx_callback != NULL))
+    {
+        CO_CANrxLatency_t *rxLatency = &CANmodule->rxLatency[lane];
+        uint32_t latency;
+
+        buffer->CANrx_callback(buffer->object, (void *)rcvMsg);
+
+        /* CANrxNew (or equivalent) is set by now */
+        latency = (uint32_t)(esp_timer_get_time() - rcvMsg->timestamp_us);
+        rxLatency->frames++;
+        rxLatency->lastLatency_us = latency;
+        rxLatency->sumLatency_us += latency;
+        if (latency > rxLatency->maxLatency_us)
+        {
+            rxLatency->maxLatency_us = latency;
+        }
+    }
+    else
+    {
+        /* Frame passed the hardware filter, but nobody is interested */
+        CANmodule->rxFilterLeakCount++;
+    }
+}
+
+static CO_CANrxLane_t CO_CANrxLaneOf(const CO_CANmodule_t *CANmodule, const CO_CANrxMsg_t *rcvMsg)
+{
+    uint32_t ident = rcvMsg->msg.identifier & 0x7FFU;
+    uint32_t cls = CO_CAN_CLASS_OF(ident);
+
+    if (cls == CO_CAN_CLASS_NMT_SYNC_EMCY)
+    {
+        return CO_CAN_RX_LANE_HIGH;
+    }
+    if ((((1U << cls) & CANmodule->rxFastClasses) != 0U) ||
+        ((CANmodule->rxFastIdents[ident / 32U] & (1UL << (ident % 32U))) != 0U))
+    {
+        return CO_CAN_RX_LANE_FAST;
+    }
+    return CO_CAN_RX_LANE_NORMAL;
+}
+
+/* Move frames from the TWAI driver queue into the receive lanes. Frames are
+ * counted and captured here, also if their lane is full and they are dropped.
+ * Returns number of frames taken from the driver queue. */
+static uint16_t CO_CANrxPoll(CO_CANmodule_t *CANmodule, TickType_t firstWait)
+{
+    CO_CANrxMsg_t rcvMsg;
+    void (*pFunctListen)(void *object, const CO_CANrxMsg_t *rcvMsg);
+    uint16_t n = 0U;
+
+    while ((n < DRV_RX_BATCH_MAX) && (twai_receive(&rcvMsg.msg, (n == 0U) ? firstWait : 0) == ESP_OK))
+    {
+        CO_CANrxLane_t lane = CO_CANrxLaneOf(CANmodule, &rcvMsg);
+        CO_CANrxLaneStats_t *laneStats = &CANmodule->rxLaneStats[lane];
+
+        rcvMsg.timestamp_us = esp_timer_get_time();
+        if ((lane == CO_CAN_RX_LANE_HIGH) && ((rcvMsg.msg.identifier & 0x07FFU) == CANmodule->syncIdent))
+        {
+            /* reference for SYNC to TPDO latency */
+            CANmodule->syncRx_us = (uint32_t)rcvMsg.timestamp_us;
+        }
+        else if ((lane == CO_CAN_RX_LANE_HIGH) && ((rcvMsg.msg.identifier & 0x07FFU) == 0x000U))
+        {
+            /* reference for NMT reset to bootup time */
+            CANmodule->nmtRx_us = (uint32_t)rcvMsg.timestamp_us;
+        }
+        CANmodule->traffic.rxFrames[CO_CAN_CLASS_OF(rcvMsg.msg.identifier)]++;
+        CANmodule->traffic.rxBits += CO_CAN_FRAME_BITS(rcvMsg.msg.data_length_code);
+        CO_CANcaptureFrame(CANmodule, &rcvMsg.msg, (uint32_t)rcvMsg.timestamp_us, false);
+
+        pFunctListen = CANmodule->pFunctListen;
+        if (pFunctListen != NULL)
+        {
+            /* listen-only: frame goes to the analyzer, not to CANopen objects */
+            pFunctListen(CANmodule->functSignalObjectListen, &rcvMsg);
+            n++;
+            continue;
+        }
+
+        if (CO_CANrxLanes_push(&s_rxLanes, lane, &rcvMsg))
+        {
+            uint16_t count = CO_CANrxLanes_count(&s_rxLanes, lane);
+
+            if (count > laneStats->highWater)
+            {
+                laneStats->highWater = count;
+            }
+        }
+        else
+        {
+            laneStats->dropped++;
+        }
+        n++;
+    }
+    return n;
+}
+
 static void CO_rxTask(void *pxParam)
 {
-    twai_message_t rx_msg;
+    static const uint16_t laneSize[CO_CAN_RX_LANE_COUNT] = {DRV_RX_LANE_HIGH_LEN, DRV_RX_LANE_FAST_LEN,
+                                                            DRV_RX_LANE_NORMAL_LEN};
+    CO_CANrxMsg_t rcvMsg;
+    CO_CANrxLane_t lane;
+    twai_status_info_t statusInfo;
     CO_CANmodule_t *CANmodule = (CO_CANmodule_t *)pxParam;
     ESP_LOGI(TAG, "rx task running");
 
+    if (!CO_CANrxLanes_init(&s_rxLanes, laneSize))
+    {
+        ESP_LOGE(TAG, "RX lanes exceed CO_CAN_RXLANES_SLOTS");
+        vTaskDelete(NULL);
+    }
+
     while (1)
     {
-        twai_message_t *rcvMsg;    /* pointer to received message in CAN module */
-        uint16_t index;            /* index of received message */
-        uint32_t rcvMsgIdent;      /* identifier of the received message */
-        CO_CANrx_t *buffer = NULL; /* receive message buffer from CO_CANmodule_t object. */
-        bool_t msgMatched = false;
+        uint16_t batch;
 
-        twai_receive(&rx_msg, portMAX_DELAY);
+        /* Block until the first frame arrives */
+        batch = CO_CANrxPoll(CANmodule, portMAX_DELAY);
+        if (batch == 0U)
+        {
+            continue;
+        }
 
-#if CONFIG_CO_DEBUG_DRIVER_CAN_RECEIVE
-        ESP_LOGI(TAG, "CANRX id: 0x%lx, dlc: %d, data: [%d %d %d %d %d %d %d %d]",
-                 rx_msg.identifier,
-                 rx_msg.data_length_code,
-                 rx_msg.data[0],
-                 rx_msg.data[1],
-                 rx_msg.data[2],
-                 rx_msg.data[3],
-                 rx_msg.data[4],
-                 rx_msg.data[5],
-                 rx_msg.data[6],
-                 rx_msg.data[7]);
-#endif /* CONFIG_CO_DEBUG_DRIVER_CAN_RECEIVE */
+        /* Size of the first drain only, frames taken by the polls between
+         * dispatches below arrived after this wakeup */
+        CANmodule->rxBatchLast = batch;
+        if (batch > CANmodule->rxBatchMax)
+        {
+            CANmodule->rxBatchMax = batch;
+        }
 
-        rcvMsg = &rx_msg;
-        rcvMsgIdent = rx_msg.identifier;
-        /* CAN module filters are not used, message with any standard 11-bit identifier */
-        /* has been received. Search rxArray form CANmodule for the same CAN-ID. */
-        buffer = &CANmodule->rxArray[0];
-        for (index = CANmodule->rxSize; index > 0U; index--)
+        /* Frames still waiting in the driver queue, plus the ones just taken */
+        if (twai_get_status_info(&statusInfo) == ESP_OK)
         {
-            if (((rcvMsgIdent ^ buffer->ident) & buffer->mask) == 0U)
+            uint32_t depth = statusInfo.msgs_to_rx + batch;
+
+            if (depth > CANmodule->rxQueueHighWater)
             {
-                msgMatched = true;
-                break;
+                CANmodule->rxQueueHighWater = (uint16_t)depth;
             }
-            buffer++;
         }
 
-        /* Call specific function, which will process the message */
-        if (msgMatched && (buffer != NULL) && (buffer->CANrx_callback != NULL))
+        /* Dispatch by lane priority, in order of arrival inside each lane, so
+         * SYNC and synchronous RPDOs are not reordered. The driver queue is
+         * polled again after each frame: a SYNC received during an SDO burst
+         * overtakes the waiting SDO frames, and the driver queue does not
+         * fill up while the lanes have room. */
+        while (CO_CANrxLanes_pop(&s_rxLanes, &rcvMsg, &lane))
         {
-            buffer->CANrx_callback(buffer->object, (void *)rcvMsg);
+            /* Not in configuration mode, CO_CANrxQuiesce() waits for it */
+            (void)__atomic_add_fetch(&s_rxDispatchSeq, 1U, __ATOMIC_SEQ_CST);
+            if (__atomic_load_n(&CANmodule->CANnormal, __ATOMIC_SEQ_CST))
+            {
+                CO_CANrxDispatch(CANmodule, &rcvMsg, lane);
+            }
+            (void)__atomic_add_fetch(&s_rxDispatchSeq, 1U, __ATOMIC_SEQ_CST);
+            (void)CO_CANrxPoll(CANmodule, 0);
         }
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,255 @@
+/*
+ * CAN frame capture ring for CANopenNode drivers.
+ *
+ * @file        CO_driver_capture.c
+ * @ingroup     CO_driver
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "CO_driver_capture.h"
+
+#if (CO_CAN_CAPTURE_LEN & (CO_CAN_CAPTURE_LEN - 1U)) != 0U
+#error CO_CAN_CAPTURE_LEN must be power of two
+#endif
+
+#define CAPTURE_MASK (CO_CAN_CAPTURE_LEN - 1U)
+#define CAPTURE_RECORD_SIZE sizeof(CO_CANcaptureRecord_t)
+
+_Static_assert(sizeof(CO_CANcaptureRecord_t) == 16U, "capture record must be packed to 16 bytes");
+
+/* Record with free running index is the trigger, stop after postTrigger more */
+static void capture_triggerAt(CO_CANcapture_t *capture, uint32_t index, uint32_t stopIndex, uint8_t source)
+{
+    if (capture->state != (uint8_t)CO_CAN_CAPTURE_ARMED)
+    {
+        return;
+    }
+    capture->triggerIndex = index;
+    capture->triggerSource = source;
+    capture->stopIndex = stopIndex;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    capture->state = (uint8_t)(((int32_t)(capture->writeIndex - stopIndex) >= 0) ? CO_CAN_CAPTURE_DONE
+                                                                                  : CO_CAN_CAPTURE_TRIGGERED);
+}
+
+/* End of valid records, free running */
+static uint32_t capture_end(const CO_CANcapture_t *capture)
+{
+    uint32_t end = capture->writeIndex;
+
+    if ((capture->state >= (uint8_t)CO_CAN_CAPTURE_TRIGGERED) && ((int32_t)(end - capture->stopIndex) > 0))
+    {
+        end = capture->stopIndex;
+    }
+    return end;
+}
+
+static void capture_put32(uint8_t *p, uint32_t v)
+{
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+/******************************************************************************/
+void CO_CANcapture_init(CO_CANcapture_t *capture)
+{
+    memset(capture, 0, sizeof(*capture));
+    capture->triggerCobMask = 0x07FFU;
+}
+
+/******************************************************************************/
+void CO_CANcapture_arm(CO_CANcapture_t *capture, uint8_t triggers, uint16_t cobId, uint16_t cobMask,
+                       uint16_t postTrigger)
+{
+    capture->state = (uint8_t)CO_CAN_CAPTURE_IDLE;
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    capture->triggers = triggers;
+    capture->triggerCobId = cobId & 0x07FFU;
+    capture->triggerCobMask = cobMask & 0x07FFU;
+    /* keep the trigger record in the ring */
+    capture->postTrigger = (postTrigger < CO_CAN_CAPTURE_LEN) ? postTrigger : (uint16_t)(CO_CAN_CAPTURE_LEN - 1U);
+    capture->triggerSource = 0U;
+    capture->writeIndex = 0U;
+    capture->triggerIndex = 0U;
+    capture->stopIndex = 0U;
+
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    capture->state = (uint8_t)CO_CAN_CAPTURE_ARMED;
+}
+
+/******************************************************************************/
+void CO_CANcapture_stop(CO_CANcapture_t *capture)
+{
+    if (CO_CANcapture_active(capture))
+    {
+        capture->stopIndex = capture_end(capture);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        capture->state = (uint8_t)CO_CAN_CAPTURE_DONE;
+    }
+}
+
+/******************************************************************************/
+void CO_CANcapture_trigger(CO_CANcapture_t *capture, uint8_t source)
+{
+    uint32_t index;
+
+    if ((source & (capture->triggers | CO_CAN_CAPTURE_TRIG_MANUAL)) == 0U)
+    {
+        return;
+    }
+    /* next recorded frame is the first one after the event */
+    index = capture->writeIndex;
+    capture_triggerAt(capture, index, index + capture->postTrigger, source);
+}
+
+/******************************************************************************/
+void CO_CANcapture_record(CO_CANcapture_t *capture, uint16_t ident, uint8_t DLC, const uint8_t *data,
+                          uint32_t timestamp_us)
+{
+    uint8_t state = capture->state;
+    CO_CANcaptureRecord_t *rec;
+    uint32_t i;
+
+    if ((state != (uint8_t)CO_CAN_CAPTURE_ARMED) && (state != (uint8_t)CO_CAN_CAPTURE_TRIGGERED))
+    {
+        return;
+    }
+
+    i = __atomic_fetch_add(&capture->writeIndex, 1U, __ATOMIC_RELAXED);
+    if ((state == (uint8_t)CO_CAN_CAPTURE_TRIGGERED) && ((int32_t)(i - capture->stopIndex) >= 0))
+    {
+        capture->state = (uint8_t)CO_CAN_CAPTURE_DONE;
+        return;
+    }
+
+    rec = &capture->ring[i & CAPTURE_MASK];
+    rec->timestamp_us = timestamp_us;
+    rec->ident = ident;
+    rec->DLC = DLC;
+    rec->reserved = 0U;
+    memcpy(rec->data, data, sizeof(rec->data));
+
+    if (state == (uint8_t)CO_CAN_CAPTURE_ARMED)
+    {
+        uint16_t id = ident & 0x07FFU;
+        uint8_t source = 0U;
+
+        if (((capture->triggers & CO_CAN_CAPTURE_TRIG_COBID) != 0U) &&
+            (((id ^ capture->triggerCobId) & capture->triggerCobMask) == 0U))
+        {
+            source = CO_CAN_CAPTURE_TRIG_COBID;
+        }
+        else if (((capture->triggers & CO_CAN_CAPTURE_TRIG_EMCY) != 0U) && (id > 0x080U) && (id < 0x100U))
+        {
+            source = CO_CAN_CAPTURE_TRIG_EMCY;
+        }
+        if (source != 0U)
+        {
+            capture_triggerAt(capture, i, i + 1U + capture->postTrigger, source);
+        }
+    }
+    else if ((i + 1U) == capture->stopIndex)
+    {
+        capture->state = (uint8_t)CO_CAN_CAPTURE_DONE;
+    }
+}
+
+/******************************************************************************/
+uint16_t CO_CANcapture_count(const CO_CANcapture_t *capture)
+{
+    uint32_t end = capture_end(capture);
+
+    return (uint16_t)((end > CO_CAN_CAPTURE_LEN) ? CO_CAN_CAPTURE_LEN : end);
+}
+
+/******************************************************************************/
+size_t CO_CANcapture_snapshot(CO_CANcapture_t *capture)
+{
+    uint32_t end = capture_end(capture);
+
+    capture->readCount = (uint16_t)((end > CO_CAN_CAPTURE_LEN) ? CO_CAN_CAPTURE_LEN : end);
+    capture->readStart = end - capture->readCount;
+
+    return CO_CAN_CAPTURE_HEADER_SIZE + ((size_t)capture->readCount * CAPTURE_RECORD_SIZE);
+}
+
+/******************************************************************************/
+size_t CO_CANcapture_read(const CO_CANcapture_t *capture, size_t offset, uint8_t *buf, size_t count)
+{
+    size_t size = CO_CAN_CAPTURE_HEADER_SIZE + ((size_t)capture->readCount * CAPTURE_RECORD_SIZE);
+    size_t copied = 0U;
+
+    if (offset >= size)
+    {
+        return 0U;
+    }
+    if (count > (size - offset))
+    {
+        count = size - offset;
+    }
+
+    if (offset < CO_CAN_CAPTURE_HEADER_SIZE)
+    {
+        uint8_t header[CO_CAN_CAPTURE_HEADER_SIZE];
+        uint32_t trigger = capture->triggerIndex - capture->readStart;
+        size_t n = CO_CAN_CAPTURE_HEADER_SIZE - offset;
+
+        if ((capture->triggerSource == 0U) || (trigger >= capture->readCount))
+        {
+            trigger = 0xFFFFU;
+        }
+        capture_put32(&header[0], CO_CAN_CAPTURE_MAGIC);
+        header[4] = CO_CAN_CAPTURE_VERSION;
+        header[5] = (uint8_t)CAPTURE_RECORD_SIZE;
+        header[6] = (uint8_t)capture->readCount;
+        header[7] = (uint8_t)(capture->readCount >> 8);
+        header[8] = (uint8_t)trigger;
+        header[9] = (uint8_t)(trigger >> 8);
+        header[10] = capture->triggerSource;
+        header[11] = capture->state;
+        capture_put32(&header[12], capture->readStart);
+
+        if (n > count)
+        {
+            n = count;
+        }
+        memcpy(buf, &header[offset], n);
+        copied = n;
+        offset += n;
+    }
+
+    while (copied < count)
+    {
+        size_t recOffset = offset - CO_CAN_CAPTURE_HEADER_SIZE;
+        size_t k = recOffset / CAPTURE_RECORD_SIZE;
+        size_t inRec = recOffset % CAPTURE_RECORD_SIZE;
+        size_t n = CAPTURE_RECORD_SIZE - inRec;
+        const uint8_t *rec = (const uint8_t *)&capture->ring[(capture->readStart + (uint32_t)k) & CAPTURE_MASK];
+
+        if (n > (count - copied))
+        {
+            n = count - copied;
+        }
+        memcpy(&buf[copied], &rec[inRec], n);
+        copied += n;
+        offset += n;
+    }
+
+    return copied;
+}
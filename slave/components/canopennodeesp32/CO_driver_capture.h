@@ -0,0 +1,206 @@
+/*
+ * CAN frame capture ring for CANopenNode drivers.
+ *
+ * @file        CO_driver_capture.h
+ * @ingroup     CO_driver
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_DRIVER_CAPTURE_H
+#define CO_DRIVER_CAPTURE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Number of records in the ring, power of two */
+#ifndef CO_CAN_CAPTURE_LEN
+#define CO_CAN_CAPTURE_LEN 256U
+#endif
+
+/* Trigger sources, bitmask */
+#define CO_CAN_CAPTURE_TRIG_COBID 0x01U  /**< Frame with (ident & triggerCobMask) == triggerCobId */
+#define CO_CAN_CAPTURE_TRIG_EMCY 0x02U   /**< Emergency frame, received or sent (0x081..0x0FF) */
+#define CO_CAN_CAPTURE_TRIG_BUSOFF 0x04U /**< Controller entered bus-off */
+#define CO_CAN_CAPTURE_TRIG_MANUAL 0x80U /**< Triggered by CO_CANcapture_trigger() from the application */
+
+/* Flags in CO_CANcaptureRecord_t.ident */
+#define CO_CAN_CAPTURE_RTR 0x0800U
+#define CO_CAN_CAPTURE_TX 0x8000U
+
+/* Header of the image returned by CO_CANcapture_read() */
+#define CO_CAN_CAPTURE_MAGIC 0x50414343UL /* "CCAP" in little endian */
+#define CO_CAN_CAPTURE_VERSION 1U
+#define CO_CAN_CAPTURE_HEADER_SIZE 16U
+
+/**
+ * Capture state.
+ */
+typedef enum
+{
+    CO_CAN_CAPTURE_IDLE = 0,      /**< Not recording */
+    CO_CAN_CAPTURE_ARMED = 1,     /**< Recording into the ring, waiting for trigger */
+    CO_CAN_CAPTURE_TRIGGERED = 2, /**< Recording postTrigger more frames */
+    CO_CAN_CAPTURE_DONE = 3       /**< Ring is frozen, ready for upload */
+} CO_CANcaptureState_t;
+
+/**
+ * One captured frame, 16 bytes.
+ */
+typedef struct
+{
+    uint32_t timestamp_us; /**< Low 32 bits of the microsecond clock */
+    uint16_t ident;        /**< 11-bit CAN-ID, CO_CAN_CAPTURE_RTR, CO_CAN_CAPTURE_TX */
+    uint8_t DLC;           /**< Data length code */
+    uint8_t reserved;
+    uint8_t data[8];
+} CO_CANcaptureRecord_t;
+
+/**
+ * Capture ring.
+ *
+ * Receive and transmit paths call CO_CANcapture_record() for each frame. While
+ * armed, the ring keeps the last CO_CAN_CAPTURE_LEN frames. When a trigger
+ * occurs, postTrigger more frames are recorded and the ring is frozen, so it
+ * holds the history before and after the event.
+ *
+ * Image produced by CO_CANcapture_read(), all values little endian:
+ * - 0:  uint32 magic CO_CAN_CAPTURE_MAGIC ("CCAP")
+ * - 4:  uint8 version, uint8 record size (16), uint16 number of records
+ * - 8:  uint16 index of the trigger record (0xFFFF if none), uint8 trigger
+ *       source (CO_CAN_CAPTURE_TRIG_xx), uint8 state (CO_CANcaptureState_t)
+ * - 12: uint32 number of frames overwritten before the first record
+ * - 16: records, oldest first, in CO_CANcaptureRecord_t layout
+ *
+ * Host tool converts each record to candump format as
+ * "(timestamp) can0 IDENT#DATA", with TX flag as direction.
+ */
+typedef struct
+{
+    volatile uint8_t state;       /**< CO_CANcaptureState_t */
+    uint8_t triggers;             /**< Enabled trigger sources */
+    uint8_t triggerSource;        /**< Source, which triggered the capture */
+    uint16_t triggerCobId;        /**< For CO_CAN_CAPTURE_TRIG_COBID */
+    uint16_t triggerCobMask;      /**< For CO_CAN_CAPTURE_TRIG_COBID */
+    uint16_t postTrigger;         /**< Frames recorded after the trigger */
+    volatile uint32_t writeIndex; /**< Free running, next record */
+    uint32_t triggerIndex;        /**< Free running index of the trigger record */
+    uint32_t stopIndex;           /**< Free running index, where recording stops */
+    uint32_t readStart;           /**< Snapshot from CO_CANcapture_snapshot() */
+    uint16_t readCount;
+    uint32_t recordCyclesMax;     /**< Worst case CPU cycles of one record, set by driver */
+    CO_CANcaptureRecord_t ring[CO_CAN_CAPTURE_LEN];
+} CO_CANcapture_t;
+
+/**
+ * Initialize idle capture.
+ *
+ * @param capture This object.
+ */
+void CO_CANcapture_init(CO_CANcapture_t *capture);
+
+/**
+ * Clear the ring and start recording.
+ *
+ * @param capture This object.
+ * @param triggers Enabled trigger sources, CO_CAN_CAPTURE_TRIG_xx.
+ * @param cobId CAN-ID for CO_CAN_CAPTURE_TRIG_COBID.
+ * @param cobMask Mask for CO_CAN_CAPTURE_TRIG_COBID.
+ * @param postTrigger Frames recorded after the trigger, limited to the ring size.
+ */
+void CO_CANcapture_arm(CO_CANcapture_t *capture, uint8_t triggers, uint16_t cobId, uint16_t cobMask,
+                       uint16_t postTrigger);
+
+/**
+ * Stop recording, ring is frozen.
+ *
+ * @param capture This object.
+ */
+void CO_CANcapture_stop(CO_CANcapture_t *capture);
+
+/**
+ * Trigger armed capture by an event, which is not a frame (bus-off, manual).
+ *
+ * Ignored, if capture is not armed or source is not enabled. Manual trigger is
+ * always enabled.
+ *
+ * @param capture This object.
+ * @param source CO_CAN_CAPTURE_TRIG_xx.
+ */
+void CO_CANcapture_trigger(CO_CANcapture_t *capture, uint8_t source);
+
+/**
+ * Record one frame. Safe to call from receive and transmit tasks concurrently.
+ *
+ * @param capture This object.
+ * @param ident 11-bit CAN-ID with CO_CAN_CAPTURE_RTR and CO_CAN_CAPTURE_TX flags.
+ * @param DLC Data length code.
+ * @param data Frame data, 8 bytes.
+ * @param timestamp_us Time of the frame.
+ */
+void CO_CANcapture_record(CO_CANcapture_t *capture, uint16_t ident, uint8_t DLC, const uint8_t *data,
+                          uint32_t timestamp_us);
+
+/**
+ * Check, if frames are being recorded. Cheap, call before CO_CANcapture_record().
+ *
+ * @param capture This object.
+ *
+ * @return true, if armed or triggered.
+ */
+static inline bool CO_CANcapture_active(const CO_CANcapture_t *capture)
+{
+    return (capture->state == (uint8_t)CO_CAN_CAPTURE_ARMED) || (capture->state == (uint8_t)CO_CAN_CAPTURE_TRIGGERED);
+}
+
+/**
+ * Number of records currently in the ring.
+ *
+ * @param capture This object.
+ *
+ * @return Number of records.
+ */
+uint16_t CO_CANcapture_count(const CO_CANcapture_t *capture);
+
+/**
+ * Fix range of records for CO_CANcapture_read(). Call at the start of upload.
+ *
+ * @param capture This object.
+ *
+ * @return Size of the image in bytes.
+ */
+size_t CO_CANcapture_snapshot(CO_CANcapture_t *capture);
+
+/**
+ * Copy part of the image, see CO_CANcapture_t.
+ *
+ * @param capture This object.
+ * @param offset Offset in the image.
+ * @param buf Destination.
+ * @param count Size of buf.
+ *
+ * @return Number of bytes copied, 0 at the end of the image.
+ */
+size_t CO_CANcapture_read(const CO_CANcapture_t *capture, size_t offset, uint8_t *buf, size_t count);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CO_DRIVER_CAPTURE_H */
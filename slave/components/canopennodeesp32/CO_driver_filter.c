@@ -0,0 +1,227 @@
+/*
+ * CAN acceptance filter synthesis for CANopenNode drivers.
+ *
+ * @file        CO_driver_filter.c
+ * @ingroup     CO_driver
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CO_driver_filter.h"
+
+#define FILTER_ID_BITS 0x07FFU
+#define FILTER_ALL_BITS 0x0FFFU
+
+/* Code/mask pair, which covers a group of receive buffers */
+typedef struct
+{
+    uint16_t ident;
+    uint16_t mask;
+    bool_t used;
+} filterGroup_t;
+
+static uint16_t filter_bitCount(uint16_t value)
+{
+    uint16_t count = 0U;
+
+    while (value != 0U)
+    {
+        value &= (uint16_t)(value - 1U);
+        count++;
+    }
+    return count;
+}
+
+static void filter_add(filterGroup_t *group, uint16_t ident, uint16_t mask)
+{
+    mask &= FILTER_ALL_BITS;
+    if (!group->used)
+    {
+        group->mask = mask;
+        group->used = true;
+    }
+    else
+    {
+        /* keep only bits, which all members care about and agree on */
+        group->mask &= mask & (uint16_t)~(group->ident ^ ident);
+    }
+    group->ident = ident & group->mask;
+}
+
+/* Number of 11-bit identifiers accepted by the group */
+static uint16_t filter_groupIds(const filterGroup_t *group)
+{
+    if (!group->used)
+    {
+        return 0U;
+    }
+    return (uint16_t)(1U << filter_bitCount((uint16_t)~group->mask & FILTER_ID_BITS));
+}
+
+/* Number of 11-bit identifiers accepted by any of both groups */
+static uint16_t filter_unionIds(const filterGroup_t *a, const filterGroup_t *b)
+{
+    uint16_t ids = filter_groupIds(a) + filter_groupIds(b);
+
+    if (a->used && b->used && (((a->ident ^ b->ident) & a->mask & b->mask & FILTER_ID_BITS) == 0U))
+    {
+        ids -= (uint16_t)(1U << filter_bitCount((uint16_t)~(a->mask | b->mask) & FILTER_ID_BITS));
+    }
+    return ids;
+}
+
+static bool_t filter_rxUsed(const CO_CANrx_t *rx)
+{
+    return rx->CANrx_callback != NULL;
+}
+
+/******************************************************************************/
+void CO_CANfilter_build(const CO_CANrx_t rxArray[], uint16_t rxSize, CO_CANfilter_t *filter)
+{
+    filterGroup_t single = {0};
+    uint16_t i;
+
+    filter->count = 0U;
+    filter->ident[0] = filter->ident[1] = 0U;
+    filter->mask[0] = filter->mask[1] = 0U;
+    filter->acceptedIds = CO_CAN_FILTER_ID_SPACE;
+
+    for (i = 0U; i < rxSize; i++)
+    {
+        if (filter_rxUsed(&rxArray[i]))
+        {
+            filter_add(&single, rxArray[i].ident, rxArray[i].mask);
+        }
+    }
+    if (!single.used)
+    {
+        /* nothing configured yet, leave the filter open */
+        return;
+    }
+
+    filter->count = 1U;
+    filter->ident[0] = single.ident;
+    filter->mask[0] = single.mask;
+    filter->acceptedIds = filter_groupIds(&single);
+
+    /* Dual filter: seed both groups with every pair of buffers and add the
+     * remaining buffers greedily to the group, which grows less. O(n^3), but
+     * it runs only when receive buffers are reconfigured. */
+    for (i = 0U; i < rxSize; i++)
+    {
+        uint16_t j;
+
+        if (!filter_rxUsed(&rxArray[i]))
+        {
+            continue;
+        }
+        for (j = i + 1U; j < rxSize; j++)
+        {
+            filterGroup_t group[2] = {0};
+            uint16_t k;
+            uint16_t ids;
+
+            if (!filter_rxUsed(&rxArray[j]))
+            {
+                continue;
+            }
+            filter_add(&group[0], rxArray[i].ident, rxArray[i].mask);
+            filter_add(&group[1], rxArray[j].ident, rxArray[j].mask);
+
+            for (k = 0U; k < rxSize; k++)
+            {
+                filterGroup_t try0, try1;
+
+                if ((k == i) || (k == j) || !filter_rxUsed(&rxArray[k]))
+                {
+                    continue;
+                }
+                try0 = group[0];
+                try1 = group[1];
+                filter_add(&try0, rxArray[k].ident, rxArray[k].mask);
+                filter_add(&try1, rxArray[k].ident, rxArray[k].mask);
+                if (filter_unionIds(&try0, &group[1]) <= filter_unionIds(&group[0], &try1))
+                {
+                    group[0] = try0;
+                }
+                else
+                {
+                    group[1] = try1;
+                }
+            }
+
+            ids = filter_unionIds(&group[0], &group[1]);
+            if (ids < filter->acceptedIds)
+            {
+                filter->count = 2U;
+                filter->ident[0] = group[0].ident;
+                filter->mask[0] = group[0].mask;
+                filter->ident[1] = group[1].ident;
+                filter->mask[1] = group[1].mask;
+                filter->acceptedIds = ids;
+            }
+        }
+    }
+}
+
+/******************************************************************************/
+bool_t CO_CANfilter_accepts(const CO_CANfilter_t *filter, uint16_t ident)
+{
+    uint8_t i;
+
+    if (filter->count == 0U)
+    {
+        return true;
+    }
+    for (i = 0U; i < filter->count; i++)
+    {
+        if (((ident ^ filter->ident[i]) & filter->mask[i]) == 0U)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+/******************************************************************************/
+bool_t CO_CANfilter_covers(const CO_CANfilter_t *filter, const CO_CANrx_t rxArray[], uint16_t rxSize)
+{
+    uint16_t i;
+
+    if (filter->count == 0U)
+    {
+        return true;
+    }
+    for (i = 0U; i < rxSize; i++)
+    {
+        const CO_CANrx_t *rx = &rxArray[i];
+        bool_t covered = false;
+        uint8_t f;
+
+        if (!filter_rxUsed(rx))
+        {
+            continue;
+        }
+        for (f = 0U; (f < filter->count) && !covered; f++)
+        {
+            uint16_t mask = filter->mask[f] & FILTER_ALL_BITS;
+
+            covered = ((mask & (uint16_t)~rx->mask) == 0U) && (((rx->ident ^ filter->ident[f]) & mask) == 0U);
+        }
+        if (!covered)
+        {
+            return false;
+        }
+    }
+    return true;
+}
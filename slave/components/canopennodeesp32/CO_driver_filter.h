@@ -0,0 +1,91 @@
+/*
+ * CAN acceptance filter synthesis for CANopenNode drivers.
+ *
+ * @file        CO_driver_filter.h
+ * @ingroup     CO_driver
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_DRIVER_FILTER_H
+#define CO_DRIVER_FILTER_H
+
+#include "301/CO_driver.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Number of standard 11-bit CAN identifiers */
+#define CO_CAN_FILTER_ID_SPACE 2048U
+
+/**
+ * Acceptance filter, which covers all receive buffers of a CAN module.
+ *
+ * Identifiers and masks use the same alignment as CO_CANrx_t: identifier in
+ * bits 0..10, RTR in bit 11. Mask bit set means, that bit must match.
+ */
+typedef struct
+{
+    uint8_t count;        /**< 0 = accept all, 1 = single filter, 2 = dual filter */
+    uint16_t ident[2];    /**< Acceptance code of each filter */
+    uint16_t mask[2];     /**< Acceptance mask of each filter */
+    uint16_t acceptedIds; /**< Number of 11-bit identifiers passed by the filter */
+} CO_CANfilter_t;
+
+/**
+ * Build the tightest single or dual acceptance filter for the rxArray.
+ *
+ * Only configured buffers (with CANrx_callback set) are taken into account.
+ * Single filter is the smallest code/mask pair, which covers all buffers.
+ * For dual filter buffers are split into two groups, so that the union of
+ * both groups accepts the fewest identifiers. Dual filter is chosen only, if
+ * it accepts fewer identifiers than the single one.
+ *
+ * @param rxArray Receive buffers from CO_CANmodule_t.
+ * @param rxSize Number of elements in rxArray.
+ * @param [out] filter Resulting filter.
+ */
+void CO_CANfilter_build(const CO_CANrx_t rxArray[], uint16_t rxSize, CO_CANfilter_t *filter);
+
+/**
+ * Check if frame with given identifier passes the filter.
+ *
+ * @param filter Filter from CO_CANfilter_build().
+ * @param ident Identifier in bits 0..10, RTR in bit 11.
+ *
+ * @return true, if frame is accepted.
+ */
+bool_t CO_CANfilter_accepts(const CO_CANfilter_t *filter, uint16_t ident);
+
+/**
+ * Check if the filter passes all identifiers of all configured buffers.
+ *
+ * A buffer is covered, if one filter cares only about bits, which the buffer
+ * cares about too, and agrees with it on them. Filter, which is wider than
+ * CO_CANfilter_build() would make it, does not need to be rebuilt.
+ *
+ * @param filter Filter, for example the one in the controller.
+ * @param rxArray Receive buffers from CO_CANmodule_t.
+ * @param rxSize Number of elements in rxArray.
+ *
+ * @return true, if no frame of a configured buffer is rejected.
+ */
+bool_t CO_CANfilter_covers(const CO_CANfilter_t *filter, const CO_CANrx_t rxArray[], uint16_t rxSize);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CO_DRIVER_FILTER_H */
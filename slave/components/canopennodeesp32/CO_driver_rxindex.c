@@ -0,0 +1,194 @@
+/*
+ * Constant time lookup of CAN receive buffers for CANopenNode drivers.
+ *
+ * @file        CO_driver_rxindex.c
+ * @ingroup     CO_driver
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "CO_driver_rxindex.h"
+
+#define RXINDEX_ID_BITS 0x07FFU
+
+static bool_t rxIndex_used(const CO_CANrx_t *rx)
+{
+    return rx->CANrx_callback != NULL;
+}
+
+static bool_t rxIndex_isExact(const CO_CANrx_t *rx)
+{
+    return (rx->mask & RXINDEX_ID_BITS) == RXINDEX_ID_BITS;
+}
+
+/* Lowest index of exact buffer with given 11-bit identifier */
+static uint16_t rxIndex_lowestExact(const CO_CANrx_t rxArray[], uint16_t rxSize, uint16_t id)
+{
+    uint16_t i;
+
+    for (i = 0U; i < rxSize; i++)
+    {
+        if (rxIndex_used(&rxArray[i]) && rxIndex_isExact(&rxArray[i]) &&
+            ((rxArray[i].ident & RXINDEX_ID_BITS) == id))
+        {
+            return i;
+        }
+    }
+    return CO_CAN_RXINDEX_NONE;
+}
+
+/******************************************************************************/
+void CO_CANrxIndex_init(CO_CANrxIndex_t *rxIndex)
+{
+    uint16_t i;
+
+    for (i = 0U; i < (sizeof(rxIndex->exact) / sizeof(rxIndex->exact[0])); i++)
+    {
+        rxIndex->exact[i] = CO_CAN_RXINDEX_NONE;
+    }
+    rxIndex->maskedCount = 0U;
+    rxIndex->maskedOverflow = false;
+    rxIndex->seq = 0U;
+}
+
+/******************************************************************************/
+void CO_CANrxIndex_update(CO_CANrxIndex_t *rxIndex, const CO_CANrx_t rxArray[], uint16_t rxSize, uint16_t index,
+                          uint16_t oldIdent, uint16_t oldMask)
+{
+    const CO_CANrx_t *rx = &rxArray[index];
+    uint16_t oldId = oldIdent & RXINDEX_ID_BITS;
+    uint16_t masked[CO_CAN_RXINDEX_MASKED_MAX];
+    uint16_t maskedCount = 0U;
+    bool_t maskedOverflow = false;
+    uint16_t i;
+
+    /* masked buffers are few, build the new list aside */
+    for (i = 0U; i < rxSize; i++)
+    {
+        if (rxIndex_used(&rxArray[i]) && !rxIndex_isExact(&rxArray[i]))
+        {
+            if (maskedCount >= CO_CAN_RXINDEX_MASKED_MAX)
+            {
+                maskedOverflow = true;
+                break;
+            }
+            masked[maskedCount++] = i;
+        }
+    }
+
+    /* lookups from now on use the linear scan */
+    (void)__atomic_add_fetch(&rxIndex->seq, 1U, __ATOMIC_SEQ_CST);
+
+    /* remove previous identifier, another buffer may take it over */
+    if (((oldMask & RXINDEX_ID_BITS) == RXINDEX_ID_BITS) && (rxIndex->exact[oldId] == index))
+    {
+        rxIndex->exact[oldId] = rxIndex_lowestExact(rxArray, rxSize, oldId);
+    }
+
+    /* add new identifier */
+    if (rxIndex_used(rx) && rxIndex_isExact(rx))
+    {
+        uint16_t id = rx->ident & RXINDEX_ID_BITS;
+
+        if ((rxIndex->exact[id] == CO_CAN_RXINDEX_NONE) || (index < rxIndex->exact[id]))
+        {
+            rxIndex->exact[id] = index;
+        }
+    }
+
+    for (i = 0U; i < maskedCount; i++)
+    {
+        rxIndex->masked[i] = masked[i];
+    }
+    rxIndex->maskedCount = maskedCount;
+    rxIndex->maskedOverflow = maskedOverflow;
+
+    /* publish */
+    (void)__atomic_add_fetch(&rxIndex->seq, 1U, __ATOMIC_RELEASE);
+}
+
+/* Lookup in the index, valid only if no update overlaps it */
+static CO_CANrx_t *rxIndex_lookup(const CO_CANrxIndex_t *rxIndex, CO_CANrx_t rxArray[], uint16_t rxSize,
+                                  uint16_t ident)
+{
+    uint16_t best = rxIndex->exact[ident & RXINDEX_ID_BITS];
+    uint16_t i;
+
+    if (rxIndex->maskedOverflow)
+    {
+        return CO_CANrxIndex_scan(rxArray, rxSize, ident);
+    }
+    if (best != CO_CAN_RXINDEX_NONE)
+    {
+        if (((ident ^ rxArray[best].ident) & rxArray[best].mask) != 0U)
+        {
+            /* RTR bit differs, rare case */
+            return CO_CANrxIndex_scan(rxArray, rxSize, ident);
+        }
+    }
+
+    /* masked buffer with lower index has precedence */
+    for (i = 0U; i < rxIndex->maskedCount; i++)
+    {
+        uint16_t m = rxIndex->masked[i];
+
+        if (m >= best)
+        {
+            break;
+        }
+        if (((ident ^ rxArray[m].ident) & rxArray[m].mask) == 0U)
+        {
+            best = m;
+            break;
+        }
+    }
+
+    return (best != CO_CAN_RXINDEX_NONE) ? &rxArray[best] : NULL;
+}
+
+/******************************************************************************/
+CO_CANrx_t *CO_CANrxIndex_find(const CO_CANrxIndex_t *rxIndex, CO_CANrx_t rxArray[], uint16_t rxSize,
+                               uint16_t ident)
+{
+    uint32_t seq = __atomic_load_n(&rxIndex->seq, __ATOMIC_ACQUIRE);
+    CO_CANrx_t *buffer;
+
+    if ((seq & 1U) != 0U)
+    {
+        return CO_CANrxIndex_scan(rxArray, rxSize, ident);
+    }
+    buffer = rxIndex_lookup(rxIndex, rxArray, rxSize, ident);
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    if (__atomic_load_n(&rxIndex->seq, __ATOMIC_RELAXED) != seq)
+    {
+        return CO_CANrxIndex_scan(rxArray, rxSize, ident);
+    }
+    return buffer;
+}
+
+/******************************************************************************/
+CO_CANrx_t *CO_CANrxIndex_scan(CO_CANrx_t rxArray[], uint16_t rxSize, uint16_t ident)
+{
+    CO_CANrx_t *buffer = &rxArray[0];
+    uint16_t index;
+
+    for (index = rxSize; index > 0U; index--)
+    {
+        if (rxIndex_used(buffer) && (((ident ^ buffer->ident) & buffer->mask) == 0U))
+        {
+            return buffer;
+        }
+        buffer++;
+    }
+    return NULL;
+}
@@ -0,0 +1,115 @@
+/*
+ * Constant time lookup of CAN receive buffers for CANopenNode drivers.
+ *
+ * @file        CO_driver_rxindex.h
+ * @ingroup     CO_driver
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_DRIVER_RXINDEX_H
+#define CO_DRIVER_RXINDEX_H
+
+#include "301/CO_driver.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Marker for identifier without exact receive buffer */
+#define CO_CAN_RXINDEX_NONE 0xFFFFU
+
+/* Maximum number of masked (not exact) receive buffers searched separately.
+ * If there are more, lookup falls back to the linear scan. */
+#ifndef CO_CAN_RXINDEX_MASKED_MAX
+#define CO_CAN_RXINDEX_MASKED_MAX 8U
+#endif
+
+/**
+ * Dispatch index for the rxArray.
+ *
+ * Buffers with exact mask (0x7FF) are found directly by their 11-bit
+ * identifier. Buffers with other masks (EMCY consumer, for example) are kept
+ * in a short list and checked after the direct lookup, so precedence of the
+ * lower rxArray index is kept as with the linear scan.
+ *
+ * One task updates the index, while the receive task looks up in it. Update
+ * makes seq odd while it runs and even again with one store at the end. A
+ * lookup, which sees odd seq or overlaps a change of it, uses the linear scan
+ * instead, so it never sees a half rebuilt masked list.
+ */
+typedef struct
+{
+    uint16_t exact[2048];                         /**< Lowest rxArray index for each identifier */
+    uint16_t masked[CO_CAN_RXINDEX_MASKED_MAX];   /**< Masked buffers, ascending rxArray index */
+    uint16_t maskedCount;                         /**< Number of used elements in masked */
+    bool_t maskedOverflow;                        /**< Too many masked buffers, use linear scan */
+    volatile uint32_t seq;                        /**< Odd while CO_CANrxIndex_update() runs */
+} CO_CANrxIndex_t;
+
+/**
+ * Clear the index. Call, when all rxArray buffers are reset.
+ *
+ * @param rxIndex This object.
+ */
+void CO_CANrxIndex_init(CO_CANrxIndex_t *rxIndex);
+
+/**
+ * Update the index after rxArray[index] was (re)configured.
+ *
+ * Not reentrant, all updates must come from the same task.
+ *
+ * @param rxIndex This object.
+ * @param rxArray Receive buffers from CO_CANmodule_t.
+ * @param rxSize Number of elements in rxArray.
+ * @param index Index of the changed buffer.
+ * @param oldIdent Identifier of the buffer before the change.
+ * @param oldMask Mask of the buffer before the change.
+ */
+void CO_CANrxIndex_update(CO_CANrxIndex_t *rxIndex, const CO_CANrx_t rxArray[], uint16_t rxSize, uint16_t index,
+                          uint16_t oldIdent, uint16_t oldMask);
+
+/**
+ * Find receive buffer for received frame.
+ *
+ * May run concurrently with CO_CANrxIndex_update().
+ *
+ * @param rxIndex This object.
+ * @param rxArray Receive buffers from CO_CANmodule_t.
+ * @param rxSize Number of elements in rxArray.
+ * @param ident Identifier of received frame in bits 0..10, RTR in bit 11.
+ *
+ * @return Matching buffer with the lowest index or NULL.
+ */
+CO_CANrx_t *CO_CANrxIndex_find(const CO_CANrxIndex_t *rxIndex, CO_CANrx_t rxArray[], uint16_t rxSize,
+                               uint16_t ident);
+
+/**
+ * Find receive buffer with the linear scan through whole rxArray.
+ *
+ * Reference implementation, also used as fallback by CO_CANrxIndex_find().
+ *
+ * @param rxArray Receive buffers from CO_CANmodule_t.
+ * @param rxSize Number of elements in rxArray.
+ * @param ident Identifier of received frame in bits 0..10, RTR in bit 11.
+ *
+ * @return Matching buffer with the lowest index or NULL.
+ */
+CO_CANrx_t *CO_CANrxIndex_scan(CO_CANrx_t rxArray[], uint16_t rxSize, uint16_t ident);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CO_DRIVER_RXINDEX_H */
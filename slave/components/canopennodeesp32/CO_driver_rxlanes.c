@@ -0,0 +1,88 @@
+/*
+ * Priority lanes for received CAN messages for CANopenNode drivers.
+ *
+ * @file        CO_driver_rxlanes.c
+ * @ingroup     CO_driver
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "CO_driver_rxlanes.h"
+
+/******************************************************************************/
+bool_t CO_CANrxLanes_init(CO_CANrxLanes_t *rxLanes, const uint16_t size[CO_CAN_RX_LANE_COUNT])
+{
+    uint16_t base = 0U;
+    uint16_t i;
+
+    for (i = 0U; i < (uint16_t)CO_CAN_RX_LANE_COUNT; i++)
+    {
+        if ((size[i] == 0U) || ((uint32_t)base + size[i] > CO_CAN_RXLANES_SLOTS))
+        {
+            return false;
+        }
+        rxLanes->lane[i].base = base;
+        rxLanes->lane[i].size = size[i];
+        rxLanes->lane[i].head = 0U;
+        rxLanes->lane[i].count = 0U;
+        base += size[i];
+    }
+    return true;
+}
+
+/******************************************************************************/
+bool_t CO_CANrxLanes_push(CO_CANrxLanes_t *rxLanes, CO_CANrxLane_t lane, const CO_CANrxMsg_t *msg)
+{
+    CO_CANrxLaneQueue_t *q = &rxLanes->lane[lane];
+    uint16_t tail;
+
+    if (q->count >= q->size)
+    {
+        return false;
+    }
+    tail = q->head + q->count;
+    if (tail >= q->size)
+    {
+        tail -= q->size;
+    }
+    memcpy(&rxLanes->slot[q->base + tail], msg, sizeof(*msg));
+    q->count++;
+    return true;
+}
+
+/******************************************************************************/
+bool_t CO_CANrxLanes_pop(CO_CANrxLanes_t *rxLanes, CO_CANrxMsg_t *msg, CO_CANrxLane_t *lane)
+{
+    uint16_t i;
+
+    for (i = 0U; i < (uint16_t)CO_CAN_RX_LANE_COUNT; i++)
+    {
+        CO_CANrxLaneQueue_t *q = &rxLanes->lane[i];
+
+        if (q->count > 0U)
+        {
+            memcpy(msg, &rxLanes->slot[q->base + q->head], sizeof(*msg));
+            q->head++;
+            if (q->head >= q->size)
+            {
+                q->head = 0U;
+            }
+            q->count--;
+            *lane = (CO_CANrxLane_t)i;
+            return true;
+        }
+    }
+    return false;
+}
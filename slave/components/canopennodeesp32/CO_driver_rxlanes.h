@@ -0,0 +1,111 @@
+/*
+ * Priority lanes for received CAN messages for CANopenNode drivers.
+ *
+ * @file        CO_driver_rxlanes.h
+ * @ingroup     CO_driver
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_DRIVER_RXLANES_H
+#define CO_DRIVER_RXLANES_H
+
+#include "301/CO_driver.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Total number of messages in all lanes */
+#ifndef CO_CAN_RXLANES_SLOTS
+#define CO_CAN_RXLANES_SLOTS 80U
+#endif
+
+/**
+ * Queue of one lane, part of the common slot array.
+ */
+typedef struct
+{
+    uint16_t base;  /**< First slot of the lane */
+    uint16_t size;  /**< Number of slots, reserved for this lane only */
+    uint16_t head;  /**< Oldest message, relative to base */
+    uint16_t count; /**< Messages in the lane */
+} CO_CANrxLaneQueue_t;
+
+/**
+ * Receive lanes.
+ *
+ * Each lane (CO_CANrxLane_t) is a FIFO with its own fixed part of the slot
+ * array, so a flood in one lane can not take the capacity of another. Messages
+ * are taken out by lane priority, lower lane number first, and in order of
+ * arrival inside the lane.
+ *
+ * Object is not thread safe, it is used by the receive task only.
+ */
+typedef struct
+{
+    CO_CANrxLaneQueue_t lane[CO_CAN_RX_LANE_COUNT];
+    CO_CANrxMsg_t slot[CO_CAN_RXLANES_SLOTS];
+} CO_CANrxLanes_t;
+
+/**
+ * Initialize empty lanes.
+ *
+ * @param rxLanes This object.
+ * @param size Number of slots of each lane, sum maximum CO_CAN_RXLANES_SLOTS.
+ *
+ * @return false, if sizes are zero or too large.
+ */
+bool_t CO_CANrxLanes_init(CO_CANrxLanes_t *rxLanes, const uint16_t size[CO_CAN_RX_LANE_COUNT]);
+
+/**
+ * Add message to the end of the lane.
+ *
+ * @param rxLanes This object.
+ * @param lane Lane of the message.
+ * @param msg Message, copied.
+ *
+ * @return false, if the lane is full and the message is dropped.
+ */
+bool_t CO_CANrxLanes_push(CO_CANrxLanes_t *rxLanes, CO_CANrxLane_t lane, const CO_CANrxMsg_t *msg);
+
+/**
+ * Take the oldest message from the highest priority lane, which is not empty.
+ *
+ * @param rxLanes This object.
+ * @param [out] msg Message.
+ * @param [out] lane Lane of the message.
+ *
+ * @return false, if all lanes are empty.
+ */
+bool_t CO_CANrxLanes_pop(CO_CANrxLanes_t *rxLanes, CO_CANrxMsg_t *msg, CO_CANrxLane_t *lane);
+
+/**
+ * Number of messages in the lane.
+ *
+ * @param rxLanes This object.
+ * @param lane Lane.
+ *
+ * @return Number of messages.
+ */
+static inline uint16_t CO_CANrxLanes_count(const CO_CANrxLanes_t *rxLanes, CO_CANrxLane_t lane)
+{
+    return rxLanes->lane[lane].count;
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CO_DRIVER_RXLANES_H */
@@ -0,0 +1,132 @@
+/*
+ * SLCAN (Lawicel) frame stream for CANopenNode drivers.
+ *
+ * @file        CO_driver_slcan.c
+ * @ingroup     CO_driver
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "CO_driver_slcan.h"
+
+#if (CO_CAN_SLCAN_LEN & (CO_CAN_SLCAN_LEN - 1U)) != 0U
+#error CO_CAN_SLCAN_LEN must be power of two
+#endif
+
+#define SLCAN_MASK (CO_CAN_SLCAN_LEN - 1U)
+
+static const char slcan_hex[16] = {'0', '1', '2', '3', '4', '5', '6', '7',
+                                   '8', '9', 'A', 'B', 'C', 'D', 'E', 'F'};
+
+/* Write value as given number of hex digits, most significant first */
+static char *slcan_putHex(char *p, uint32_t value, uint8_t digits)
+{
+    uint8_t i;
+
+    for (i = digits; i > 0U; i--)
+    {
+        p[i - 1U] = slcan_hex[value & 0x0FU];
+        value >>= 4;
+    }
+    return p + digits;
+}
+
+/******************************************************************************/
+void CO_CANslcan_init(CO_CANslcan_t *slcan, bool timestamps)
+{
+    memset(slcan, 0, sizeof(*slcan));
+    slcan->timestamps = timestamps;
+}
+
+/******************************************************************************/
+bool CO_CANslcan_push(CO_CANslcan_t *slcan, uint32_t ident, uint8_t DLC, const uint8_t *data,
+                      uint32_t timestamp_us)
+{
+    uint32_t w = slcan->writeIndex;
+    uint16_t count = (uint16_t)(w - __atomic_load_n(&slcan->readIndex, __ATOMIC_ACQUIRE));
+    CO_CANslcanFrame_t *frame;
+
+    if (count >= CO_CAN_SLCAN_LEN)
+    {
+        slcan->lost++;
+        return false;
+    }
+
+    frame = &slcan->ring[w & SLCAN_MASK];
+    frame->timestamp_us = timestamp_us;
+    frame->ident = ident;
+    frame->DLC = (DLC > 8U) ? 8U : DLC;
+    memcpy(frame->data, data, frame->DLC);
+
+    __atomic_store_n(&slcan->writeIndex, w + 1U, __ATOMIC_RELEASE);
+    if ((uint16_t)(count + 1U) > slcan->highWater)
+    {
+        slcan->highWater = (uint16_t)(count + 1U);
+    }
+    return true;
+}
+
+/******************************************************************************/
+size_t CO_CANslcan_encode(const CO_CANslcanFrame_t *frame, bool timestamps, char *buf)
+{
+    bool rtr = (frame->ident & CO_CAN_SLCAN_RTR) != 0U;
+    char *p = buf;
+    uint8_t i;
+
+    if ((frame->ident & CO_CAN_SLCAN_EFF) != 0U)
+    {
+        *p++ = rtr ? 'R' : 'T';
+        p = slcan_putHex(p, frame->ident & 0x1FFFFFFFUL, 8U);
+    }
+    else
+    {
+        *p++ = rtr ? 'r' : 't';
+        p = slcan_putHex(p, frame->ident & 0x07FFUL, 3U);
+    }
+    *p++ = slcan_hex[frame->DLC];
+    if (!rtr)
+    {
+        for (i = 0U; i < frame->DLC; i++)
+        {
+            *p++ = slcan_hex[frame->data[i] >> 4];
+            *p++ = slcan_hex[frame->data[i] & 0x0FU];
+        }
+    }
+    if (timestamps)
+    {
+        p = slcan_putHex(p, (frame->timestamp_us / 1000U) % CO_CAN_SLCAN_TIMESTAMP_WRAP_MS, 4U);
+    }
+    *p++ = '\r';
+
+    return (size_t)(p - buf);
+}
+
+/******************************************************************************/
+size_t CO_CANslcan_read(CO_CANslcan_t *slcan, char *buf, size_t size)
+{
+    uint32_t r = slcan->readIndex;
+    uint32_t w = __atomic_load_n(&slcan->writeIndex, __ATOMIC_ACQUIRE);
+    size_t len = 0U;
+
+    while ((r != w) && ((size - len) >= CO_CAN_SLCAN_FRAME_MAX))
+    {
+        len += CO_CANslcan_encode(&slcan->ring[r & SLCAN_MASK], slcan->timestamps, &buf[len]);
+        r++;
+        slcan->streamed++;
+    }
+    __atomic_store_n(&slcan->readIndex, r, __ATOMIC_RELEASE);
+
+    return len;
+}
@@ -0,0 +1,148 @@
+/*
+ * SLCAN (Lawicel) frame stream for CANopenNode drivers.
+ *
+ * @file        CO_driver_slcan.h
+ * @ingroup     CO_driver
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_DRIVER_SLCAN_H
+#define CO_DRIVER_SLCAN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Number of frames in the ring, power of two */
+#ifndef CO_CAN_SLCAN_LEN
+#define CO_CAN_SLCAN_LEN 256U
+#endif
+
+/* Flags in CO_CANslcanFrame_t.ident, same bits as in Linux struct can_frame */
+#define CO_CAN_SLCAN_EFF 0x80000000UL /**< 29-bit identifier */
+#define CO_CAN_SLCAN_RTR 0x40000000UL /**< Remote transmission request */
+
+/* Longest encoded frame: "T" + 8 ident + DLC + 16 data + 4 timestamp + "\r" */
+#define CO_CAN_SLCAN_FRAME_MAX 31U
+
+/* Lawicel timestamp is in milliseconds and wraps after one minute */
+#define CO_CAN_SLCAN_TIMESTAMP_WRAP_MS 60000UL
+
+/**
+ * One received frame, waiting to be encoded.
+ */
+typedef struct
+{
+    uint32_t timestamp_us; /**< Low 32 bits of the microsecond clock */
+    uint32_t ident;        /**< 11 or 29-bit CAN-ID, CO_CAN_SLCAN_EFF, CO_CAN_SLCAN_RTR */
+    uint8_t DLC;           /**< Data length code */
+    uint8_t reserved[3];
+    uint8_t data[8];
+} CO_CANslcanFrame_t;
+
+/**
+ * SLCAN stream.
+ *
+ * Single producer (receive task) and single consumer (UART task). Receive
+ * path only copies the frame into the ring with CO_CANslcan_push(), text is
+ * produced by the consumer with CO_CANslcan_read(). If the consumer can not
+ * keep up, because the serial line is slower than the CAN bus, frames are
+ * counted as lost instead of blocking the receive path.
+ *
+ * Each frame is encoded as in Lawicel CAN232/CANUSB protocol:
+ * - "tiiildd..[ssss]\r" standard data frame
+ * - "Tiiiiiiiildd..[ssss]\r" extended data frame
+ * - "riiil[ssss]\r", "Riiiiiiiil[ssss]\r" remote frames
+ *
+ * with upper case hex digits and optional timestamp ssss (command "Z1") in
+ * milliseconds, 0 to 0xEA5F.
+ */
+typedef struct
+{
+    volatile uint32_t writeIndex; /**< Free running, next frame to write, changed by producer */
+    volatile uint32_t readIndex;  /**< Free running, next frame to read, changed by consumer */
+    uint32_t lost;                /**< Frames not stored, because the ring was full */
+    uint32_t streamed;            /**< Frames encoded by CO_CANslcan_read() */
+    uint16_t highWater;           /**< Highest number of frames in the ring */
+    bool timestamps;              /**< Append timestamp to each frame */
+    CO_CANslcanFrame_t ring[CO_CAN_SLCAN_LEN];
+} CO_CANslcan_t;
+
+/**
+ * Initialize empty stream and clear counters.
+ *
+ * @param slcan This object.
+ * @param timestamps Append timestamp to each frame.
+ */
+void CO_CANslcan_init(CO_CANslcan_t *slcan, bool timestamps);
+
+/**
+ * Store received frame. Called by the producer only.
+ *
+ * @param slcan This object.
+ * @param ident CAN-ID with CO_CAN_SLCAN_EFF and CO_CAN_SLCAN_RTR flags.
+ * @param DLC Data length code, 0 to 8.
+ * @param data Frame data, DLC bytes.
+ * @param timestamp_us Time of reception.
+ *
+ * @return false, if ring is full and frame is lost.
+ */
+bool CO_CANslcan_push(CO_CANslcan_t *slcan, uint32_t ident, uint8_t DLC, const uint8_t *data,
+                      uint32_t timestamp_us);
+
+/**
+ * Encode one frame as SLCAN text, terminated by "\r", not by zero.
+ *
+ * @param frame Frame to encode.
+ * @param timestamps Append timestamp.
+ * @param [out] buf Destination, at least CO_CAN_SLCAN_FRAME_MAX bytes.
+ *
+ * @return Number of characters written.
+ */
+size_t CO_CANslcan_encode(const CO_CANslcanFrame_t *frame, bool timestamps, char *buf);
+
+/**
+ * Encode and remove as many whole frames, as fit into buf. Called by the
+ * consumer only.
+ *
+ * @param slcan This object.
+ * @param [out] buf Destination.
+ * @param size Size of buf, at least CO_CAN_SLCAN_FRAME_MAX bytes for progress.
+ *
+ * @return Number of characters written, 0 if ring is empty.
+ */
+size_t CO_CANslcan_read(CO_CANslcan_t *slcan, char *buf, size_t size);
+
+/**
+ * Number of frames waiting in the ring.
+ *
+ * @param slcan This object.
+ *
+ * @return Number of frames.
+ */
+static inline uint16_t CO_CANslcan_count(const CO_CANslcan_t *slcan)
+{
+    return (uint16_t)(slcan->writeIndex - slcan->readIndex);
+}
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CO_DRIVER_SLCAN_H */
@@ -36,6 +36,7 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
 #include "driver/twai.h"
+#include "CO_driver_capture.h"
 
 /* Habilita SDO block transfer, CRC16 y buffers grandes para OTA (igual que firmware_updater) */
 #define CO_CONFIG_SDO_SRV (CO_CONFIG_SDO_SRV_SEGMENTED | CO_CONFIG_SDO_SRV_BLOCK | CO_CONFIG_GLOBAL_FLAG_CALLBACK_PRE | CO_CONFIG_GLOBAL_FLAG_TIMERNEXT | CO_CONFIG_GLOBAL_FLAG_OD_DYNAMIC)
@@ -47,6 +48,42 @@
 #define CO_CONFIG_CRC16 (CO_CONFIG_CRC16_ENABLE)
 #define CO_CONFIG_FIFO (CO_CONFIG_FIFO_ENABLE | CO_CONFIG_FIFO_ALT_READ | CO_CONFIG_FIFO_CRC16_CCITT)
 
+/* Transmit buffers appended to txArray for the bus load generator
+ * (can_loadgen.c), 0 disables it. They are the last ones in txArray. */
+#ifndef CO_CONFIG_LOADGEN_TX_CNT
+#define CO_CONFIG_LOADGEN_TX_CNT 16
+#endif
+
+/* Event driven processing (CANopen_LSS.c): modules report their next deadline
+ * in timerNext_us and wake the processing tasks from the CAN RX task with
+ * their callbackPre. 0 falls back to fixed period polling. */
+#ifndef CO_CONFIG_TICKLESS
+#define CO_CONFIG_TICKLESS 1
+#endif
+#if CO_CONFIG_TICKLESS
+#define CO_CONFIG_GLOBAL_FLAG_CALLBACK_PRE CO_CONFIG_FLAG_CALLBACK_PRE
+#define CO_CONFIG_GLOBAL_RT_FLAG_CALLBACK_PRE CO_CONFIG_FLAG_CALLBACK_PRE
+#define CO_CONFIG_GLOBAL_FLAG_TIMERNEXT CO_CONFIG_FLAG_TIMERNEXT
+#endif
+
+/* CANopen objects (CANopen.c, CO_new) are static arrays sized from OD_CNT_*
+ * of OD.h instead of about 25 heap allocations. Sizes appear in the map file
+ * as COO_* symbols, total is printed after the build (co_footprint.cmake).
+ * 0 allocates them from heap. */
+#ifndef CO_CONFIG_STATIC_OBJECTS
+#define CO_CONFIG_STATIC_OBJECTS 1
+#endif
+#if CO_CONFIG_STATIC_OBJECTS && !defined CO_USE_GLOBALS
+#define CO_USE_GLOBALS
+#endif
+
+/* Execution time statistics of the CO_process() stages and PDO processing,
+ * CPU share and stack of the CANopen tasks (co_profiler.c, OD 0x210D).
+ * 0 removes the measurements from the code. */
+#ifndef CO_CONFIG_PROFILER
+#define CO_CONFIG_PROFILER 1
+#endif
+
 #ifdef CO_DRIVER_CUSTOM
 #include "CO_driver_custom.h"
 #endif
@@ -71,10 +108,205 @@ typedef uint_fast8_t bool_t;
 typedef float float32_t;
 typedef double float64_t;
 
+/* Words of the fast receive lane COB-ID bitmap, one bit per 11-bit identifier */
+#define CO_CAN_RX_FAST_IDENT_WORDS (0x800U / 32U)
+
+/* Received CAN message, as passed to CANrx_callback. TWAI message must be
+ * the first member, so macros below may cast to twai_message_t. */
+typedef struct
+{
+    twai_message_t msg;
+    int64_t timestamp_us; /* esp_timer_get_time() right after twai_receive() */
+} CO_CANrxMsg_t;
+
 /* Access to received CAN message */
 #define CO_CANrxMsg_readIdent(msg) ((uint16_t)(((twai_message_t *)msg)->identifier))
 #define CO_CANrxMsg_readDLC(msg) ((uint8_t)(((twai_message_t *)msg)->data_length_code))
 #define CO_CANrxMsg_readData(msg) ((uint8_t *)&(((twai_message_t *)msg)->data[0]))
+#define CO_CANrxMsg_readTimestamp(msg) (((CO_CANrxMsg_t *)msg)->timestamp_us)
+
+/* Priority class of a frame by its COB-ID function code */
+typedef enum
+{
+    CO_CAN_CLASS_NMT_SYNC_EMCY = 0, /* 0x000..0x17F: NMT, SYNC, EMCY, TIME */
+    CO_CAN_CLASS_PDO,               /* 0x180..0x57F */
+    CO_CAN_CLASS_SDO,               /* 0x580..0x6FF */
+    CO_CAN_CLASS_ERRCTRL,           /* 0x700..0x7FF: heartbeat, node guarding, LSS */
+    CO_CAN_CLASS_COUNT
+} CO_CANclass_t;
+
+#define CO_CAN_CLASS_OF(ident) \
+    (((ident) & 0x7FFU) < 0x180U ? CO_CAN_CLASS_NMT_SYNC_EMCY : \
+     ((ident) & 0x7FFU) < 0x580U ? CO_CAN_CLASS_PDO :           \
+     ((ident) & 0x7FFU) < 0x700U ? CO_CAN_CLASS_SDO : CO_CAN_CLASS_ERRCTRL)
+
+/* Transmit delay (CO_CANsend() to TX completion alert) of one class */
+typedef struct
+{
+    uint32_t frames;
+    uint32_t lastDelay_us;
+    uint32_t maxDelay_us;
+    uint64_t sumDelay_us; /* average = sumDelay_us / frames */
+} CO_CANtxDelay_t;
+
+/* Length of the error counter history in CO_CANtrafficStats_t, in seconds */
+#define CO_CAN_ERRHIST_LEN 8U
+
+/* Estimated length of a standard data frame on the bus, without stuff bits */
+#define CO_CAN_FRAME_BITS(DLC) (47U + (8U * (uint32_t)(DLC)))
+
+/* Bus traffic statistics. Each counter has a single writer (RX task, TX task
+ * or CO_CANmodule_process()), so no locking is needed. Rates and history are
+ * updated once per second. Layout is read as one block from OD 0x2101, all
+ * values are little endian, 92 bytes. */
+typedef struct
+{
+    uint32_t rxFrames[CO_CAN_CLASS_COUNT];  /* received frames, total */
+    uint32_t txFrames[CO_CAN_CLASS_COUNT];  /* transmitted frames, total */
+    uint32_t txFailed;                      /* twai_transmit() errors */
+    uint32_t rxOverrun;                     /* TWAI RX FIFO overruns */
+    uint32_t rxMissed;                      /* frames lost, driver RX queue full */
+    uint32_t rxBits;                        /* estimated bits of received frames, total */
+    uint32_t txBits;                        /* estimated bits of transmitted frames, total */
+    uint32_t seconds;                       /* statistic windows elapsed */
+    uint16_t rxPerSec[CO_CAN_CLASS_COUNT];  /* received frames in the last second */
+    uint16_t txPerSec[CO_CAN_CLASS_COUNT];  /* transmitted frames in the last second */
+    uint16_t busLoad_permille;              /* bus load seen by this node in the last second */
+    uint8_t historyIndex;                   /* next slot in tecHistory and recHistory */
+    uint8_t reserved;
+    uint8_t tecHistory[CO_CAN_ERRHIST_LEN]; /* highest TX error counter of each second */
+    uint8_t recHistory[CO_CAN_ERRHIST_LEN]; /* highest RX error counter of each second */
+} CO_CANtrafficStats_t;
+
+/* Receive lanes, in order of dispatch priority. Each lane has its own part of
+ * the RX task queue (DRV_RX_LANE_xx_LEN in CO_driver.c), so a flood in a
+ * lower lane never takes capacity of the high lane. */
+typedef enum
+{
+    CO_CAN_RX_LANE_HIGH = 0, /* NMT, SYNC, EMCY, TIME */
+    CO_CAN_RX_LANE_FAST,     /* PDO class by default, set with CO_CANmodule_setRxFast() */
+    CO_CAN_RX_LANE_NORMAL,   /* all other frames */
+    CO_CAN_RX_LANE_COUNT
+} CO_CANrxLane_t;
+
+/* Queue statistics of one receive lane */
+typedef struct
+{
+    uint32_t dropped;   /* frames lost, lane was full */
+    uint16_t highWater; /* most frames waiting in the lane */
+} CO_CANrxLaneStats_t;
+
+/* Receive latency (twai_receive() to return of CANrx_callback) of one lane.
+ * Time in the TWAI ISR and the driver queue is not included, the legacy
+ * driver gives no receive timestamp. Exported in OD 0x210F. */
+typedef struct
+{
+    uint32_t frames;
+    uint32_t lastLatency_us;
+    uint32_t maxLatency_us;
+    uint64_t sumLatency_us; /* average = sumLatency_us / frames */
+} CO_CANrxLatency_t;
+
+/* Synchronous TPDOs: SYNC reception to end of transmission on the bus (TX
+ * completion alert), and frames removed at the end of the synchronous window */
+typedef struct
+{
+    uint32_t frames;         /* transmitted synchronous TPDOs */
+    uint32_t lastLatency_us;
+    uint32_t maxLatency_us;
+    uint64_t sumLatency_us;  /* average = sumLatency_us / frames */
+    uint32_t aborted;        /* transmission aborted in the controller */
+    uint32_t dropped;        /* removed from TX queue before reaching the controller */
+} CO_CANsyncTxStats_t;
+
+/* Synchronous TPDO processing: SYNC reception to the first synchronous TPDO
+ * queued by CO_CANsend() in the same SYNC period. Jitter is the smoothed
+ * absolute difference of consecutive latencies (gain 1/16, as RFC 3550). */
+typedef struct
+{
+    uint32_t cycles;         /* SYNC periods with a synchronous TPDO */
+    uint32_t lastLatency_us;
+    uint32_t minLatency_us;
+    uint32_t maxLatency_us;
+    uint64_t sumLatency_us;  /* average = sumLatency_us / cycles */
+    uint32_t jitter16_us;    /* jitter = jitter16_us / 16 */
+    uint32_t lastSyncRx_us;  /* SYNC of the last counted period */
+} CO_CANsyncQueueStats_t;
+
+/* Frames with lifetime (CO_CANtx_t.lifetime_us), which were not sent */
+typedef struct
+{
+    uint32_t expired[CO_CAN_CLASS_COUNT];  /* dropped by TX task, older than lifetime */
+    uint32_t replaced[CO_CAN_CLASS_COUNT]; /* overwritten in the queue by a newer CO_CANsend() */
+} CO_CANtxStaleStats_t;
+
+/* Delay before bus-off recovery is started */
+typedef enum
+{
+    CO_CAN_BUSOFF_BACKOFF_IMMEDIATE = 0,   /* recover right away */
+    CO_CAN_BUSOFF_BACKOFF_EXPONENTIAL = 1, /* initialDelay_ms, doubled on each consecutive bus-off */
+    CO_CAN_BUSOFF_BACKOFF_CAPPED = 2       /* as exponential, but not longer than maxDelay_ms */
+} CO_CANbusOffBackoff_t;
+
+typedef enum
+{
+    CO_CAN_BUSOFF_IDLE = 0,   /* controller running */
+    CO_CAN_BUSOFF_WAIT,       /* bus-off, waiting for the backoff delay */
+    CO_CAN_BUSOFF_RECOVERING  /* twai_initiate_recovery() called, waiting for 128 x 11 recessive bits */
+} CO_CANbusOffState_t;
+
+/* Bus-off recovery, configuration and statistics */
+typedef struct
+{
+    uint8_t backoff;           /* CO_CANbusOffBackoff_t */
+    uint16_t initialDelay_ms;
+    uint16_t maxDelay_ms;
+    uint8_t state;             /* CO_CANbusOffState_t */
+    uint8_t consecutive;       /* bus-off events without stable bus between them */
+    int64_t busOffAt_us;
+    int64_t restartAt_us;
+    int64_t runningSince_us;
+    uint32_t recoveryCount;
+    uint32_t lastDowntime_ms;  /* bus-off to twai_start() of the last incident */
+    uint32_t maxDowntime_ms;
+    uint32_t totalDowntime_ms;
+} CO_CANbusOff_t;
+
+/* Warm bit rate switch, CiA 305 "activate bit timing" */
+typedef enum
+{
+    CO_CAN_BITRATE_SWITCH_IDLE = 0, /* no switch in progress */
+    CO_CAN_BITRATE_SWITCH_SILENT,   /* first switch delay, old rate, no transmission */
+    CO_CAN_BITRATE_SWITCH_SETTLE    /* second switch delay, new rate, no transmission */
+} CO_CANbitRateSwitchState_t;
+
+/* Bit rate switch in progress and measurements of the last one, see
+ * CO_CANmodule_switchBitRate() */
+typedef struct
+{
+    volatile uint8_t state;    /* CO_CANbitRateSwitchState_t */
+    uint16_t newBitRate;
+    uint16_t delay_ms;
+    int64_t requestedAt_us;
+    uint32_t switchCount;
+    uint32_t failedCount;      /* controller was not running or its TX was busy at the switch time */
+    uint32_t lastOffline_us;   /* controller restart at the new rate, TX abort included */
+    uint32_t lastSilent_us;    /* request to release of transmission, 2 x delay_ms */
+} CO_CANbitRateSwitch_t;
+
+/* Token bucket, which limits the share of bus time used by bulk transmit
+ * classes (SDO by default). Other classes are never delayed by it. Owned by
+ * the TX task, configuration is set with CO_CANmodule_setTxShaper(). */
+typedef struct
+{
+    uint8_t bulkClasses;     /* (1 << CO_CANclass_t) of shaped classes */
+    uint16_t share_permille; /* bus time for bulk classes, 1000 = not limited */
+    uint16_t burstFrames;    /* bucket depth in 8-byte frames */
+    int64_t lastRefill_us;
+    uint32_t tokens_mbit;    /* available bus time in 1/1000 bit */
+    uint32_t deferred;       /* times a bulk frame had to wait for tokens */
+    uint32_t shapedFrames;   /* bulk frames sent */
+} CO_CANtxShaper_t;
 
 /* Received message object */
 typedef struct
@@ -93,6 +325,8 @@ typedef struct
     uint8_t data[8];
     volatile bool_t bufferFull;
     volatile bool_t syncFlag;
+    uint32_t queuedAt_us; /* time of CO_CANsend(), lower 32 bits of esp_timer */
+    uint32_t lifetime_us; /* 0 = no deadline. Older frame is dropped, not sent; newer one replaces it. */
 } CO_CANtx_t;
 
 /* CAN module object */
@@ -103,15 +337,54 @@ typedef struct
     uint16_t rxSize;
     CO_CANtx_t *txArray;
     uint16_t txSize;
+    uint16_t CANbitRate;
     uint16_t CANerrorStatus;
     volatile bool_t CANnormal;
     volatile bool_t useCANrxFilters;
-    volatile bool_t bufferInhibitFlag;
+    volatile bool_t bufferInhibitFlag; /* synchronous TPDO is in the controller */
     volatile bool_t firstCANtxMessage;
     volatile uint16_t CANtxCount;
     uint32_t errOld;
-    StaticSemaphore_t xMutexCanSendBuf;
-    SemaphoreHandle_t xMutexCanSendHdl;
+    volatile bool_t rxFilterDirty;  /* rxArray changed, hardware filter must be rebuilt */
+    int64_t rxFilterChanged_us;     /* last change of rxArray, runtime rebuild waits until it settles */
+    uint16_t rxFilterAcceptedIds;   /* 11-bit identifiers passed by the hardware filter */
+    twai_filter_config_t rxFilterConfig; /* filter in the controller, restart is skipped if it does not change */
+    uint32_t rxFilterLeakCount;     /* received frames, which matched no rxArray entry */
+    CO_CANtxDelay_t txDelay[CO_CAN_CLASS_COUNT];
+    CO_CANtxDelay_t txDelayLoadGen; /* frames of the CO_CONFIG_LOADGEN_TX_CNT buffers only */
+    CO_CANtxStaleStats_t txStale;
+    volatile bool_t txWakePending;  /* TX task was notified and did not drain the queue yet */
+    uint32_t sendLatencyMax_us;     /* worst case duration of CO_CANsend(), OD 0x210E */
+    uint16_t rxBatchLast;           /* frames taken by the first drain of the last RX task wakeup */
+    uint16_t rxBatchMax;            /* most frames taken by the first drain of one wakeup, <= DRV_RX_BATCH_MAX */
+    uint16_t rxQueueHighWater;      /* most frames waiting in TWAI RX queue */
+    volatile uint8_t rxFastClasses; /* (1 << CO_CANclass_t) of classes in the fast receive lane */
+    volatile uint32_t rxFastIdents[CO_CAN_RX_FAST_IDENT_WORDS]; /* COB-IDs in the fast receive lane */
+    CO_CANrxLatency_t rxLatency[CO_CAN_RX_LANE_COUNT];
+    CO_CANrxLaneStats_t rxLaneStats[CO_CAN_RX_LANE_COUNT];
+    CO_CANtrafficStats_t traffic;
+    uint16_t syncIdent;             /* CAN-ID of SYNC, 0x080 by default */
+    volatile uint32_t syncRx_us;    /* reception of the last SYNC, lower 32 bits of esp_timer */
+    volatile uint32_t nmtRx_us;     /* reception of the last NMT command, lower 32 bits of esp_timer */
+    volatile uint32_t firstTx_us;   /* first frame handed to the controller after CO_CANmodule_init() (bootup), 0 = none yet */
+    CO_CANsyncTxStats_t syncTx;
+    CO_CANsyncQueueStats_t syncQueue;
+    CO_CANbusOff_t busOff;
+    CO_CANtxShaper_t txShaper;
+    CO_CANbitRateSwitch_t bitRateSwitch;
+    CO_CANcapture_t capture;        /* zeroed by CO_new(), kept over communication reset */
+    volatile bool_t txHold;         /* controller is not running, TX task keeps messages queued */
+    volatile bool_t busOffRecovered; /* controller restarted, bootup not queued yet */
+    volatile bool_t listenOnly;     /* controller does not transmit or acknowledge, TX task keeps messages queued */
+    void *functSignalObjectListen;
+    void (*pFunctListen)(void *object, const CO_CANrxMsg_t *rcvMsg); /* takes received frames in listen-only mode */
+    void *functSignalObjectBusOff;
+    void (*pFunctSignalBusOff)(void *object); /* called after bus-off recovery */
+    void *functSignalObjectStatus;
+    void (*pFunctSignalStatus)(void *object); /* called from alert task when CANerrorStatus changes */
+    portMUX_TYPE txLock;            /* protects txArray flags and TX queue */
+    StaticSemaphore_t xMutexTwaiBuf;
+    SemaphoreHandle_t xMutexTwaiHdl; /* serializes twai_transmit() with controller reconfiguration */
     StaticSemaphore_t xMutexEmcyBuf;
     SemaphoreHandle_t xMutexEmcyHdl;
     StaticSemaphore_t xMutexODBuf;
@@ -129,9 +402,148 @@ typedef struct
     void *addrNV;
 } CO_storage_entry_t;
 
-/* (un)lock critical section in CO_CANsend() */
-#define CO_LOCK_CAN_SEND(CAN_MODULE) (xSemaphoreTakeRecursive(CAN_MODULE->xMutexCanSendHdl, portMAX_DELAY))
-#define CO_UNLOCK_CAN_SEND(CAN_MODULE) (xSemaphoreGiveRecursive(CAN_MODULE->xMutexCanSendHdl))
+/**
+ * Initialize bus-off recovered callback function.
+ *
+ * Function is called from CO_CANmodule_process() after controller was
+ * restarted and before queued messages are sent again, so application can
+ * announce itself with the bootup message. Call after CO_CANinit().
+ *
+ * @param CANmodule This object.
+ * @param object Pointer to object, which will be passed to pFunctSignal(). Can be NULL.
+ * @param pFunctSignal Pointer to the callback function. Not called if NULL.
+ */
+void CO_CANmodule_initCallbackBusOff(CO_CANmodule_t *CANmodule, void *object, void (*pFunctSignal)(void *object));
+
+/**
+ * Initialize CAN error status changed callback function.
+ *
+ * CANerrorStatus is updated by the driver's alert task as soon as the TWAI
+ * driver reports bus errors, error passive, bus-off or RX overflow. Function
+ * is called from that task, when CANerrorStatus changed, so the CANopen main
+ * task can be woken to run CO_process() (emergency). It must be short and must
+ * not block. Call after CO_CANinit().
+ *
+ * @param CANmodule This object.
+ * @param object Pointer to object, which will be passed to pFunctSignal(). Can be NULL.
+ * @param pFunctSignal Pointer to the callback function. Not called if NULL.
+ */
+void CO_CANmodule_initCallbackStatus(CO_CANmodule_t *CANmodule, void *object, void (*pFunctSignal)(void *object));
+
+/**
+ * Configure transmit traffic shaper.
+ *
+ * Frames of bulk classes may use at most share_permille of the bus time, with
+ * bursts up to burstFrames frames. When a bulk frame has to wait, frames of
+ * other classes are sent before it, regardless of CAN-ID. Defaults are set by
+ * CO_CANmodule_init(), call after it.
+ *
+ * @param CANmodule This object.
+ * @param bulkClasses Bitmask of shaped classes, (1 << CO_CANclass_t).
+ * @param share_permille Bus time for bulk classes, 1..1000. 1000 disables shaping.
+ * @param burstFrames Bucket depth in 8-byte frames, minimum 1.
+ *
+ * @return false, if values are out of range.
+ */
+bool_t CO_CANmodule_setTxShaper(CO_CANmodule_t *CANmodule, uint8_t bulkClasses, uint16_t share_permille,
+                                uint16_t burstFrames);
+
+/**
+ * Select frames of the fast receive lane.
+ *
+ * NMT, SYNC, EMCY and TIME always go to the high lane. A frame of another
+ * class goes to the fast lane, if its class is in fastClasses or its COB-ID is
+ * in idents, all other frames go to the normal lane. Defaults are set by
+ * CO_CANmodule_init() (PDO class, no COB-IDs), call after it. May be called at
+ * any time, frames received while the set changes may go to either lane.
+ *
+ * @param CANmodule This object.
+ * @param fastClasses Bitmask of classes, (1 << CO_CANclass_t).
+ * @param idents 11-bit COB-IDs, may be NULL if identCount is 0.
+ * @param identCount Number of COB-IDs in idents.
+ *
+ * @return false, if values are out of range.
+ */
+bool_t CO_CANmodule_setRxFast(CO_CANmodule_t *CANmodule, uint8_t fastClasses, const uint16_t *idents,
+                              uint16_t identCount);
+
+/**
+ * Switch controller to listen-only mode (bus analyzer) and back.
+ *
+ * In listen-only mode the controller neither transmits nor acknowledges, the
+ * acceptance filter is open and every received frame is passed to
+ * pFunctFrame() from the RX task, instead of to the CANopen objects. Messages
+ * sent by CANopen objects stay queued. Bit timing, filter and mode are all
+ * written in reset mode, so the controller is never in normal mode at a
+ * listen-only rate. TWAI driver, tasks and mutexes are kept. Frames still in
+ * the controller are aborted. Mode is lost, when the driver is reinstalled.
+ *
+ * @param CANmodule This object.
+ * @param bitRate_kbps Bit rate in listen-only mode, entry of baudrate_config.
+ * 0 for CANbitRate. Ignored when leaving listen-only mode.
+ * @param object Pointer to object, which will be passed to pFunctFrame(). Can be NULL.
+ * @param pFunctFrame Called for each received frame. NULL returns to normal
+ * mode at CANbitRate with the filter built from rxArray.
+ *
+ * @return false, if bit rate is unknown, controller is not running (bus-off)
+ * or its TX could not be aborted.
+ */
+bool_t CO_CANmodule_setListenOnly(CO_CANmodule_t *CANmodule, uint16_t bitRate_kbps, void *object,
+                                  void (*pFunctFrame)(void *object, const CO_CANrxMsg_t *rcvMsg));
+
+/**
+ * Detect bit rate of the bus.
+ *
+ * Each entry of baudrate_config is tried in listen-only mode, so the node
+ * never disturbs the bus. A rate is taken as soon as it receives a few valid
+ * frames without bus errors. If none is locked before timeout, rates are
+ * ranked by valid frames minus bus errors. Blocks the calling task. Controller
+ * returns to normal mode at CANbitRate. Call after CO_CANinit(), before
+ * CANopen objects start transmitting.
+ *
+ * @param CANmodule This object.
+ * @param firstKbps Rate tried first, usually the configured one.
+ * @param timeout_ms Time limit, each candidate is heard for 250 ms.
+ *
+ * @return Detected bit rate in kbit/s, 0 if no valid frame was received or
+ * the controller could not be switched to listen-only mode.
+ */
+uint16_t CO_CANmodule_detectBitRate(CO_CANmodule_t *CANmodule, uint16_t firstKbps, uint32_t timeout_ms);
+
+/**
+ * Check if bit rate is supported by the driver (entry of baudrate_config).
+ *
+ * @param bitRate_kbps Bit rate in kbit/s.
+ *
+ * @return true, if supported.
+ */
+bool_t CO_CANbitRateSupported(uint16_t bitRate_kbps);
+
+/**
+ * Switch bit rate without reinstalling the TWAI driver.
+ *
+ * Sequence of CiA 305 "activate bit timing": transmission stops immediately,
+ * after delay_ms controller is reconfigured in reset mode at the new rate,
+ * after another delay_ms transmission is released. Messages sent meanwhile
+ * stay queued. Timing is done by esp_timer, so the function returns
+ * immediately and may be called from the CO_LSSslave activate bit timing
+ * callback. Driver, tasks and mutexes are kept, controller is offline only
+ * for the register writes. Frames in the controller at the switch time are
+ * aborted. Listen-only mode is kept.
+ *
+ * @param CANmodule This object.
+ * @param bitRate_kbps New bit rate, entry of baudrate_config.
+ * @param delay_ms Switch delay in ms.
+ *
+ * @return false, if bit rate is unknown or another switch is in progress.
+ */
+bool_t CO_CANmodule_switchBitRate(CO_CANmodule_t *CANmodule, uint16_t bitRate_kbps, uint16_t delay_ms);
+
+/* (un)lock critical section in CO_CANsend(). It only protects buffer flags
+ * and the TX queue, so short spinlock is used. twai_transmit() is called by
+ * the TX task outside of it. */
+#define CO_LOCK_CAN_SEND(CAN_MODULE) portENTER_CRITICAL_SAFE(&(CAN_MODULE)->txLock)
+#define CO_UNLOCK_CAN_SEND(CAN_MODULE) portEXIT_CRITICAL_SAFE(&(CAN_MODULE)->txLock)
 
 /* (un)lock critical section in CO_errorReport() or CO_errorReset() */
 #define CO_LOCK_EMCY(CAN_MODULE) (xSemaphoreTakeRecursive(CAN_MODULE->xMutexEmcyHdl, portMAX_DELAY))
@@ -158,7 +570,7 @@ typedef struct
 /* Stack configuration override default values.
  * For more information see file CO_config.h. */
 #if CONFIG_CO_LED_ENABLE
-#define CO_CONFIG_LEDS CO_CONFIG_LEDS_ENABLE
+#define CO_CONFIG_LEDS (CO_CONFIG_LEDS_ENABLE | CO_CONFIG_GLOBAL_FLAG_TIMERNEXT)
 #else
 #define CO_CONFIG_LEDS 0
 #endif
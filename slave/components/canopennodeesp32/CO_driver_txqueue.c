@@ -0,0 +1,213 @@
+/*
+ * CAN-ID priority ordered transmit queue for CANopenNode drivers.
+ *
+ * @file        CO_driver_txqueue.c
+ * @ingroup     CO_driver
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <string.h>
+
+#include "CO_driver_txqueue.h"
+
+#define BIT_WORD(rank) ((rank) >> 5)
+#define BIT_MASK(rank) (1UL << ((rank) & 31U))
+
+static bool txQueue_testBit(const uint32_t *bitmap, uint16_t rank)
+{
+    return (bitmap[BIT_WORD(rank)] & BIT_MASK(rank)) != 0U;
+}
+
+static void txQueue_setBit(uint32_t *bitmap, uint16_t rank)
+{
+    bitmap[BIT_WORD(rank)] |= BIT_MASK(rank);
+}
+
+static void txQueue_clearBit(uint32_t *bitmap, uint16_t rank)
+{
+    bitmap[BIT_WORD(rank)] &= ~BIT_MASK(rank);
+}
+
+/* Lowest set bit in the bitmap */
+static uint16_t txQueue_first(const uint32_t *bitmap)
+{
+    uint16_t w;
+
+    for (w = 0U; w < CO_CAN_TXQUEUE_WORDS; w++)
+    {
+        if (bitmap[w] != 0U)
+        {
+            return (uint16_t)((w << 5) + (uint16_t)__builtin_ctz(bitmap[w]));
+        }
+    }
+    return CO_CAN_TXQUEUE_NONE;
+}
+
+/* Priority order: lower identifier first, lower txArray index on equal identifier */
+static bool txQueue_before(const CO_CANtxQueue_t *txQueue, uint16_t a, uint16_t b)
+{
+    return (txQueue->ident[a] < txQueue->ident[b]) || ((txQueue->ident[a] == txQueue->ident[b]) && (a < b));
+}
+
+/******************************************************************************/
+bool CO_CANtxQueue_init(CO_CANtxQueue_t *txQueue, uint16_t txSize)
+{
+    uint16_t i;
+
+    if (txSize > CO_CAN_TXQUEUE_MAX)
+    {
+        return false;
+    }
+
+    memset(txQueue, 0, sizeof(*txQueue));
+    txQueue->size = txSize;
+    for (i = 0U; i < txSize; i++)
+    {
+        txQueue->rank[i] = (uint8_t)i;
+        txQueue->index[i] = (uint8_t)i;
+    }
+    return true;
+}
+
+/******************************************************************************/
+void CO_CANtxQueue_setIdent(CO_CANtxQueue_t *txQueue, uint16_t index, uint16_t ident)
+{
+    bool pending[CO_CAN_TXQUEUE_MAX];
+    bool pendingSync[CO_CAN_TXQUEUE_MAX];
+    uint16_t r, pos;
+
+    if ((index >= txQueue->size) || (txQueue->ident[index] == ident))
+    {
+        return;
+    }
+
+    /* remember pending state by txArray index */
+    for (r = 0U; r < txQueue->size; r++)
+    {
+        pending[txQueue->index[r]] = txQueue_testBit(txQueue->pending, r);
+        pendingSync[txQueue->index[r]] = txQueue_testBit(txQueue->pendingSync, r);
+    }
+
+    /* take index out of the priority order and insert it on the new place */
+    for (r = txQueue->rank[index]; (r + 1U) < txQueue->size; r++)
+    {
+        txQueue->index[r] = txQueue->index[r + 1U];
+    }
+    txQueue->ident[index] = ident;
+    for (pos = 0U; (pos + 1U) < txQueue->size; pos++)
+    {
+        if (txQueue_before(txQueue, index, txQueue->index[pos]))
+        {
+            break;
+        }
+    }
+    for (r = txQueue->size - 1U; r > pos; r--)
+    {
+        txQueue->index[r] = txQueue->index[r - 1U];
+    }
+    txQueue->index[pos] = (uint8_t)index;
+
+    /* rebuild ranks and bitmaps */
+    memset(txQueue->pending, 0, sizeof(txQueue->pending));
+    memset(txQueue->pendingSync, 0, sizeof(txQueue->pendingSync));
+    for (r = 0U; r < txQueue->size; r++)
+    {
+        uint16_t i = txQueue->index[r];
+
+        txQueue->rank[i] = (uint8_t)r;
+        if (pending[i])
+        {
+            txQueue_setBit(txQueue->pending, r);
+        }
+        if (pendingSync[i])
+        {
+            txQueue_setBit(txQueue->pendingSync, r);
+        }
+    }
+}
+
+/******************************************************************************/
+void CO_CANtxQueue_push(CO_CANtxQueue_t *txQueue, uint16_t index, bool syncFlag)
+{
+    uint16_t r = txQueue->rank[index];
+
+    txQueue_setBit(txQueue->pending, r);
+    if (syncFlag)
+    {
+        txQueue_setBit(txQueue->pendingSync, r);
+    }
+}
+
+/******************************************************************************/
+void CO_CANtxQueue_remove(CO_CANtxQueue_t *txQueue, uint16_t index)
+{
+    uint16_t r = txQueue->rank[index];
+
+    txQueue_clearBit(txQueue->pending, r);
+    txQueue_clearBit(txQueue->pendingSync, r);
+}
+
+/******************************************************************************/
+uint16_t CO_CANtxQueue_peek(const CO_CANtxQueue_t *txQueue)
+{
+    uint16_t r = txQueue_first(txQueue->pending);
+
+    return (r != CO_CAN_TXQUEUE_NONE) ? txQueue->index[r] : CO_CAN_TXQUEUE_NONE;
+}
+
+/******************************************************************************/
+void CO_CANtxQueue_setShaped(CO_CANtxQueue_t *txQueue, uint16_t index, bool shaped)
+{
+    if (index < txQueue->size)
+    {
+        txQueue->shaped[index] = shaped;
+    }
+}
+
+/******************************************************************************/
+uint16_t CO_CANtxQueue_peekUnshaped(const CO_CANtxQueue_t *txQueue)
+{
+    uint16_t w;
+
+    for (w = 0U; w < CO_CAN_TXQUEUE_WORDS; w++)
+    {
+        uint32_t bits = txQueue->pending[w];
+
+        while (bits != 0U)
+        {
+            uint16_t r = (uint16_t)((w << 5) + (uint16_t)__builtin_ctz(bits));
+
+            if (!txQueue->shaped[txQueue->index[r]])
+            {
+                return txQueue->index[r];
+            }
+            bits &= bits - 1U;
+        }
+    }
+    return CO_CAN_TXQUEUE_NONE;
+}
+
+/******************************************************************************/
+uint16_t CO_CANtxQueue_popSync(CO_CANtxQueue_t *txQueue)
+{
+    uint16_t r = txQueue_first(txQueue->pendingSync);
+
+    if (r == CO_CAN_TXQUEUE_NONE)
+    {
+        return CO_CAN_TXQUEUE_NONE;
+    }
+    txQueue_clearBit(txQueue->pending, r);
+    txQueue_clearBit(txQueue->pendingSync, r);
+    return txQueue->index[r];
+}
@@ -0,0 +1,156 @@
+/*
+ * CAN-ID priority ordered transmit queue for CANopenNode drivers.
+ *
+ * @file        CO_driver_txqueue.h
+ * @ingroup     CO_driver
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_DRIVER_TXQUEUE_H
+#define CO_DRIVER_TXQUEUE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/* Maximum number of transmit buffers handled by the queue */
+#ifndef CO_CAN_TXQUEUE_MAX
+#define CO_CAN_TXQUEUE_MAX 64U
+#endif
+
+#define CO_CAN_TXQUEUE_WORDS ((CO_CAN_TXQUEUE_MAX + 31U) / 32U)
+#define CO_CAN_TXQUEUE_NONE 0xFFFFU
+
+/**
+ * Transmit queue.
+ *
+ * Pending txArray buffers are kept in a bitmap, ordered by CAN identifier
+ * (bus arbitration priority), so the highest priority buffer is found with a
+ * few "count trailing zeros" operations. Synchronous buffers are kept in a
+ * separate bitmap, so they can be removed in time proportional to their
+ * number.
+ */
+typedef struct
+{
+    uint32_t pending[CO_CAN_TXQUEUE_WORDS];     /**< Pending buffers, bit = priority rank */
+    uint32_t pendingSync[CO_CAN_TXQUEUE_WORDS]; /**< Pending synchronous buffers, bit = priority rank */
+    uint16_t ident[CO_CAN_TXQUEUE_MAX];         /**< CAN identifier of each txArray index */
+    uint8_t rank[CO_CAN_TXQUEUE_MAX];           /**< Priority rank of each txArray index */
+    uint8_t index[CO_CAN_TXQUEUE_MAX];          /**< txArray index of each priority rank */
+    bool shaped[CO_CAN_TXQUEUE_MAX];            /**< txArray index is limited by the traffic shaper */
+    uint16_t size;                              /**< Number of txArray buffers */
+} CO_CANtxQueue_t;
+
+/**
+ * Initialize empty queue.
+ *
+ * @param txQueue This object.
+ * @param txSize Number of txArray buffers, maximum CO_CAN_TXQUEUE_MAX.
+ *
+ * @return false, if txSize is too large.
+ */
+bool CO_CANtxQueue_init(CO_CANtxQueue_t *txQueue, uint16_t txSize);
+
+/**
+ * Set CAN identifier of txArray buffer and reorder the queue.
+ *
+ * Pending buffers stay pending. Call from CO_CANtxBufferInit().
+ *
+ * @param txQueue This object.
+ * @param index txArray index.
+ * @param ident CAN identifier, lower value has higher priority.
+ */
+void CO_CANtxQueue_setIdent(CO_CANtxQueue_t *txQueue, uint16_t index, uint16_t ident);
+
+/**
+ * Mark buffer as pending.
+ *
+ * @param txQueue This object.
+ * @param index txArray index.
+ * @param syncFlag Buffer is synchronous TPDO.
+ */
+void CO_CANtxQueue_push(CO_CANtxQueue_t *txQueue, uint16_t index, bool syncFlag);
+
+/**
+ * Remove buffer from the queue.
+ *
+ * @param txQueue This object.
+ * @param index txArray index.
+ */
+void CO_CANtxQueue_remove(CO_CANtxQueue_t *txQueue, uint16_t index);
+
+/**
+ * Get pending buffer with the highest priority (lowest CAN identifier).
+ *
+ * @param txQueue This object.
+ *
+ * @return txArray index or CO_CAN_TXQUEUE_NONE.
+ */
+uint16_t CO_CANtxQueue_peek(const CO_CANtxQueue_t *txQueue);
+
+/**
+ * Mark buffer as limited by the traffic shaper.
+ *
+ * Flag is kept, when CAN identifier changes.
+ *
+ * @param txQueue This object.
+ * @param index txArray index.
+ * @param shaped Buffer belongs to a shaped traffic class.
+ */
+void CO_CANtxQueue_setShaped(CO_CANtxQueue_t *txQueue, uint16_t index, bool shaped);
+
+/**
+ * Check, if buffer is limited by the traffic shaper.
+ *
+ * @param txQueue This object.
+ * @param index txArray index.
+ *
+ * @return true, if shaped.
+ */
+static inline bool CO_CANtxQueue_isShaped(const CO_CANtxQueue_t *txQueue, uint16_t index)
+{
+    return txQueue->shaped[index];
+}
+
+/**
+ * Get pending buffer with the highest priority, which is not shaped.
+ *
+ * Used, when the highest priority buffer must wait for the traffic shaper.
+ *
+ * @param txQueue This object.
+ *
+ * @return txArray index or CO_CAN_TXQUEUE_NONE.
+ */
+uint16_t CO_CANtxQueue_peekUnshaped(const CO_CANtxQueue_t *txQueue);
+
+/**
+ * Remove one pending synchronous buffer from the queue.
+ *
+ * Call repeatedly until CO_CAN_TXQUEUE_NONE is returned.
+ *
+ * @param txQueue This object.
+ *
+ * @return txArray index of removed buffer or CO_CAN_TXQUEUE_NONE.
+ */
+uint16_t CO_CANtxQueue_popSync(CO_CANtxQueue_t *txQueue);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CO_DRIVER_TXQUEUE_H */
@@ -225,6 +225,183 @@ OD_ATTR_RAM OD_RAM_t OD_RAM = {
     .x1F5C_runningFirmwareVersion = {
         .highestSub_indexSupported = 0x01,
         .runningVersion = 0x0000
+    },
+    .x2100_CANbusOffRecovery = {
+        .highestSub_indexSupported = 0x07,
+        .backoff = 0x02,
+        .initialDelay = 0x0064,
+        .maxDelay = 0x2710,
+        .recoveryCount = 0x00000000,
+        .lastDowntime = 0x00000000,
+        .maxDowntime = 0x00000000,
+        .totalDowntime = 0x00000000
+    },
+    .x2101_CANtrafficStatistics = {
+        .highestSub_indexSupported = 0x04,
+        .statistics = {0},
+        .rxFilterAcceptedIds = 0x0000,
+        .rxFilterRejectedIds = 0x0000,
+        .rxFilterLeakFrames = 0x00000000
+    },
+    .x2102_CANcapture = {
+        .highestSub_indexSupported = 0x08,
+        .control = 0x00,
+        .triggers = 0x06,
+        .triggerCobId = 0x0000,
+        .triggerCobMask = 0x07FF,
+        .postTrigger = 0x0080,
+        .records = 0x0000,
+        .recordCyclesMax = 0x00000000,
+        .data = 0x00
+    },
+    .x2103_CANrxLanes = {
+        .highestSub_indexSupported = 0x0A,
+        .highDropped = 0x00000000,
+        .fastDropped = 0x00000000,
+        .normalDropped = 0x00000000,
+        .highHighWater = 0x0000,
+        .fastHighWater = 0x0000,
+        .normalHighWater = 0x0000,
+        .driverLost = 0x00000000,
+        .batchLast = 0x0000,
+        .batchMax = 0x0000,
+        .driverQueueHighWater = 0x0000
+    },
+    .x2104_CANtxShaper = {
+        .highestSub_indexSupported = 0x07,
+        .bulkClasses = 0x04,
+        .bulkShare = 0x012C,
+        .burstFrames = 0x0002,
+        .deferred = 0x00000000,
+        .shapedFrames = 0x00000000,
+        .PDOtxDelayMax = 0x00000000,
+        .PDOtxDelayAverage = 0x00000000
+    },
+    .x2105_CANsyncTPDO = {
+        .highestSub_indexSupported = 0x06,
+        .frames = 0x00000000,
+        .lastLatency = 0x00000000,
+        .maxLatency = 0x00000000,
+        .averageLatency = 0x00000000,
+        .aborted = 0x00000000,
+        .dropped = 0x00000000
+    },
+    .x2106_CANtxFreshness = {
+        .highestSub_indexSupported = 0x03,
+        .enable = 0x01,
+        .expired = 0x00000000,
+        .replaced = 0x00000000
+    },
+    .x2107_CANanalyzer = {
+        .highestSub_indexSupported = 0x05,
+        .enable = 0x00,
+        .bitRate = 0x0000,
+        .framesStreamed = 0x00000000,
+        .framesLost = 0x00000000,
+        .queueHighWater = 0x0000
+    },
+    .x2108_CANloadGenerator = {
+        .highestSub_indexSupported = 0x12,
+        .enable = 0x00,
+        .cobIdFirst = 0x06E0,
+        .cobIdLast = 0x06EF,
+        .DLC = 0x08,
+        .framesPerSecond = 0x000003E8,
+        .burstFrames = 0x0001,
+        .framesQueued = 0x00000000,
+        .framesTransmitted = 0x00000000,
+        .achievedFramesPerSecond = 0x00000000,
+        .txOverflow = 0x00000000,
+        .queueLatencyAverage = 0x00000000,
+        .queueLatencyMax = 0x00000000,
+        .busLoad = 0x0000,
+        .txErrorCounter = 0x00,
+        .rxErrorCounter = 0x00,
+        .busErrors = 0x00000000,
+        .arbitrationLost = 0x00000000,
+        .txFailed = 0x00000000
+    },
+    .x2109_CANresetCommunication = {
+        .highestSub_indexSupported = 0x04,
+        .warm = 0x01,
+        .resets = 0x00000000,
+        .lastResetToBootup = 0x00000000,
+        .maxResetToBootup = 0x00000000
+    },
+    .x210A_CANsyncTPDOqueue = {
+        .highestSub_indexSupported = 0x06,
+        .cycles = 0x00000000,
+        .lastLatency = 0x00000000,
+        .minLatency = 0x00000000,
+        .maxLatency = 0x00000000,
+        .averageLatency = 0x00000000,
+        .jitter = 0x00000000
+    },
+    .x210B_COcycleTimer = {
+        .highestSub_indexSupported = 0x06,
+        .period = 0x00000000,
+        .cycles = 0x00000000,
+        .overruns = 0x00000000,
+        .lastTimeDifference = 0x00000000,
+        .maxTimeDifference = 0x00000000,
+        .maxRunTime = 0x00000000
+    },
+    .x210C_COmemoryFootprint = {
+        .highestSub_indexSupported = 0x12,
+        .total = 0x00000000,
+        .heap = 0x00000000,
+        .CO = 0x00000000,
+        .NMT = 0x00000000,
+        .HBcons = 0x00000000,
+        .EM = 0x00000000,
+        .SDOserver = 0x00000000,
+        .SDOclient = 0x00000000,
+        .TIME = 0x00000000,
+        .SYNC = 0x00000000,
+        .RPDO = 0x00000000,
+        .TPDO = 0x00000000,
+        .LEDs = 0x00000000,
+        .LSS = 0x00000000,
+        .other = 0x00000000,
+        .CANmodule = 0x00000000,
+        .CANrx = 0x00000000,
+        .CANtx = 0x00000000
+    },
+    .x210D_COprofiler = {
+        .highestSub_indexSupported = 0x02,
+        .control = 0x00,
+        .report = {0}
+    },
+    .x210E_CANsendLatency = {
+        .highestSub_indexSupported = 0x01,
+        .maxLatency = 0x00000000
+    },
+    .x210F_CANrxLatency = {
+        .highestSub_indexSupported = 0x0C,
+        .highFrames = 0x00000000,
+        .highLastLatency = 0x00000000,
+        .highMaxLatency = 0x00000000,
+        .highAverageLatency = 0x00000000,
+        .fastFrames = 0x00000000,
+        .fastLastLatency = 0x00000000,
+        .fastMaxLatency = 0x00000000,
+        .fastAverageLatency = 0x00000000,
+        .normalFrames = 0x00000000,
+        .normalLastLatency = 0x00000000,
+        .normalMaxLatency = 0x00000000,
+        .normalAverageLatency = 0x00000000
+    },
+    .x2110_CANrxFastLane = {
+        .highestSub_indexSupported = 0x09,
+        .fastClasses = 0x02,
+        .cobId1 = 0x0000,
+        .cobId2 = 0x0000,
+        .cobId3 = 0x0000,
+        .cobId4 = 0x0000,
+        .cobId5 = 0x0000,
+        .cobId6 = 0x0000,
+        .cobId7 = 0x0000,
+        .cobId8 = 0x0000
     }
 };
 
@@ -273,6 +450,23 @@ typedef struct {
     OD_obj_record_t o_1F5A_programStatus[2];
     OD_obj_record_t o_1F5B_runningFirmwareCrc[2];
     OD_obj_record_t o_1F5C_runningFirmwareVersion[2];
+    OD_obj_record_t o_2100_CANbusOffRecovery[8];
+    OD_obj_record_t o_2101_CANtrafficStatistics[5];
+    OD_obj_record_t o_2102_CANcapture[9];
+    OD_obj_record_t o_2103_CANrxLanes[11];
+    OD_obj_record_t o_2104_CANtxShaper[8];
+    OD_obj_record_t o_2105_CANsyncTPDO[7];
+    OD_obj_record_t o_2106_CANtxFreshness[4];
+    OD_obj_record_t o_2107_CANanalyzer[6];
+    OD_obj_record_t o_2108_CANloadGenerator[19];
+    OD_obj_record_t o_2109_CANresetCommunication[5];
+    OD_obj_record_t o_210A_CANsyncTPDOqueue[7];
+    OD_obj_record_t o_210B_COcycleTimer[7];
+    OD_obj_record_t o_210C_COmemoryFootprint[19];
+    OD_obj_record_t o_210D_COprofiler[3];
+    OD_obj_record_t o_210E_CANsendLatency[2];
+    OD_obj_record_t o_210F_CANrxLatency[13];
+    OD_obj_record_t o_2110_CANrxFastLane[10];
 } ODObjs_t;
 
 static CO_PROGMEM ODObjs_t ODObjs = {
@@ -1217,6 +1411,898 @@ static CO_PROGMEM ODObjs_t ODObjs = {
             .attribute = ODA_SDO_R | ODA_MB,
             .dataLength = sizeof(OD_RAM.x1F5C_runningFirmwareVersion.runningVersion)
         }
+    },
+    .o_2100_CANbusOffRecovery = {
+        {
+            .dataOrig = &OD_RAM.x2100_CANbusOffRecovery.highestSub_indexSupported,
+            .subIndex = 0,
+            .attribute = ODA_SDO_R,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x2100_CANbusOffRecovery.backoff,
+            .subIndex = 1,
+            .attribute = ODA_SDO_RW,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x2100_CANbusOffRecovery.initialDelay,
+            .subIndex = 2,
+            .attribute = ODA_SDO_RW | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2100_CANbusOffRecovery.maxDelay,
+            .subIndex = 3,
+            .attribute = ODA_SDO_RW | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2100_CANbusOffRecovery.recoveryCount,
+            .subIndex = 4,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2100_CANbusOffRecovery.lastDowntime,
+            .subIndex = 5,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2100_CANbusOffRecovery.maxDowntime,
+            .subIndex = 6,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2100_CANbusOffRecovery.totalDowntime,
+            .subIndex = 7,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        }
+    },
+    .o_2101_CANtrafficStatistics = {
+        {
+            .dataOrig = &OD_RAM.x2101_CANtrafficStatistics.highestSub_indexSupported,
+            .subIndex = 0,
+            .attribute = ODA_SDO_R,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x2101_CANtrafficStatistics.statistics[0],
+            .subIndex = 1,
+            .attribute = ODA_SDO_R,
+            .dataLength = sizeof(OD_RAM.x2101_CANtrafficStatistics.statistics)
+        },
+        {
+            .dataOrig = &OD_RAM.x2101_CANtrafficStatistics.rxFilterAcceptedIds,
+            .subIndex = 2,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2101_CANtrafficStatistics.rxFilterRejectedIds,
+            .subIndex = 3,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2101_CANtrafficStatistics.rxFilterLeakFrames,
+            .subIndex = 4,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        }
+    },
+    .o_2102_CANcapture = {
+        {
+            .dataOrig = &OD_RAM.x2102_CANcapture.highestSub_indexSupported,
+            .subIndex = 0,
+            .attribute = ODA_SDO_R,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x2102_CANcapture.control,
+            .subIndex = 1,
+            .attribute = ODA_SDO_RW,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x2102_CANcapture.triggers,
+            .subIndex = 2,
+            .attribute = ODA_SDO_RW,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x2102_CANcapture.triggerCobId,
+            .subIndex = 3,
+            .attribute = ODA_SDO_RW | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2102_CANcapture.triggerCobMask,
+            .subIndex = 4,
+            .attribute = ODA_SDO_RW | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2102_CANcapture.postTrigger,
+            .subIndex = 5,
+            .attribute = ODA_SDO_RW | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2102_CANcapture.records,
+            .subIndex = 6,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2102_CANcapture.recordCyclesMax,
+            .subIndex = 7,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2102_CANcapture.data,
+            .subIndex = 8,
+            .attribute = ODA_SDO_R,
+            .dataLength = 0
+        }
+    },
+    .o_2103_CANrxLanes = {
+        {
+            .dataOrig = &OD_RAM.x2103_CANrxLanes.highestSub_indexSupported,
+            .subIndex = 0,
+            .attribute = ODA_SDO_R,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x2103_CANrxLanes.highDropped,
+            .subIndex = 1,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2103_CANrxLanes.fastDropped,
+            .subIndex = 2,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2103_CANrxLanes.normalDropped,
+            .subIndex = 3,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2103_CANrxLanes.highHighWater,
+            .subIndex = 4,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2103_CANrxLanes.fastHighWater,
+            .subIndex = 5,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2103_CANrxLanes.normalHighWater,
+            .subIndex = 6,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2103_CANrxLanes.driverLost,
+            .subIndex = 7,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2103_CANrxLanes.batchLast,
+            .subIndex = 8,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2103_CANrxLanes.batchMax,
+            .subIndex = 9,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2103_CANrxLanes.driverQueueHighWater,
+            .subIndex = 10,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 2
+        }
+    },
+    .o_2104_CANtxShaper = {
+        {
+            .dataOrig = &OD_RAM.x2104_CANtxShaper.highestSub_indexSupported,
+            .subIndex = 0,
+            .attribute = ODA_SDO_R,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x2104_CANtxShaper.bulkClasses,
+            .subIndex = 1,
+            .attribute = ODA_SDO_RW,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x2104_CANtxShaper.bulkShare,
+            .subIndex = 2,
+            .attribute = ODA_SDO_RW | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2104_CANtxShaper.burstFrames,
+            .subIndex = 3,
+            .attribute = ODA_SDO_RW | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2104_CANtxShaper.deferred,
+            .subIndex = 4,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2104_CANtxShaper.shapedFrames,
+            .subIndex = 5,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2104_CANtxShaper.PDOtxDelayMax,
+            .subIndex = 6,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2104_CANtxShaper.PDOtxDelayAverage,
+            .subIndex = 7,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        }
+    },
+    .o_2105_CANsyncTPDO = {
+        {
+            .dataOrig = &OD_RAM.x2105_CANsyncTPDO.highestSub_indexSupported,
+            .subIndex = 0,
+            .attribute = ODA_SDO_R,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x2105_CANsyncTPDO.frames,
+            .subIndex = 1,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2105_CANsyncTPDO.lastLatency,
+            .subIndex = 2,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2105_CANsyncTPDO.maxLatency,
+            .subIndex = 3,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2105_CANsyncTPDO.averageLatency,
+            .subIndex = 4,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2105_CANsyncTPDO.aborted,
+            .subIndex = 5,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2105_CANsyncTPDO.dropped,
+            .subIndex = 6,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        }
+    },
+    .o_2106_CANtxFreshness = {
+        {
+            .dataOrig = &OD_RAM.x2106_CANtxFreshness.highestSub_indexSupported,
+            .subIndex = 0,
+            .attribute = ODA_SDO_R,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x2106_CANtxFreshness.enable,
+            .subIndex = 1,
+            .attribute = ODA_SDO_RW,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x2106_CANtxFreshness.expired,
+            .subIndex = 2,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2106_CANtxFreshness.replaced,
+            .subIndex = 3,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        }
+    },
+    .o_2107_CANanalyzer = {
+        {
+            .dataOrig = &OD_RAM.x2107_CANanalyzer.highestSub_indexSupported,
+            .subIndex = 0,
+            .attribute = ODA_SDO_R,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x2107_CANanalyzer.enable,
+            .subIndex = 1,
+            .attribute = ODA_SDO_RW,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x2107_CANanalyzer.bitRate,
+            .subIndex = 2,
+            .attribute = ODA_SDO_RW | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2107_CANanalyzer.framesStreamed,
+            .subIndex = 3,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2107_CANanalyzer.framesLost,
+            .subIndex = 4,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2107_CANanalyzer.queueHighWater,
+            .subIndex = 5,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 2
+        }
+    },
+    .o_2108_CANloadGenerator = {
+        {
+            .dataOrig = &OD_RAM.x2108_CANloadGenerator.highestSub_indexSupported,
+            .subIndex = 0,
+            .attribute = ODA_SDO_R,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x2108_CANloadGenerator.enable,
+            .subIndex = 1,
+            .attribute = ODA_SDO_RW,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x2108_CANloadGenerator.cobIdFirst,
+            .subIndex = 2,
+            .attribute = ODA_SDO_RW | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2108_CANloadGenerator.cobIdLast,
+            .subIndex = 3,
+            .attribute = ODA_SDO_RW | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2108_CANloadGenerator.DLC,
+            .subIndex = 4,
+            .attribute = ODA_SDO_RW,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x2108_CANloadGenerator.framesPerSecond,
+            .subIndex = 5,
+            .attribute = ODA_SDO_RW | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2108_CANloadGenerator.burstFrames,
+            .subIndex = 6,
+            .attribute = ODA_SDO_RW | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2108_CANloadGenerator.framesQueued,
+            .subIndex = 7,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2108_CANloadGenerator.framesTransmitted,
+            .subIndex = 8,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2108_CANloadGenerator.achievedFramesPerSecond,
+            .subIndex = 9,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2108_CANloadGenerator.txOverflow,
+            .subIndex = 10,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2108_CANloadGenerator.queueLatencyAverage,
+            .subIndex = 11,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2108_CANloadGenerator.queueLatencyMax,
+            .subIndex = 12,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2108_CANloadGenerator.busLoad,
+            .subIndex = 13,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2108_CANloadGenerator.txErrorCounter,
+            .subIndex = 14,
+            .attribute = ODA_SDO_R,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x2108_CANloadGenerator.rxErrorCounter,
+            .subIndex = 15,
+            .attribute = ODA_SDO_R,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x2108_CANloadGenerator.busErrors,
+            .subIndex = 16,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2108_CANloadGenerator.arbitrationLost,
+            .subIndex = 17,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2108_CANloadGenerator.txFailed,
+            .subIndex = 18,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        }
+    },
+    .o_2109_CANresetCommunication = {
+        {
+            .dataOrig = &OD_RAM.x2109_CANresetCommunication.highestSub_indexSupported,
+            .subIndex = 0,
+            .attribute = ODA_SDO_R,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x2109_CANresetCommunication.warm,
+            .subIndex = 1,
+            .attribute = ODA_SDO_RW,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x2109_CANresetCommunication.resets,
+            .subIndex = 2,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2109_CANresetCommunication.lastResetToBootup,
+            .subIndex = 3,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x2109_CANresetCommunication.maxResetToBootup,
+            .subIndex = 4,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        }
+    },
+    .o_210A_CANsyncTPDOqueue = {
+        {
+            .dataOrig = &OD_RAM.x210A_CANsyncTPDOqueue.highestSub_indexSupported,
+            .subIndex = 0,
+            .attribute = ODA_SDO_R,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x210A_CANsyncTPDOqueue.cycles,
+            .subIndex = 1,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210A_CANsyncTPDOqueue.lastLatency,
+            .subIndex = 2,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210A_CANsyncTPDOqueue.minLatency,
+            .subIndex = 3,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210A_CANsyncTPDOqueue.maxLatency,
+            .subIndex = 4,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210A_CANsyncTPDOqueue.averageLatency,
+            .subIndex = 5,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210A_CANsyncTPDOqueue.jitter,
+            .subIndex = 6,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        }
+    },
+    .o_210B_COcycleTimer = {
+        {
+            .dataOrig = &OD_RAM.x210B_COcycleTimer.highestSub_indexSupported,
+            .subIndex = 0,
+            .attribute = ODA_SDO_R,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x210B_COcycleTimer.period,
+            .subIndex = 1,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210B_COcycleTimer.cycles,
+            .subIndex = 2,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210B_COcycleTimer.overruns,
+            .subIndex = 3,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210B_COcycleTimer.lastTimeDifference,
+            .subIndex = 4,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210B_COcycleTimer.maxTimeDifference,
+            .subIndex = 5,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210B_COcycleTimer.maxRunTime,
+            .subIndex = 6,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        }
+    },
+    .o_210C_COmemoryFootprint = {
+        {
+            .dataOrig = &OD_RAM.x210C_COmemoryFootprint.highestSub_indexSupported,
+            .subIndex = 0,
+            .attribute = ODA_SDO_R,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x210C_COmemoryFootprint.total,
+            .subIndex = 1,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210C_COmemoryFootprint.heap,
+            .subIndex = 2,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210C_COmemoryFootprint.CO,
+            .subIndex = 3,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210C_COmemoryFootprint.NMT,
+            .subIndex = 4,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210C_COmemoryFootprint.HBcons,
+            .subIndex = 5,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210C_COmemoryFootprint.EM,
+            .subIndex = 6,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210C_COmemoryFootprint.SDOserver,
+            .subIndex = 7,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210C_COmemoryFootprint.SDOclient,
+            .subIndex = 8,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210C_COmemoryFootprint.TIME,
+            .subIndex = 9,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210C_COmemoryFootprint.SYNC,
+            .subIndex = 10,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210C_COmemoryFootprint.RPDO,
+            .subIndex = 11,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210C_COmemoryFootprint.TPDO,
+            .subIndex = 12,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210C_COmemoryFootprint.LEDs,
+            .subIndex = 13,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210C_COmemoryFootprint.LSS,
+            .subIndex = 14,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210C_COmemoryFootprint.other,
+            .subIndex = 15,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210C_COmemoryFootprint.CANmodule,
+            .subIndex = 16,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210C_COmemoryFootprint.CANrx,
+            .subIndex = 17,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210C_COmemoryFootprint.CANtx,
+            .subIndex = 18,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        }
+    },
+    .o_210D_COprofiler = {
+        {
+            .dataOrig = &OD_RAM.x210D_COprofiler.highestSub_indexSupported,
+            .subIndex = 0,
+            .attribute = ODA_SDO_R,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x210D_COprofiler.control,
+            .subIndex = 1,
+            .attribute = ODA_SDO_RW,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x210D_COprofiler.report[0],
+            .subIndex = 2,
+            .attribute = ODA_SDO_R,
+            .dataLength = sizeof(OD_RAM.x210D_COprofiler.report)
+        }
+    },
+    .o_210E_CANsendLatency = {
+        {
+            .dataOrig = &OD_RAM.x210E_CANsendLatency.highestSub_indexSupported,
+            .subIndex = 0,
+            .attribute = ODA_SDO_R,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x210E_CANsendLatency.maxLatency,
+            .subIndex = 1,
+            .attribute = ODA_SDO_RW | ODA_MB,
+            .dataLength = 4
+        }
+    },
+    .o_210F_CANrxLatency = {
+        {
+            .dataOrig = &OD_RAM.x210F_CANrxLatency.highestSub_indexSupported,
+            .subIndex = 0,
+            .attribute = ODA_SDO_R,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x210F_CANrxLatency.highFrames,
+            .subIndex = 1,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210F_CANrxLatency.highLastLatency,
+            .subIndex = 2,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210F_CANrxLatency.highMaxLatency,
+            .subIndex = 3,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210F_CANrxLatency.highAverageLatency,
+            .subIndex = 4,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210F_CANrxLatency.fastFrames,
+            .subIndex = 5,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210F_CANrxLatency.fastLastLatency,
+            .subIndex = 6,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210F_CANrxLatency.fastMaxLatency,
+            .subIndex = 7,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210F_CANrxLatency.fastAverageLatency,
+            .subIndex = 8,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210F_CANrxLatency.normalFrames,
+            .subIndex = 9,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210F_CANrxLatency.normalLastLatency,
+            .subIndex = 10,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210F_CANrxLatency.normalMaxLatency,
+            .subIndex = 11,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        },
+        {
+            .dataOrig = &OD_RAM.x210F_CANrxLatency.normalAverageLatency,
+            .subIndex = 12,
+            .attribute = ODA_SDO_R | ODA_MB,
+            .dataLength = 4
+        }
+    },
+    .o_2110_CANrxFastLane = {
+        {
+            .dataOrig = &OD_RAM.x2110_CANrxFastLane.highestSub_indexSupported,
+            .subIndex = 0,
+            .attribute = ODA_SDO_R,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x2110_CANrxFastLane.fastClasses,
+            .subIndex = 1,
+            .attribute = ODA_SDO_RW,
+            .dataLength = 1
+        },
+        {
+            .dataOrig = &OD_RAM.x2110_CANrxFastLane.cobId1,
+            .subIndex = 2,
+            .attribute = ODA_SDO_RW | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2110_CANrxFastLane.cobId2,
+            .subIndex = 3,
+            .attribute = ODA_SDO_RW | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2110_CANrxFastLane.cobId3,
+            .subIndex = 4,
+            .attribute = ODA_SDO_RW | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2110_CANrxFastLane.cobId4,
+            .subIndex = 5,
+            .attribute = ODA_SDO_RW | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2110_CANrxFastLane.cobId5,
+            .subIndex = 6,
+            .attribute = ODA_SDO_RW | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2110_CANrxFastLane.cobId6,
+            .subIndex = 7,
+            .attribute = ODA_SDO_RW | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2110_CANrxFastLane.cobId7,
+            .subIndex = 8,
+            .attribute = ODA_SDO_RW | ODA_MB,
+            .dataLength = 2
+        },
+        {
+            .dataOrig = &OD_RAM.x2110_CANrxFastLane.cobId8,
+            .subIndex = 9,
+            .attribute = ODA_SDO_RW | ODA_MB,
+            .dataLength = 2
+        }
     }
 };
 
@@ -1264,6 +2350,23 @@ static OD_ATTR_OD OD_entry_t ODList[] = {
     {0x1F5A, 0x02, ODT_REC, &ODObjs.o_1F5A_programStatus, NULL},
     {0x1F5B, 0x02, ODT_REC, &ODObjs.o_1F5B_runningFirmwareCrc, NULL},
     {0x1F5C, 0x02, ODT_REC, &ODObjs.o_1F5C_runningFirmwareVersion, NULL},
+    {0x2100, 0x08, ODT_REC, &ODObjs.o_2100_CANbusOffRecovery, NULL},
+    {0x2101, 0x05, ODT_REC, &ODObjs.o_2101_CANtrafficStatistics, NULL},
+    {0x2102, 0x09, ODT_REC, &ODObjs.o_2102_CANcapture, NULL},
+    {0x2103, 0x0B, ODT_REC, &ODObjs.o_2103_CANrxLanes, NULL},
+    {0x2104, 0x08, ODT_REC, &ODObjs.o_2104_CANtxShaper, NULL},
+    {0x2105, 0x07, ODT_REC, &ODObjs.o_2105_CANsyncTPDO, NULL},
+    {0x2106, 0x04, ODT_REC, &ODObjs.o_2106_CANtxFreshness, NULL},
+    {0x2107, 0x06, ODT_REC, &ODObjs.o_2107_CANanalyzer, NULL},
+    {0x2108, 0x13, ODT_REC, &ODObjs.o_2108_CANloadGenerator, NULL},
+    {0x2109, 0x05, ODT_REC, &ODObjs.o_2109_CANresetCommunication, NULL},
+    {0x210A, 0x07, ODT_REC, &ODObjs.o_210A_CANsyncTPDOqueue, NULL},
+    {0x210B, 0x07, ODT_REC, &ODObjs.o_210B_COcycleTimer, NULL},
+    {0x210C, 0x13, ODT_REC, &ODObjs.o_210C_COmemoryFootprint, NULL},
+    {0x210D, 0x03, ODT_REC, &ODObjs.o_210D_COprofiler, NULL},
+    {0x210E, 0x02, ODT_REC, &ODObjs.o_210E_CANsendLatency, NULL},
+    {0x210F, 0x0D, ODT_REC, &ODObjs.o_210F_CANrxLatency, NULL},
+    {0x2110, 0x0A, ODT_REC, &ODObjs.o_2110_CANrxFastLane, NULL},
     {0x0000, 0x00, 0, NULL, NULL}
 };
 
@@ -266,6 +266,183 @@ typedef struct {
         uint8_t highestSub_indexSupported;
         uint16_t runningVersion;
     } x1F5C_runningFirmwareVersion;
+    struct {
+        uint8_t highestSub_indexSupported;
+        uint8_t backoff;
+        uint16_t initialDelay;
+        uint16_t maxDelay;
+        uint32_t recoveryCount;
+        uint32_t lastDowntime;
+        uint32_t maxDowntime;
+        uint32_t totalDowntime;
+    } x2100_CANbusOffRecovery;
+    struct {
+        uint8_t highestSub_indexSupported;
+        uint8_t statistics[92];
+        uint16_t rxFilterAcceptedIds;
+        uint16_t rxFilterRejectedIds;
+        uint32_t rxFilterLeakFrames;
+    } x2101_CANtrafficStatistics;
+    struct {
+        uint8_t highestSub_indexSupported;
+        uint8_t control;
+        uint8_t triggers;
+        uint16_t triggerCobId;
+        uint16_t triggerCobMask;
+        uint16_t postTrigger;
+        uint16_t records;
+        uint32_t recordCyclesMax;
+        uint8_t data;
+    } x2102_CANcapture;
+    struct {
+        uint8_t highestSub_indexSupported;
+        uint32_t highDropped;
+        uint32_t fastDropped;
+        uint32_t normalDropped;
+        uint16_t highHighWater;
+        uint16_t fastHighWater;
+        uint16_t normalHighWater;
+        uint32_t driverLost;
+        uint16_t batchLast;
+        uint16_t batchMax;
+        uint16_t driverQueueHighWater;
+    } x2103_CANrxLanes;
+    struct {
+        uint8_t highestSub_indexSupported;
+        uint8_t bulkClasses;
+        uint16_t bulkShare;
+        uint16_t burstFrames;
+        uint32_t deferred;
+        uint32_t shapedFrames;
+        uint32_t PDOtxDelayMax;
+        uint32_t PDOtxDelayAverage;
+    } x2104_CANtxShaper;
+    struct {
+        uint8_t highestSub_indexSupported;
+        uint32_t frames;
+        uint32_t lastLatency;
+        uint32_t maxLatency;
+        uint32_t averageLatency;
+        uint32_t aborted;
+        uint32_t dropped;
+    } x2105_CANsyncTPDO;
+    struct {
+        uint8_t highestSub_indexSupported;
+        uint8_t enable;
+        uint32_t expired;
+        uint32_t replaced;
+    } x2106_CANtxFreshness;
+    struct {
+        uint8_t highestSub_indexSupported;
+        uint8_t enable;
+        uint16_t bitRate;
+        uint32_t framesStreamed;
+        uint32_t framesLost;
+        uint16_t queueHighWater;
+    } x2107_CANanalyzer;
+    struct {
+        uint8_t highestSub_indexSupported;
+        uint8_t enable;
+        uint16_t cobIdFirst;
+        uint16_t cobIdLast;
+        uint8_t DLC;
+        uint32_t framesPerSecond;
+        uint16_t burstFrames;
+        uint32_t framesQueued;
+        uint32_t framesTransmitted;
+        uint32_t achievedFramesPerSecond;
+        uint32_t txOverflow;
+        uint32_t queueLatencyAverage;
+        uint32_t queueLatencyMax;
+        uint16_t busLoad;
+        uint8_t txErrorCounter;
+        uint8_t rxErrorCounter;
+        uint32_t busErrors;
+        uint32_t arbitrationLost;
+        uint32_t txFailed;
+    } x2108_CANloadGenerator;
+    struct {
+        uint8_t highestSub_indexSupported;
+        uint8_t warm;
+        uint32_t resets;
+        uint32_t lastResetToBootup;
+        uint32_t maxResetToBootup;
+    } x2109_CANresetCommunication;
+    struct {
+        uint8_t highestSub_indexSupported;
+        uint32_t cycles;
+        uint32_t lastLatency;
+        uint32_t minLatency;
+        uint32_t maxLatency;
+        uint32_t averageLatency;
+        uint32_t jitter;
+    } x210A_CANsyncTPDOqueue;
+    struct {
+        uint8_t highestSub_indexSupported;
+        uint32_t period;
+        uint32_t cycles;
+        uint32_t overruns;
+        uint32_t lastTimeDifference;
+        uint32_t maxTimeDifference;
+        uint32_t maxRunTime;
+    } x210B_COcycleTimer;
+    struct {
+        uint8_t highestSub_indexSupported;
+        uint32_t total;
+        uint32_t heap;
+        uint32_t CO;
+        uint32_t NMT;
+        uint32_t HBcons;
+        uint32_t EM;
+        uint32_t SDOserver;
+        uint32_t SDOclient;
+        uint32_t TIME;
+        uint32_t SYNC;
+        uint32_t RPDO;
+        uint32_t TPDO;
+        uint32_t LEDs;
+        uint32_t LSS;
+        uint32_t other;
+        uint32_t CANmodule;
+        uint32_t CANrx;
+        uint32_t CANtx;
+    } x210C_COmemoryFootprint;
+    struct {
+        uint8_t highestSub_indexSupported;
+        uint8_t control;
+        uint8_t report[332];
+    } x210D_COprofiler;
+    struct {
+        uint8_t highestSub_indexSupported;
+        uint32_t maxLatency;
+    } x210E_CANsendLatency;
+    struct {
+        uint8_t highestSub_indexSupported;
+        uint32_t highFrames;
+        uint32_t highLastLatency;
+        uint32_t highMaxLatency;
+        uint32_t highAverageLatency;
+        uint32_t fastFrames;
+        uint32_t fastLastLatency;
+        uint32_t fastMaxLatency;
+        uint32_t fastAverageLatency;
+        uint32_t normalFrames;
+        uint32_t normalLastLatency;
+        uint32_t normalMaxLatency;
+        uint32_t normalAverageLatency;
+    } x210F_CANrxLatency;
+    struct {
+        uint8_t highestSub_indexSupported;
+        uint8_t fastClasses;
+        uint16_t cobId1;
+        uint16_t cobId2;
+        uint16_t cobId3;
+        uint16_t cobId4;
+        uint16_t cobId5;
+        uint16_t cobId6;
+        uint16_t cobId7;
+        uint16_t cobId8;
+    } x2110_CANrxFastLane;
 } OD_RAM_t;
 
 #ifndef OD_ATTR_PERSIST_COMM
@@ -326,6 +503,23 @@ extern OD_ATTR_OD OD_t *OD;
 #define OD_ENTRY_H1F5A &OD->list[36]
 #define OD_ENTRY_H1F5B &OD->list[37]
 #define OD_ENTRY_H1F5C &OD->list[38]
+#define OD_ENTRY_H2100 &OD->list[39]
+#define OD_ENTRY_H2101 &OD->list[40]
+#define OD_ENTRY_H2102 &OD->list[41]
+#define OD_ENTRY_H2103 &OD->list[42]
+#define OD_ENTRY_H2104 &OD->list[43]
+#define OD_ENTRY_H2105 &OD->list[44]
+#define OD_ENTRY_H2106 &OD->list[45]
+#define OD_ENTRY_H2107 &OD->list[46]
+#define OD_ENTRY_H2108 &OD->list[47]
+#define OD_ENTRY_H2109 &OD->list[48]
+#define OD_ENTRY_H210A &OD->list[49]
+#define OD_ENTRY_H210B &OD->list[50]
+#define OD_ENTRY_H210C &OD->list[51]
+#define OD_ENTRY_H210D &OD->list[52]
+#define OD_ENTRY_H210E &OD->list[53]
+#define OD_ENTRY_H210F &OD->list[54]
+#define OD_ENTRY_H2110 &OD->list[55]
 
 
 /*******************************************************************************
@@ -370,6 +564,23 @@ extern OD_ATTR_OD OD_t *OD;
 #define OD_ENTRY_H1F5A_programStatus &OD->list[36]
 #define OD_ENTRY_H1F5B_runningFirmwareCrc &OD->list[37]
 #define OD_ENTRY_H1F5C_runningFirmwareVersion &OD->list[38]
+#define OD_ENTRY_H2100_CANbusOffRecovery &OD->list[39]
+#define OD_ENTRY_H2101_CANtrafficStatistics &OD->list[40]
+#define OD_ENTRY_H2102_CANcapture &OD->list[41]
+#define OD_ENTRY_H2103_CANrxLanes &OD->list[42]
+#define OD_ENTRY_H2104_CANtxShaper &OD->list[43]
+#define OD_ENTRY_H2105_CANsyncTPDO &OD->list[44]
+#define OD_ENTRY_H2106_CANtxFreshness &OD->list[45]
+#define OD_ENTRY_H2107_CANanalyzer &OD->list[46]
+#define OD_ENTRY_H2108_CANloadGenerator &OD->list[47]
+#define OD_ENTRY_H2109_CANresetCommunication &OD->list[48]
+#define OD_ENTRY_H210A_CANsyncTPDOqueue &OD->list[49]
+#define OD_ENTRY_H210B_COcycleTimer &OD->list[50]
+#define OD_ENTRY_H210C_COmemoryFootprint &OD->list[51]
+#define OD_ENTRY_H210D_COprofiler &OD->list[52]
+#define OD_ENTRY_H210E_CANsendLatency &OD->list[53]
+#define OD_ENTRY_H210F_CANrxLatency &OD->list[54]
+#define OD_ENTRY_H2110_CANrxFastLane &OD->list[55]
 
 
 /*******************************************************************************
@@ -0,0 +1,277 @@
+#include "can_analyzer.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+
+#include "driver/uart.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+#include "CO_driver_slcan.h"
+#include "OD.h"
+
+static const char *TAG = "can_analyzer";
+
+/* Worst case at 1 Mbit/s and 100 % bus load is about 235 kB/s of SLCAN text
+ * with timestamps (8-byte frames, 26 characters per 111 bits), which needs
+ * 2.35 Mbaud. 3 Mbaud leaves room for stuff bits being absent. The UART
+ * driver feeds the FIFO from its TX ring buffer in the ISR, so the task only
+ * copies whole chunks. */
+#define CAN_ANALYZER_UART UART_NUM_2
+#define CAN_ANALYZER_UART_BAUD 3000000
+#define CAN_ANALYZER_UART_TX_GPIO 17
+#define CAN_ANALYZER_UART_RX_GPIO 16
+#define CAN_ANALYZER_UART_TX_BUF 8192
+#define CAN_ANALYZER_UART_RX_BUF 256
+#define CAN_ANALYZER_CHUNK 1024
+#define CAN_ANALYZER_CMD_MAX 16
+#define CAN_ANALYZER_TASK_STACK 3072
+#define CAN_ANALYZER_TASK_PRIO 6 /* below CANopen driver tasks */
+#define CAN_ANALYZER_TASK_CORE 1
+#define CAN_ANALYZER_POLL_MS 10  /* commands from the host */
+
+/* Lawicel status flag "data overrun" */
+#define CAN_ANALYZER_FLAG_OVERRUN 0x08
+
+typedef struct {
+    CO_t *co;
+    OD_extension_t ext;
+    TaskHandle_t task;
+    bool open;               /* controller is in listen-only mode, owned by the task */
+    volatile bool wantOpen;  /* requested by OD or SLCAN command */
+    uint32_t lostReported;   /* lost frames at the last "F" command */
+    char cmd[CAN_ANALYZER_CMD_MAX];
+    uint8_t cmdLen;
+    char chunk[CAN_ANALYZER_CHUNK];
+    CO_CANslcan_t slcan;
+} can_analyzer_t;
+
+static can_analyzer_t s_analyzer = {0};
+
+/* Bit rates of SLCAN command "Sn", n = 0..8. Rates missing in the driver
+ * baudrate_config table are rejected, when the analyzer is opened. */
+static const uint16_t s_slcanBitRate[] = {10, 20, 50, 100, 125, 250, 500, 800, 1000};
+
+/* Called from the CAN RX task for each received frame */
+static void can_analyzer_frame(void *object, const CO_CANrxMsg_t *rcvMsg) {
+    can_analyzer_t *an = (can_analyzer_t *)object;
+    const twai_message_t *msg = &rcvMsg->msg;
+    uint32_t ident = msg->identifier;
+    bool wasEmpty = CO_CANslcan_count(&an->slcan) == 0;
+
+    if (msg->extd) {
+        ident |= CO_CAN_SLCAN_EFF;
+    }
+    if (msg->rtr) {
+        ident |= CO_CAN_SLCAN_RTR;
+    }
+    if (CO_CANslcan_push(&an->slcan, ident, msg->data_length_code, msg->data, (uint32_t)rcvMsg->timestamp_us) &&
+        wasEmpty) {
+        xTaskNotifyGive(an->task);
+    }
+}
+
+/* Apply wantOpen. Runs in the analyzer task only. */
+static void can_analyzer_apply(can_analyzer_t *an) {
+    bool wantOpen = an->wantOpen;
+
+    if (wantOpen == an->open || an->co == NULL) {
+        return;
+    }
+    if (wantOpen) {
+        CO_CANslcan_init(&an->slcan, an->slcan.timestamps);
+        an->lostReported = 0;
+        an->open = CO_CANmodule_setListenOnly(an->co->CANmodule, OD_RAM.x2107_CANanalyzer.bitRate, an,
+                                              can_analyzer_frame);
+    } else if (CO_CANmodule_setListenOnly(an->co->CANmodule, 0, NULL, NULL)) {
+        an->open = false;
+    }
+    if (an->open != wantOpen) {
+        ESP_LOGW(TAG, "Analyzer could not be %s", wantOpen ? "opened" : "closed");
+        an->wantOpen = an->open;
+    }
+    OD_RAM.x2107_CANanalyzer.enable = an->open ? 1 : 0;
+}
+
+static void can_analyzer_reply(const char *reply) {
+    (void)uart_write_bytes(CAN_ANALYZER_UART, reply, strlen(reply));
+}
+
+/* Subset of the Lawicel command set, which makes sense for a listen-only
+ * device: O/L open, C close, Sn bit rate, Z0/Z1 timestamps, F status, V
+ * version. Others are answered with BEL. */
+static void can_analyzer_command(can_analyzer_t *an, const char *cmd, uint8_t len) {
+    char reply[8];
+    bool ok = false;
+
+    switch (cmd[0]) {
+    case 'O':
+    case 'L':
+        if (len == 1 && !an->open) {
+            an->wantOpen = true;
+            can_analyzer_apply(an);
+            ok = an->open;
+        }
+        break;
+    case 'C':
+        if (len == 1 && an->open) {
+            an->wantOpen = false;
+            can_analyzer_apply(an);
+            ok = !an->open;
+        }
+        break;
+    case 'S':
+        if (len == 2 && !an->open && cmd[1] >= '0' && cmd[1] <= '8') {
+            OD_RAM.x2107_CANanalyzer.bitRate = s_slcanBitRate[cmd[1] - '0'];
+            ok = true;
+        }
+        break;
+    case 'Z':
+        if (len == 2 && !an->open && (cmd[1] == '0' || cmd[1] == '1')) {
+            an->slcan.timestamps = cmd[1] == '1';
+            ok = true;
+        }
+        break;
+    case 'F': {
+        uint32_t lost = an->slcan.lost;
+        uint8_t flags = (lost != an->lostReported) ? CAN_ANALYZER_FLAG_OVERRUN : 0;
+
+        an->lostReported = lost;
+        snprintf(reply, sizeof(reply), "F%02X\r", flags);
+        can_analyzer_reply(reply);
+        return;
+    }
+    case 'V':
+        can_analyzer_reply("V0100\r");
+        return;
+    default:
+        break;
+    }
+    can_analyzer_reply(ok ? "\r" : "\a");
+}
+
+static void can_analyzer_poll_commands(can_analyzer_t *an) {
+    uint8_t buf[32];
+    int len;
+    int i;
+
+    while ((len = uart_read_bytes(CAN_ANALYZER_UART, buf, sizeof(buf), 0)) > 0) {
+        for (i = 0; i < len; i++) {
+            if (buf[i] == '\r' || buf[i] == '\n') {
+                if (an->cmdLen > 0) {
+                    can_analyzer_command(an, an->cmd, an->cmdLen);
+                }
+                an->cmdLen = 0;
+            } else if (an->cmdLen < CAN_ANALYZER_CMD_MAX) {
+                an->cmd[an->cmdLen++] = (char)buf[i];
+            }
+        }
+    }
+}
+
+/* Stream frames in chunks. When the UART can not keep up, uart_write_bytes()
+ * blocks, the ring fills and further frames are counted as lost in the RX
+ * task. CAN traffic itself is never delayed. */
+static void can_analyzer_task(void *arg) {
+    can_analyzer_t *an = (can_analyzer_t *)arg;
+
+    for (;;) {
+        size_t len;
+
+        (void)ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(CAN_ANALYZER_POLL_MS));
+        can_analyzer_poll_commands(an);
+        can_analyzer_apply(an);
+
+        while ((len = CO_CANslcan_read(&an->slcan, an->chunk, sizeof(an->chunk))) > 0) {
+            (void)uart_write_bytes(CAN_ANALYZER_UART, an->chunk, len);
+        }
+    }
+}
+
+static ODR_t can_analyzer_read(OD_stream_t *stream, void *buf, OD_size_t count, OD_size_t *countRead) {
+    can_analyzer_t *an = (can_analyzer_t *)stream->object;
+
+    if (stream->dataOffset == 0U) {
+        OD_RAM.x2107_CANanalyzer.framesStreamed = an->slcan.streamed;
+        OD_RAM.x2107_CANanalyzer.framesLost = an->slcan.lost;
+        OD_RAM.x2107_CANanalyzer.queueHighWater = an->slcan.highWater;
+    }
+    return OD_readOriginal(stream, buf, count, countRead);
+}
+
+/* Mode is switched by the analyzer task, "enable" shows the result later */
+static ODR_t can_analyzer_write(OD_stream_t *stream, const void *buf, OD_size_t count, OD_size_t *countWritten) {
+    can_analyzer_t *an = (can_analyzer_t *)stream->object;
+    ODR_t ret;
+
+    if (buf == NULL || count != stream->dataLength) {
+        return ODR_TYPE_MISMATCH;
+    }
+    if (stream->subIndex == 1 && CO_getUint8(buf) > 1) {
+        return ODR_INVALID_VALUE;
+    }
+    if (stream->subIndex == 2 && an->open) {
+        /* bit rate is taken when the analyzer is opened */
+        return ODR_DATA_DEV_STATE;
+    }
+    ret = OD_writeOriginal(stream, buf, count, countWritten);
+    if (ret == ODR_OK && stream->subIndex == 1) {
+        an->wantOpen = CO_getUint8(buf) != 0;
+        xTaskNotifyGive(an->task);
+    }
+    return ret;
+}
+
+static bool can_analyzer_start_task(can_analyzer_t *an) {
+    const uart_config_t uartConfig = {
+        .baud_rate = CAN_ANALYZER_UART_BAUD,
+        .data_bits = UART_DATA_8_BITS,
+        .parity = UART_PARITY_DISABLE,
+        .stop_bits = UART_STOP_BITS_1,
+        .flow_ctrl = UART_HW_FLOWCTRL_DISABLE,
+        .source_clk = UART_SCLK_DEFAULT,
+    };
+
+    if (uart_driver_install(CAN_ANALYZER_UART, CAN_ANALYZER_UART_RX_BUF, CAN_ANALYZER_UART_TX_BUF, 0, NULL, 0) !=
+            ESP_OK ||
+        uart_param_config(CAN_ANALYZER_UART, &uartConfig) != ESP_OK ||
+        uart_set_pin(CAN_ANALYZER_UART, CAN_ANALYZER_UART_TX_GPIO, CAN_ANALYZER_UART_RX_GPIO, UART_PIN_NO_CHANGE,
+                     UART_PIN_NO_CHANGE) != ESP_OK) {
+        ESP_LOGE(TAG, "UART %d setup failed", CAN_ANALYZER_UART);
+        return false;
+    }
+    CO_CANslcan_init(&an->slcan, true);
+    if (xTaskCreatePinnedToCore(can_analyzer_task, "CAN_analyzer", CAN_ANALYZER_TASK_STACK, an,
+                                CAN_ANALYZER_TASK_PRIO, &an->task, CAN_ANALYZER_TASK_CORE) != pdPASS) {
+        ESP_LOGE(TAG, "Analyzer task creation failed");
+        return false;
+    }
+    return true;
+}
+
+bool can_analyzer_init(CO_t *co) {
+    if (co == NULL || co->CANmodule == NULL || OD == NULL) {
+        return false;
+    }
+    s_analyzer.co = co;
+    if (s_analyzer.task == NULL && !can_analyzer_start_task(&s_analyzer)) {
+        return false;
+    }
+
+    /* Driver reinstall on communication reset left listen-only mode, warm
+     * reset kept it. Analyzer task enters it again, if it is still enabled. */
+    s_analyzer.open = co->CANmodule->listenOnly;
+    s_analyzer.wantOpen = OD_RAM.x2107_CANanalyzer.enable != 0;
+    xTaskNotifyGive(s_analyzer.task);
+
+    s_analyzer.ext.object = &s_analyzer;
+    s_analyzer.ext.read = can_analyzer_read;
+    s_analyzer.ext.write = can_analyzer_write;
+    if (OD_extension_init(OD_ENTRY_H2107_CANanalyzer, &s_analyzer.ext) != ODR_OK) {
+        ESP_LOGW(TAG, "Could not register 0x2107 extension");
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "CANopen.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Passive bus analyzer: controller in listen-only mode, every received frame
+ *  is streamed over UART in SLCAN (Lawicel) format. Enabled with OD 0x2107 or
+ *  with SLCAN commands "O"/"L" and "C" on the UART.
+ *  Call after CO_CANopenInit() on every communication reset. */
+bool can_analyzer_init(CO_t *co);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,531 @@
+#include "can_diag_server.h"
+
+#include <string.h>
+#include <stdint.h>
+
+#include "esp_log.h"
+
+#include "CO_driver_filter.h"
+#include "OD.h"
+
+static const char *TAG = "can_diag";
+
+typedef struct {
+    CO_t *co;
+    OD_extension_t busOffExt;
+    OD_extension_t trafficExt;
+    OD_extension_t captureExt;
+    OD_extension_t rxLanesExt;
+    OD_extension_t txShaperExt;
+    OD_extension_t syncTpdoExt;
+    OD_extension_t syncQueueExt;
+    OD_extension_t txFreshnessExt;
+    OD_extension_t sendLatencyExt;
+    OD_extension_t rxLatencyExt;
+    OD_extension_t rxFastExt;
+} can_diag_server_t;
+
+static can_diag_server_t s_diag = {0};
+
+_Static_assert(sizeof(OD_RAM.x2101_CANtrafficStatistics.statistics) == sizeof(CO_CANtrafficStats_t),
+               "OD 0x2101 size must match CO_CANtrafficStats_t");
+
+/* Announce the node again after bus-off recovery. Bootup message uses the
+ * heartbeat buffer, EMCY for the bus-off is sent by CO_EM_process(). */
+static void can_diag_bus_off_recovered(void *object) {
+    can_diag_server_t *diag = (can_diag_server_t *)object;
+    CO_NMT_t *NMT = diag->co->NMT;
+
+    if (NMT == NULL || NMT->HB_TXbuff == NULL) {
+        return;
+    }
+    NMT->HB_TXbuff->data[0] = (uint8_t)CO_NMT_INITIALIZING;
+    (void)CO_CANsend(NMT->HB_CANdevTx, NMT->HB_TXbuff);
+}
+
+static void can_diag_apply_bus_off_config(CO_CANmodule_t *CANmodule) {
+    CANmodule->busOff.backoff = OD_RAM.x2100_CANbusOffRecovery.backoff;
+    CANmodule->busOff.initialDelay_ms = OD_RAM.x2100_CANbusOffRecovery.initialDelay;
+    CANmodule->busOff.maxDelay_ms = OD_RAM.x2100_CANbusOffRecovery.maxDelay;
+}
+
+static ODR_t can_diag_read_bus_off(OD_stream_t *stream, void *buf, OD_size_t count, OD_size_t *countRead) {
+    can_diag_server_t *diag = (can_diag_server_t *)stream->object;
+    const CO_CANbusOff_t *busOff = &diag->co->CANmodule->busOff;
+
+    if (stream->dataOffset == 0U) {
+        OD_RAM.x2100_CANbusOffRecovery.recoveryCount = busOff->recoveryCount;
+        OD_RAM.x2100_CANbusOffRecovery.lastDowntime = busOff->lastDowntime_ms;
+        OD_RAM.x2100_CANbusOffRecovery.maxDowntime = busOff->maxDowntime_ms;
+        OD_RAM.x2100_CANbusOffRecovery.totalDowntime = busOff->totalDowntime_ms;
+    }
+    return OD_readOriginal(stream, buf, count, countRead);
+}
+
+static ODR_t can_diag_write_bus_off(OD_stream_t *stream, const void *buf, OD_size_t count, OD_size_t *countWritten) {
+    can_diag_server_t *diag = (can_diag_server_t *)stream->object;
+
+    if (stream->subIndex == 1U && buf != NULL && count == 1U &&
+        *(const uint8_t *)buf > (uint8_t)CO_CAN_BUSOFF_BACKOFF_CAPPED) {
+        return ODR_INVALID_VALUE;
+    }
+    ODR_t ret = OD_writeOriginal(stream, buf, count, countWritten);
+    if (ret == ODR_OK) {
+        can_diag_apply_bus_off_config(diag->co->CANmodule);
+    }
+    return ret;
+}
+
+/* Whole statistics are copied at the start of the transfer, so a block upload
+ * returns one consistent snapshot. Subs 2-4 show the hardware acceptance
+ * filter: identifiers passed and rejected, and received frames which matched
+ * no rxArray entry. */
+static ODR_t can_diag_read_traffic(OD_stream_t *stream, void *buf, OD_size_t count, OD_size_t *countRead) {
+    can_diag_server_t *diag = (can_diag_server_t *)stream->object;
+    const CO_CANmodule_t *CANmodule = diag->co->CANmodule;
+
+    if (stream->subIndex == 1U && stream->dataOffset == 0U) {
+        memcpy(OD_RAM.x2101_CANtrafficStatistics.statistics, &CANmodule->traffic,
+               sizeof(OD_RAM.x2101_CANtrafficStatistics.statistics));
+    }
+    OD_RAM.x2101_CANtrafficStatistics.rxFilterAcceptedIds = CANmodule->rxFilterAcceptedIds;
+    OD_RAM.x2101_CANtrafficStatistics.rxFilterRejectedIds =
+        (uint16_t)(CO_CAN_FILTER_ID_SPACE - CANmodule->rxFilterAcceptedIds);
+    OD_RAM.x2101_CANtrafficStatistics.rxFilterLeakFrames = CANmodule->rxFilterLeakCount;
+    return OD_readOriginal(stream, buf, count, countRead);
+}
+
+/* Capture image is read in parts directly from the ring, its size is fixed by
+ * the snapshot at the start of the upload */
+static ODR_t can_diag_read_capture(OD_stream_t *stream, void *buf, OD_size_t count, OD_size_t *countRead) {
+    can_diag_server_t *diag = (can_diag_server_t *)stream->object;
+    CO_CANcapture_t *capture = &diag->co->CANmodule->capture;
+
+    if (stream->subIndex == 8U) {
+        if (stream->dataOffset == 0U) {
+            stream->dataLength = (OD_size_t)CO_CANcapture_snapshot(capture);
+        }
+        size_t n = CO_CANcapture_read(capture, stream->dataOffset, (uint8_t *)buf, count);
+        stream->dataOffset += (OD_size_t)n;
+        *countRead = (OD_size_t)n;
+        if (stream->dataOffset < stream->dataLength) {
+            return ODR_PARTIAL;
+        }
+        stream->dataOffset = 0U;
+        return ODR_OK;
+    }
+
+    if (stream->dataOffset == 0U) {
+        OD_RAM.x2102_CANcapture.control = capture->state;
+        OD_RAM.x2102_CANcapture.records = CO_CANcapture_count(capture);
+        OD_RAM.x2102_CANcapture.recordCyclesMax = capture->recordCyclesMax;
+    }
+    return OD_readOriginal(stream, buf, count, countRead);
+}
+
+/* Control: 0 = stop, 1 = arm with settings from sub 2..5, 2 = manual trigger */
+static ODR_t can_diag_write_capture(OD_stream_t *stream, const void *buf, OD_size_t count, OD_size_t *countWritten) {
+    can_diag_server_t *diag = (can_diag_server_t *)stream->object;
+    CO_CANcapture_t *capture = &diag->co->CANmodule->capture;
+
+    if (stream->subIndex != 1U) {
+        return OD_writeOriginal(stream, buf, count, countWritten);
+    }
+    if (buf == NULL || count != 1U) {
+        return ODR_DEV_INCOMPAT;
+    }
+    switch (*(const uint8_t *)buf) {
+    case 0:
+        CO_CANcapture_stop(capture);
+        break;
+    case 1:
+        CO_CANcapture_arm(capture, OD_RAM.x2102_CANcapture.triggers, OD_RAM.x2102_CANcapture.triggerCobId,
+                          OD_RAM.x2102_CANcapture.triggerCobMask, OD_RAM.x2102_CANcapture.postTrigger);
+        break;
+    case 2:
+        CO_CANcapture_trigger(capture, CO_CAN_CAPTURE_TRIG_MANUAL);
+        break;
+    default:
+        return ODR_INVALID_VALUE;
+    }
+    OD_RAM.x2102_CANcapture.control = capture->state;
+    *countWritten = count;
+    return ODR_OK;
+}
+
+/* Frames lost in the TWAI driver (RX FIFO overrun, driver queue full) happen
+ * before the lane is known, they are reported together in sub 7. Subs 8-10
+ * show the RX task drain and the TWAI driver queue. */
+static ODR_t can_diag_read_rx_lanes(OD_stream_t *stream, void *buf, OD_size_t count, OD_size_t *countRead) {
+    can_diag_server_t *diag = (can_diag_server_t *)stream->object;
+    const CO_CANmodule_t *CANmodule = diag->co->CANmodule;
+
+    if (stream->dataOffset == 0U) {
+        OD_RAM.x2103_CANrxLanes.highDropped = CANmodule->rxLaneStats[CO_CAN_RX_LANE_HIGH].dropped;
+        OD_RAM.x2103_CANrxLanes.fastDropped = CANmodule->rxLaneStats[CO_CAN_RX_LANE_FAST].dropped;
+        OD_RAM.x2103_CANrxLanes.normalDropped = CANmodule->rxLaneStats[CO_CAN_RX_LANE_NORMAL].dropped;
+        OD_RAM.x2103_CANrxLanes.highHighWater = CANmodule->rxLaneStats[CO_CAN_RX_LANE_HIGH].highWater;
+        OD_RAM.x2103_CANrxLanes.fastHighWater = CANmodule->rxLaneStats[CO_CAN_RX_LANE_FAST].highWater;
+        OD_RAM.x2103_CANrxLanes.normalHighWater = CANmodule->rxLaneStats[CO_CAN_RX_LANE_NORMAL].highWater;
+        OD_RAM.x2103_CANrxLanes.driverLost = CANmodule->traffic.rxOverrun + CANmodule->traffic.rxMissed;
+        OD_RAM.x2103_CANrxLanes.batchLast = CANmodule->rxBatchLast;
+        OD_RAM.x2103_CANrxLanes.batchMax = CANmodule->rxBatchMax;
+        OD_RAM.x2103_CANrxLanes.driverQueueHighWater = CANmodule->rxQueueHighWater;
+    }
+    return OD_readOriginal(stream, buf, count, countRead);
+}
+
+static uint32_t can_diag_rx_latency_average(const CO_CANrxLatency_t *rxLatency) {
+    return (rxLatency->frames > 0U) ? (uint32_t)(rxLatency->sumLatency_us / rxLatency->frames) : 0U;
+}
+
+/* twai_receive() to return of CANrx_callback, per receive lane. Time in the
+ * TWAI ISR and the driver queue is not included. */
+static ODR_t can_diag_read_rx_latency(OD_stream_t *stream, void *buf, OD_size_t count, OD_size_t *countRead) {
+    can_diag_server_t *diag = (can_diag_server_t *)stream->object;
+    const CO_CANrxLatency_t *high = &diag->co->CANmodule->rxLatency[CO_CAN_RX_LANE_HIGH];
+    const CO_CANrxLatency_t *fast = &diag->co->CANmodule->rxLatency[CO_CAN_RX_LANE_FAST];
+    const CO_CANrxLatency_t *normal = &diag->co->CANmodule->rxLatency[CO_CAN_RX_LANE_NORMAL];
+
+    if (stream->dataOffset == 0U) {
+        OD_RAM.x210F_CANrxLatency.highFrames = high->frames;
+        OD_RAM.x210F_CANrxLatency.highLastLatency = high->lastLatency_us;
+        OD_RAM.x210F_CANrxLatency.highMaxLatency = high->maxLatency_us;
+        OD_RAM.x210F_CANrxLatency.highAverageLatency = can_diag_rx_latency_average(high);
+        OD_RAM.x210F_CANrxLatency.fastFrames = fast->frames;
+        OD_RAM.x210F_CANrxLatency.fastLastLatency = fast->lastLatency_us;
+        OD_RAM.x210F_CANrxLatency.fastMaxLatency = fast->maxLatency_us;
+        OD_RAM.x210F_CANrxLatency.fastAverageLatency = can_diag_rx_latency_average(fast);
+        OD_RAM.x210F_CANrxLatency.normalFrames = normal->frames;
+        OD_RAM.x210F_CANrxLatency.normalLastLatency = normal->lastLatency_us;
+        OD_RAM.x210F_CANrxLatency.normalMaxLatency = normal->maxLatency_us;
+        OD_RAM.x210F_CANrxLatency.normalAverageLatency = can_diag_rx_latency_average(normal);
+    }
+    return OD_readOriginal(stream, buf, count, countRead);
+}
+
+/* Fast receive lane set from 0x2110, COB-ID 0 marks an unused sub (NMT is in
+ * the high lane anyway). sub/value replace the OD value, sub 0 takes none. */
+static bool can_diag_apply_rx_fast(CO_CANmodule_t *CANmodule, uint8_t sub, uint16_t value) {
+    uint16_t cobIds[8] = {
+        OD_RAM.x2110_CANrxFastLane.cobId1, OD_RAM.x2110_CANrxFastLane.cobId2, OD_RAM.x2110_CANrxFastLane.cobId3,
+        OD_RAM.x2110_CANrxFastLane.cobId4, OD_RAM.x2110_CANrxFastLane.cobId5, OD_RAM.x2110_CANrxFastLane.cobId6,
+        OD_RAM.x2110_CANrxFastLane.cobId7, OD_RAM.x2110_CANrxFastLane.cobId8,
+    };
+    uint8_t fastClasses = OD_RAM.x2110_CANrxFastLane.fastClasses;
+    uint16_t idents[8];
+    uint16_t identCount = 0U;
+    uint8_t i;
+
+    if (sub == 1U) {
+        fastClasses = (uint8_t)value;
+    } else if (sub >= 2U && sub <= 9U) {
+        cobIds[sub - 2U] = value;
+    }
+    for (i = 0U; i < 8U; i++) {
+        if (cobIds[i] != 0U) {
+            idents[identCount++] = cobIds[i];
+        }
+    }
+    return CO_CANmodule_setRxFast(CANmodule, fastClasses, idents, identCount);
+}
+
+static ODR_t can_diag_write_rx_fast(OD_stream_t *stream, const void *buf, OD_size_t count,
+                                    OD_size_t *countWritten) {
+    can_diag_server_t *diag = (can_diag_server_t *)stream->object;
+    uint16_t value;
+
+    if (buf == NULL || count != stream->dataLength) {
+        return ODR_TYPE_MISMATCH;
+    }
+    value = (stream->subIndex == 1U) ? CO_getUint8(buf) : CO_getUint16(buf);
+    if (!can_diag_apply_rx_fast(diag->co->CANmodule, stream->subIndex, value)) {
+        return ODR_INVALID_VALUE;
+    }
+    return OD_writeOriginal(stream, buf, count, countWritten);
+}
+
+/* PDO transmit delay is shown here, so the effect of the limits on real-time
+ * traffic can be watched while they are tuned */
+static ODR_t can_diag_read_tx_shaper(OD_stream_t *stream, void *buf, OD_size_t count, OD_size_t *countRead) {
+    can_diag_server_t *diag = (can_diag_server_t *)stream->object;
+    const CO_CANmodule_t *CANmodule = diag->co->CANmodule;
+    const CO_CANtxDelay_t *pdoDelay = &CANmodule->txDelay[CO_CAN_CLASS_PDO];
+
+    if (stream->dataOffset == 0U) {
+        OD_RAM.x2104_CANtxShaper.deferred = CANmodule->txShaper.deferred;
+        OD_RAM.x2104_CANtxShaper.shapedFrames = CANmodule->txShaper.shapedFrames;
+        OD_RAM.x2104_CANtxShaper.PDOtxDelayMax = pdoDelay->maxDelay_us;
+        OD_RAM.x2104_CANtxShaper.PDOtxDelayAverage =
+            (pdoDelay->frames > 0U) ? (uint32_t)(pdoDelay->sumDelay_us / pdoDelay->frames) : 0U;
+    }
+    return OD_readOriginal(stream, buf, count, countRead);
+}
+
+static ODR_t can_diag_write_tx_shaper(OD_stream_t *stream, const void *buf, OD_size_t count,
+                                      OD_size_t *countWritten) {
+    can_diag_server_t *diag = (can_diag_server_t *)stream->object;
+    uint8_t bulkClasses = OD_RAM.x2104_CANtxShaper.bulkClasses;
+    uint16_t bulkShare = OD_RAM.x2104_CANtxShaper.bulkShare;
+    uint16_t burstFrames = OD_RAM.x2104_CANtxShaper.burstFrames;
+
+    if (buf == NULL || count != stream->dataLength) {
+        return ODR_TYPE_MISMATCH;
+    }
+    switch (stream->subIndex) {
+    case 1:
+        bulkClasses = CO_getUint8(buf);
+        break;
+    case 2:
+        bulkShare = CO_getUint16(buf);
+        break;
+    case 3:
+        burstFrames = CO_getUint16(buf);
+        break;
+    default:
+        break;
+    }
+    if (!CO_CANmodule_setTxShaper(diag->co->CANmodule, bulkClasses, bulkShare, burstFrames)) {
+        return ODR_INVALID_VALUE;
+    }
+    return OD_writeOriginal(stream, buf, count, countWritten);
+}
+
+static ODR_t can_diag_read_sync_tpdo(OD_stream_t *stream, void *buf, OD_size_t count, OD_size_t *countRead) {
+    can_diag_server_t *diag = (can_diag_server_t *)stream->object;
+    const CO_CANsyncTxStats_t *syncTx = &diag->co->CANmodule->syncTx;
+
+    if (stream->dataOffset == 0U) {
+        OD_RAM.x2105_CANsyncTPDO.frames = syncTx->frames;
+        OD_RAM.x2105_CANsyncTPDO.lastLatency = syncTx->lastLatency_us;
+        OD_RAM.x2105_CANsyncTPDO.maxLatency = syncTx->maxLatency_us;
+        OD_RAM.x2105_CANsyncTPDO.averageLatency =
+            (syncTx->frames > 0U) ? (uint32_t)(syncTx->sumLatency_us / syncTx->frames) : 0U;
+        OD_RAM.x2105_CANsyncTPDO.aborted = syncTx->aborted;
+        OD_RAM.x2105_CANsyncTPDO.dropped = syncTx->dropped;
+    }
+    return OD_readOriginal(stream, buf, count, countRead);
+}
+
+static ODR_t can_diag_read_sync_queue(OD_stream_t *stream, void *buf, OD_size_t count, OD_size_t *countRead) {
+    can_diag_server_t *diag = (can_diag_server_t *)stream->object;
+    const CO_CANsyncQueueStats_t *syncQueue = &diag->co->CANmodule->syncQueue;
+
+    if (stream->dataOffset == 0U) {
+        OD_RAM.x210A_CANsyncTPDOqueue.cycles = syncQueue->cycles;
+        OD_RAM.x210A_CANsyncTPDOqueue.lastLatency = syncQueue->lastLatency_us;
+        OD_RAM.x210A_CANsyncTPDOqueue.minLatency = syncQueue->minLatency_us;
+        OD_RAM.x210A_CANsyncTPDOqueue.maxLatency = syncQueue->maxLatency_us;
+        OD_RAM.x210A_CANsyncTPDOqueue.averageLatency =
+            (syncQueue->cycles > 0U) ? (uint32_t)(syncQueue->sumLatency_us / syncQueue->cycles) : 0U;
+        OD_RAM.x210A_CANsyncTPDOqueue.jitter = syncQueue->jitter16_us >> 4;
+    }
+    return OD_readOriginal(stream, buf, count, countRead);
+}
+
+/* Cyclic frames carry their period as lifetime: when it is still queued after
+ * one period, a newer sample is due and the old one is useless. Acyclic and
+ * event driven TPDOs without event timer, EMCY and SDO keep no deadline. */
+static void can_diag_apply_tx_lifetimes(CO_t *co, bool enable) {
+    uint32_t syncPeriod_us = 0;
+    int i;
+
+    if (co->SYNC != NULL && co->SYNC->OD_1006_period != NULL) {
+        syncPeriod_us = *co->SYNC->OD_1006_period;
+    }
+    for (i = 0; i < OD_CNT_TPDO; i++) {
+        CO_TPDO_t *TPDO = &co->TPDO[i];
+        uint32_t lifetime_us;
+
+        if (TPDO->CANtxBuff == NULL) {
+            continue;
+        }
+        if (TPDO->transmissionType == CO_PDO_TRANSM_TYPE_SYNC_ACYCLIC) {
+            lifetime_us = syncPeriod_us;
+        } else if (TPDO->transmissionType <= CO_PDO_TRANSM_TYPE_SYNC_240) {
+            lifetime_us = syncPeriod_us * TPDO->transmissionType;
+        } else {
+            lifetime_us = TPDO->eventTime_us;
+        }
+        TPDO->CANtxBuff->lifetime_us = enable ? lifetime_us : 0;
+    }
+    if (co->NMT != NULL && co->NMT->HB_TXbuff != NULL) {
+        co->NMT->HB_TXbuff->lifetime_us = enable ? co->NMT->HBproducerTime_us : 0;
+    }
+    if (co->SYNC != NULL && co->SYNC->CANtxBuff != NULL) {
+        co->SYNC->CANtxBuff->lifetime_us = (enable && co->SYNC->isProducer) ? syncPeriod_us : 0;
+    }
+}
+
+static ODR_t can_diag_read_tx_freshness(OD_stream_t *stream, void *buf, OD_size_t count, OD_size_t *countRead) {
+    can_diag_server_t *diag = (can_diag_server_t *)stream->object;
+    const CO_CANtxStaleStats_t *txStale = &diag->co->CANmodule->txStale;
+
+    if (stream->dataOffset == 0U) {
+        uint32_t expired = 0;
+        uint32_t replaced = 0;
+        int i;
+
+        for (i = 0; i < CO_CAN_CLASS_COUNT; i++) {
+            expired += txStale->expired[i];
+            replaced += txStale->replaced[i];
+        }
+        OD_RAM.x2106_CANtxFreshness.expired = expired;
+        OD_RAM.x2106_CANtxFreshness.replaced = replaced;
+    }
+    return OD_readOriginal(stream, buf, count, countRead);
+}
+
+/* Writing "enable" also takes over changed PDO, SYNC and heartbeat periods */
+static ODR_t can_diag_write_tx_freshness(OD_stream_t *stream, const void *buf, OD_size_t count,
+                                         OD_size_t *countWritten) {
+    can_diag_server_t *diag = (can_diag_server_t *)stream->object;
+    uint8_t enable;
+
+    if (buf == NULL || count != stream->dataLength) {
+        return ODR_TYPE_MISMATCH;
+    }
+    enable = CO_getUint8(buf);
+    if (enable > 1) {
+        return ODR_INVALID_VALUE;
+    }
+    can_diag_apply_tx_lifetimes(diag->co, enable != 0);
+    return OD_writeOriginal(stream, buf, count, countWritten);
+}
+
+static ODR_t can_diag_read_send_latency(OD_stream_t *stream, void *buf, OD_size_t count, OD_size_t *countRead) {
+    can_diag_server_t *diag = (can_diag_server_t *)stream->object;
+
+    if (stream->subIndex == 1U && stream->dataOffset == 0U) {
+        OD_RAM.x210E_CANsendLatency.maxLatency = diag->co->CANmodule->sendLatencyMax_us;
+    }
+    return OD_readOriginal(stream, buf, count, countRead);
+}
+
+/* Writing 0 restarts the worst case measurement */
+static ODR_t can_diag_write_send_latency(OD_stream_t *stream, const void *buf, OD_size_t count,
+                                         OD_size_t *countWritten) {
+    can_diag_server_t *diag = (can_diag_server_t *)stream->object;
+
+    if (buf == NULL || count != stream->dataLength) {
+        return ODR_TYPE_MISMATCH;
+    }
+    if (stream->subIndex == 1U) {
+        if (CO_getUint32(buf) != 0U) {
+            return ODR_INVALID_VALUE;
+        }
+        diag->co->CANmodule->sendLatencyMax_us = 0U;
+    }
+    return OD_writeOriginal(stream, buf, count, countWritten);
+}
+
+bool can_diag_server_init(CO_t *co) {
+    if (co == NULL || co->CANmodule == NULL || OD == NULL) {
+        return false;
+    }
+    s_diag.co = co;
+
+    /* CO_CANmodule_init() restored driver defaults, settings from OD win */
+    can_diag_apply_bus_off_config(co->CANmodule);
+    co->CANmodule->syncIdent = (uint16_t)(OD_PERSIST_COMM.x1005_COB_ID_SYNCMessage & 0x7FFU);
+    if (!CO_CANmodule_setTxShaper(co->CANmodule, OD_RAM.x2104_CANtxShaper.bulkClasses,
+                                  OD_RAM.x2104_CANtxShaper.bulkShare, OD_RAM.x2104_CANtxShaper.burstFrames)) {
+        ESP_LOGW(TAG, "Invalid TX shaper settings in 0x2104, driver defaults used");
+    }
+    if (!can_diag_apply_rx_fast(co->CANmodule, 0U, 0U)) {
+        ESP_LOGW(TAG, "Invalid fast receive lane settings in 0x2110, driver defaults used");
+    }
+    can_diag_apply_tx_lifetimes(co, OD_RAM.x2106_CANtxFreshness.enable != 0);
+    CO_CANmodule_initCallbackBusOff(co->CANmodule, &s_diag, can_diag_bus_off_recovered);
+
+    s_diag.busOffExt.object = &s_diag;
+    s_diag.busOffExt.read = can_diag_read_bus_off;
+    s_diag.busOffExt.write = can_diag_write_bus_off;
+    if (OD_extension_init(OD_ENTRY_H2100_CANbusOffRecovery, &s_diag.busOffExt) != ODR_OK) {
+        ESP_LOGW(TAG, "Could not register 0x2100 extension");
+        return false;
+    }
+
+    s_diag.trafficExt.object = &s_diag;
+    s_diag.trafficExt.read = can_diag_read_traffic;
+    s_diag.trafficExt.write = NULL; /* read-only */
+    if (OD_extension_init(OD_ENTRY_H2101_CANtrafficStatistics, &s_diag.trafficExt) != ODR_OK) {
+        ESP_LOGW(TAG, "Could not register 0x2101 extension");
+        return false;
+    }
+
+    s_diag.captureExt.object = &s_diag;
+    s_diag.captureExt.read = can_diag_read_capture;
+    s_diag.captureExt.write = can_diag_write_capture;
+    if (OD_extension_init(OD_ENTRY_H2102_CANcapture, &s_diag.captureExt) != ODR_OK) {
+        ESP_LOGW(TAG, "Could not register 0x2102 extension");
+        return false;
+    }
+
+    s_diag.rxLanesExt.object = &s_diag;
+    s_diag.rxLanesExt.read = can_diag_read_rx_lanes;
+    s_diag.rxLanesExt.write = NULL; /* read-only */
+    if (OD_extension_init(OD_ENTRY_H2103_CANrxLanes, &s_diag.rxLanesExt) != ODR_OK) {
+        ESP_LOGW(TAG, "Could not register 0x2103 extension");
+        return false;
+    }
+
+    s_diag.txShaperExt.object = &s_diag;
+    s_diag.txShaperExt.read = can_diag_read_tx_shaper;
+    s_diag.txShaperExt.write = can_diag_write_tx_shaper;
+    if (OD_extension_init(OD_ENTRY_H2104_CANtxShaper, &s_diag.txShaperExt) != ODR_OK) {
+        ESP_LOGW(TAG, "Could not register 0x2104 extension");
+        return false;
+    }
+
+    s_diag.syncTpdoExt.object = &s_diag;
+    s_diag.syncTpdoExt.read = can_diag_read_sync_tpdo;
+    s_diag.syncTpdoExt.write = NULL; /* read-only */
+    if (OD_extension_init(OD_ENTRY_H2105_CANsyncTPDO, &s_diag.syncTpdoExt) != ODR_OK) {
+        ESP_LOGW(TAG, "Could not register 0x2105 extension");
+        return false;
+    }
+
+    s_diag.syncQueueExt.object = &s_diag;
+    s_diag.syncQueueExt.read = can_diag_read_sync_queue;
+    s_diag.syncQueueExt.write = NULL; /* read-only */
+    if (OD_extension_init(OD_ENTRY_H210A_CANsyncTPDOqueue, &s_diag.syncQueueExt) != ODR_OK) {
+        ESP_LOGW(TAG, "Could not register 0x210A extension");
+        return false;
+    }
+
+    s_diag.txFreshnessExt.object = &s_diag;
+    s_diag.txFreshnessExt.read = can_diag_read_tx_freshness;
+    s_diag.txFreshnessExt.write = can_diag_write_tx_freshness;
+    if (OD_extension_init(OD_ENTRY_H2106_CANtxFreshness, &s_diag.txFreshnessExt) != ODR_OK) {
+        ESP_LOGW(TAG, "Could not register 0x2106 extension");
+        return false;
+    }
+
+    s_diag.sendLatencyExt.object = &s_diag;
+    s_diag.sendLatencyExt.read = can_diag_read_send_latency;
+    s_diag.sendLatencyExt.write = can_diag_write_send_latency;
+    if (OD_extension_init(OD_ENTRY_H210E_CANsendLatency, &s_diag.sendLatencyExt) != ODR_OK) {
+        ESP_LOGW(TAG, "Could not register 0x210E extension");
+        return false;
+    }
+
+    s_diag.rxLatencyExt.object = &s_diag;
+    s_diag.rxLatencyExt.read = can_diag_read_rx_latency;
+    s_diag.rxLatencyExt.write = NULL; /* read-only */
+    if (OD_extension_init(OD_ENTRY_H210F_CANrxLatency, &s_diag.rxLatencyExt) != ODR_OK) {
+        ESP_LOGW(TAG, "Could not register 0x210F extension");
+        return false;
+    }
+
+    s_diag.rxFastExt.object = &s_diag;
+    s_diag.rxFastExt.read = OD_readOriginal;
+    s_diag.rxFastExt.write = can_diag_write_rx_fast;
+    if (OD_extension_init(OD_ENTRY_H2110_CANrxFastLane, &s_diag.rxFastExt) != ODR_OK) {
+        ESP_LOGW(TAG, "Could not register 0x2110 extension");
+        return false;
+    }
+
+    ESP_LOGI(TAG, "CAN diagnostic objects registered");
+    return true;
+}
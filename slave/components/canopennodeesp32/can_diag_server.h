@@ -0,0 +1,17 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "CANopen.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Link CAN driver diagnostics and settings (objects 0x2100-) to the OD.
+ *  Call after CO_CANopenInit() on every communication reset. */
+bool can_diag_server_init(CO_t *co);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,329 @@
+#include "can_loadgen.h"
+
+#include <string.h>
+#include <stdint.h>
+
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+
+#include "OD.h"
+
+static const char *TAG = "can_loadgen";
+
+/* Frames are generated from a 1 ms timer. At 1 Mbit/s this is up to about 21
+ * frames per tick (DLC 0), well within the generator buffers plus the frames
+ * held by the controller. */
+#define CAN_LOADGEN_TICK_US 1000
+#define CAN_LOADGEN_FPS_MAX 25000
+#define CAN_LOADGEN_WINDOW_US 1000000
+
+/* Data bytes after the sequence number: alternating bits, so the frame
+ * length does not depend on stuff bits */
+#define CAN_LOADGEN_FILL 0x55
+
+typedef struct {
+    CO_t *co;
+    OD_extension_t ext;
+    esp_timer_handle_t timer;
+    SemaphoreHandle_t lock;  /* tick against start and stop */
+    bool running;
+    uint16_t bufFirst;       /* first generator buffer in txArray */
+    uint16_t bufNext;        /* round robin over the generator buffers */
+    uint16_t nextIdent;
+    uint32_t sequence;       /* first 4 data bytes, little endian, for loss detection at receivers */
+    int64_t last_us;
+    uint64_t credit_mframes; /* frames owed to the configured rate, 1/1000 frame */
+    uint32_t framesQueued;
+    uint32_t txOverflow;
+    /* driver counters at start */
+    uint32_t txFramesBase;
+    uint64_t txDelaySumBase;
+    uint32_t busErrorsBase;
+    uint32_t arbLostBase;
+    uint32_t txFailedBase;
+    /* frames per second window */
+    int64_t windowStart_us;
+    uint32_t windowFrames;
+    uint32_t achievedFps;
+} can_loadgen_t;
+
+static can_loadgen_t s_loadgen = {0};
+
+#if CO_CONFIG_LOADGEN_TX_CNT > 0
+
+/* Queue one frame in a free generator buffer */
+static void can_loadgen_send_one(can_loadgen_t *lg, CO_CANmodule_t *CANmodule) {
+    uint16_t first = OD_RAM.x2108_CANloadGenerator.cobIdFirst;
+    uint16_t last = OD_RAM.x2108_CANloadGenerator.cobIdLast;
+    uint8_t dlc = OD_RAM.x2108_CANloadGenerator.DLC;
+    CO_CANtx_t *buffer = NULL;
+    uint16_t index = 0;
+    uint8_t i;
+
+    for (i = 0; i < CO_CONFIG_LOADGEN_TX_CNT; i++) {
+        index = lg->bufFirst + lg->bufNext;
+        lg->bufNext = (lg->bufNext + 1) % CO_CONFIG_LOADGEN_TX_CNT;
+        if (!CANmodule->txArray[index].bufferFull) {
+            buffer = &CANmodule->txArray[index];
+            break;
+        }
+    }
+    if (buffer == NULL) {
+        /* offered load is above what the bus takes from this node */
+        lg->txOverflow++;
+        return;
+    }
+
+    if (lg->nextIdent < first || lg->nextIdent > last) {
+        lg->nextIdent = first;
+    }
+    buffer = CO_CANtxBufferInit(CANmodule, index, lg->nextIdent, false, dlc, false);
+    lg->nextIdent = (lg->nextIdent >= last) ? first : (uint16_t)(lg->nextIdent + 1);
+
+    memset(buffer->data, CAN_LOADGEN_FILL, sizeof(buffer->data));
+    for (i = 0; i < dlc && i < 4; i++) {
+        buffer->data[i] = (uint8_t)(lg->sequence >> (8 * i));
+    }
+    lg->sequence++;
+
+    if (CO_CANsend(CANmodule, buffer) == CO_ERROR_NO) {
+        lg->framesQueued++;
+    } else {
+        lg->txOverflow++;
+    }
+}
+
+/* Runs in the esp_timer task every CAN_LOADGEN_TICK_US */
+static void can_loadgen_tick(void *arg) {
+    can_loadgen_t *lg = (can_loadgen_t *)arg;
+    CO_CANmodule_t *CANmodule;
+    uint64_t burst_mframes;
+    int64_t now;
+
+    xSemaphoreTake(lg->lock, portMAX_DELAY);
+    if (!lg->running) {
+        xSemaphoreGive(lg->lock);
+        return;
+    }
+    CANmodule = lg->co->CANmodule;
+    now = esp_timer_get_time();
+
+    if (CO_NMT_getInternalState(lg->co->NMT) == CO_NMT_OPERATIONAL) {
+        uint16_t burst = OD_RAM.x2108_CANloadGenerator.burstFrames;
+        uint64_t fps = OD_RAM.x2108_CANloadGenerator.framesPerSecond;
+        uint64_t limit_mframes;
+
+        /* Frames are sent in bursts of burstFrames, spaced so the average
+         * is framesPerSecond. A late tick does not cause a catch-up storm. */
+        burst_mframes = (uint64_t)burst * 1000U;
+        limit_mframes = 2U * burst_mframes + fps * CAN_LOADGEN_TICK_US / 1000U;
+        lg->credit_mframes += fps * (uint64_t)(now - lg->last_us) / 1000U;
+        if (lg->credit_mframes > limit_mframes) {
+            lg->credit_mframes = limit_mframes;
+        }
+        while (lg->credit_mframes >= burst_mframes) {
+            uint16_t k;
+
+            for (k = 0; k < burst; k++) {
+                can_loadgen_send_one(lg, CANmodule);
+            }
+            lg->credit_mframes -= burst_mframes;
+        }
+    } else {
+        /* NMT stop or pre-operational silences the generator */
+        lg->credit_mframes = 0;
+    }
+    lg->last_us = now;
+
+    if (now - lg->windowStart_us >= CAN_LOADGEN_WINDOW_US) {
+        uint32_t frames = CANmodule->txDelayLoadGen.frames;
+
+        lg->achievedFps =
+            (uint32_t)((uint64_t)(frames - lg->windowFrames) * 1000000U / (uint64_t)(now - lg->windowStart_us));
+        lg->windowFrames = frames;
+        lg->windowStart_us = now;
+    }
+    xSemaphoreGive(lg->lock);
+}
+
+static void can_loadgen_start(can_loadgen_t *lg) {
+    CO_CANmodule_t *CANmodule = lg->co->CANmodule;
+    twai_status_info_t status = {0};
+
+    xSemaphoreTake(lg->lock, portMAX_DELAY);
+    if (!lg->running) {
+        (void)twai_get_status_info(&status);
+        lg->bufFirst = CANmodule->txSize - CO_CONFIG_LOADGEN_TX_CNT;
+        lg->bufNext = 0;
+        lg->nextIdent = OD_RAM.x2108_CANloadGenerator.cobIdFirst;
+        lg->sequence = 0;
+        lg->framesQueued = 0;
+        lg->txOverflow = 0;
+        lg->txFramesBase = CANmodule->txDelayLoadGen.frames;
+        lg->txDelaySumBase = CANmodule->txDelayLoadGen.sumDelay_us;
+        CANmodule->txDelayLoadGen.maxDelay_us = 0;
+        lg->busErrorsBase = status.bus_error_count;
+        lg->arbLostBase = status.arb_lost_count;
+        lg->txFailedBase = status.tx_failed_count;
+        lg->last_us = esp_timer_get_time();
+        lg->credit_mframes = (uint64_t)OD_RAM.x2108_CANloadGenerator.burstFrames * 1000U;
+        lg->windowStart_us = lg->last_us;
+        lg->windowFrames = lg->txFramesBase;
+        lg->achievedFps = 0;
+        lg->running = esp_timer_start_periodic(lg->timer, CAN_LOADGEN_TICK_US) == ESP_OK;
+    }
+    xSemaphoreGive(lg->lock);
+
+    if (lg->running) {
+        ESP_LOGI(TAG, "Generating %lu frames/s, COB-ID 0x%03X..0x%03X, DLC %u, bursts of %u",
+                 (unsigned long)OD_RAM.x2108_CANloadGenerator.framesPerSecond,
+                 OD_RAM.x2108_CANloadGenerator.cobIdFirst, OD_RAM.x2108_CANloadGenerator.cobIdLast,
+                 OD_RAM.x2108_CANloadGenerator.DLC, OD_RAM.x2108_CANloadGenerator.burstFrames);
+    } else {
+        ESP_LOGW(TAG, "Timer start failed");
+    }
+}
+
+static ODR_t can_loadgen_read(OD_stream_t *stream, void *buf, OD_size_t count, OD_size_t *countRead) {
+    can_loadgen_t *lg = (can_loadgen_t *)stream->object;
+
+    if (stream->dataOffset == 0U) {
+        const CO_CANmodule_t *CANmodule = lg->co->CANmodule;
+        const CO_CANtxDelay_t *txDelay = &CANmodule->txDelayLoadGen;
+        uint32_t frames = txDelay->frames - lg->txFramesBase;
+        twai_status_info_t status = {0};
+
+        (void)twai_get_status_info(&status);
+        OD_RAM.x2108_CANloadGenerator.framesQueued = lg->framesQueued;
+        OD_RAM.x2108_CANloadGenerator.framesTransmitted = frames;
+        OD_RAM.x2108_CANloadGenerator.achievedFramesPerSecond = lg->running ? lg->achievedFps : 0;
+        OD_RAM.x2108_CANloadGenerator.txOverflow = lg->txOverflow;
+        OD_RAM.x2108_CANloadGenerator.queueLatencyAverage =
+            frames > 0 ? (uint32_t)((txDelay->sumDelay_us - lg->txDelaySumBase) / frames) : 0;
+        OD_RAM.x2108_CANloadGenerator.queueLatencyMax = txDelay->maxDelay_us;
+        OD_RAM.x2108_CANloadGenerator.busLoad = CANmodule->traffic.busLoad_permille;
+        OD_RAM.x2108_CANloadGenerator.txErrorCounter = (uint8_t)status.tx_error_counter;
+        OD_RAM.x2108_CANloadGenerator.rxErrorCounter = (uint8_t)status.rx_error_counter;
+        OD_RAM.x2108_CANloadGenerator.busErrors = status.bus_error_count - lg->busErrorsBase;
+        OD_RAM.x2108_CANloadGenerator.arbitrationLost = status.arb_lost_count - lg->arbLostBase;
+        OD_RAM.x2108_CANloadGenerator.txFailed = status.tx_failed_count - lg->txFailedBase;
+    }
+    return OD_readOriginal(stream, buf, count, countRead);
+}
+
+static ODR_t can_loadgen_write(OD_stream_t *stream, const void *buf, OD_size_t count, OD_size_t *countWritten) {
+    can_loadgen_t *lg = (can_loadgen_t *)stream->object;
+    ODR_t ret;
+
+    if (buf == NULL || count != stream->dataLength) {
+        return ODR_TYPE_MISMATCH;
+    }
+    switch (stream->subIndex) {
+    case 1:
+        if (CO_getUint8(buf) > 1) {
+            return ODR_INVALID_VALUE;
+        }
+        break;
+    case 2:
+        if (CO_getUint16(buf) > OD_RAM.x2108_CANloadGenerator.cobIdLast) {
+            return ODR_INVALID_VALUE;
+        }
+        break;
+    case 3:
+        if (CO_getUint16(buf) > 0x7FF || CO_getUint16(buf) < OD_RAM.x2108_CANloadGenerator.cobIdFirst) {
+            return ODR_INVALID_VALUE;
+        }
+        break;
+    case 4:
+        if (CO_getUint8(buf) > 8) {
+            return ODR_INVALID_VALUE;
+        }
+        break;
+    case 5:
+        if (CO_getUint32(buf) > CAN_LOADGEN_FPS_MAX) {
+            return ODR_VALUE_HIGH;
+        }
+        break;
+    case 6:
+        /* a burst larger than the generator buffers would only overflow */
+        if (CO_getUint16(buf) == 0 || CO_getUint16(buf) > CO_CONFIG_LOADGEN_TX_CNT) {
+            return ODR_INVALID_VALUE;
+        }
+        break;
+    default:
+        break;
+    }
+
+    ret = OD_writeOriginal(stream, buf, count, countWritten);
+    if (ret == ODR_OK && stream->subIndex == 1) {
+        if (CO_getUint8(buf) != 0) {
+            can_loadgen_start(lg);
+        } else {
+            can_loadgen_stop();
+        }
+    }
+    return ret;
+}
+
+bool can_loadgen_init(CO_t *co) {
+    if (co == NULL || co->CANmodule == NULL || OD == NULL) {
+        return false;
+    }
+    s_loadgen.co = co;
+    if (s_loadgen.lock == NULL) {
+        const esp_timer_create_args_t timerArgs = {
+            .callback = can_loadgen_tick,
+            .arg = &s_loadgen,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "CO_loadgen",
+            .skip_unhandled_events = true,
+        };
+
+        s_loadgen.lock = xSemaphoreCreateMutex();
+        if (s_loadgen.lock == NULL || esp_timer_create(&timerArgs, &s_loadgen.timer) != ESP_OK) {
+            ESP_LOGE(TAG, "Load generator setup failed");
+            return false;
+        }
+    }
+
+    s_loadgen.ext.object = &s_loadgen;
+    s_loadgen.ext.read = can_loadgen_read;
+    s_loadgen.ext.write = can_loadgen_write;
+    if (OD_extension_init(OD_ENTRY_H2108_CANloadGenerator, &s_loadgen.ext) != ODR_OK) {
+        ESP_LOGW(TAG, "Could not register 0x2108 extension");
+        return false;
+    }
+
+    /* still enabled before communication reset, statistics restart */
+    if (OD_RAM.x2108_CANloadGenerator.enable != 0) {
+        can_loadgen_start(&s_loadgen);
+    }
+    return true;
+}
+
+void can_loadgen_stop(void) {
+    if (s_loadgen.lock == NULL) {
+        return;
+    }
+    /* after the lock no tick is in progress and later ones return at once */
+    xSemaphoreTake(s_loadgen.lock, portMAX_DELAY);
+    s_loadgen.running = false;
+    xSemaphoreGive(s_loadgen.lock);
+    (void)esp_timer_stop(s_loadgen.timer);
+}
+
+#else /* CO_CONFIG_LOADGEN_TX_CNT > 0 */
+
+bool can_loadgen_init(CO_t *co) {
+    (void)co;
+    (void)s_loadgen;
+    ESP_LOGW(TAG, "No generator buffers, CO_CONFIG_LOADGEN_TX_CNT is 0");
+    return false;
+}
+
+void can_loadgen_stop(void) {
+}
+
+#endif /* CO_CONFIG_LOADGEN_TX_CNT > 0 */
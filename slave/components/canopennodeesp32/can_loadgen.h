@@ -0,0 +1,24 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "CANopen.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** Bus load generator for capacity tests, configured and enabled with OD
+ *  0x2108. Synthetic frames go through CO_CANsend() from the
+ *  CO_CONFIG_LOADGEN_TX_CNT buffers at the end of txArray, only while the
+ *  node is NMT operational. Call after CO_CANopenInit() on every
+ *  communication reset. */
+bool can_loadgen_init(CO_t *co);
+
+/** Stop generating before CO_CANmodule_disable(). The OD setting is kept, so
+ *  can_loadgen_init() resumes it after communication reset. */
+void can_loadgen_stop(void);
+
+#ifdef __cplusplus
+}
+#endif
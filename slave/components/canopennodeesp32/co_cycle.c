@@ -0,0 +1,127 @@
+#include "co_cycle.h"
+
+#include <string.h>
+
+#include "esp_log.h"
+
+#include "OD.h"
+
+static const char *TAG = "co_cycle";
+
+static OD_extension_t s_cycleExt;
+
+/* esp_timer task, or timer ISR with CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD */
+static void IRAM_ATTR co_cycle_tick(void *arg) {
+    co_cycle_t *cycle = (co_cycle_t *)arg;
+    TaskHandle_t task = *cycle->task;
+
+    cycle->ticks++;
+    if (task == NULL) {
+        return;
+    }
+#if CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(task, &woken);
+    if (woken == pdTRUE) {
+        esp_timer_isr_dispatch_need_yield();
+    }
+#else
+    xTaskNotifyGive(task);
+#endif
+}
+
+bool co_cycle_start(co_cycle_t *cycle, TaskHandle_t *task, uint32_t period_us, const char *name) {
+    const esp_timer_create_args_t args = {
+        .callback = co_cycle_tick,
+        .arg = cycle,
+#if CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD
+        .dispatch_method = ESP_TIMER_ISR,
+#else
+        .dispatch_method = ESP_TIMER_TASK,
+#endif
+        .name = name,
+        .skip_unhandled_events = false,
+    };
+
+    if (cycle == NULL || task == NULL || period_us < CO_CYCLE_PERIOD_MIN_US) {
+        return false;
+    }
+    memset(cycle, 0, sizeof(*cycle));
+    cycle->task = task;
+    cycle->period_us = period_us;
+    cycle->last_us = esp_timer_get_time();
+    if (esp_timer_create(&args, &cycle->timer) != ESP_OK) {
+        ESP_LOGE(TAG, "Timer %s creation failed", name);
+        return false;
+    }
+    if (esp_timer_start_periodic(cycle->timer, period_us) != ESP_OK) {
+        ESP_LOGE(TAG, "Timer %s start failed", name);
+        esp_timer_delete(cycle->timer);
+        cycle->timer = NULL;
+        return false;
+    }
+    ESP_LOGI(TAG, "%s: %lu us cycle", name, (unsigned long)period_us);
+    return true;
+}
+
+uint32_t co_cycle_wait(co_cycle_t *cycle) {
+    int64_t now_us = esp_timer_get_time();
+    uint32_t runTime_us = (uint32_t)(now_us - cycle->last_us);
+    uint32_t ticks;
+    uint32_t timeDifference_us;
+
+    if (cycle->cycles > 0U && runTime_us > cycle->maxRunTime_us) {
+        cycle->maxRunTime_us = runTime_us;
+    }
+
+    /* Expiration during the run: go on without blocking */
+    if (cycle->ticks == cycle->ticksSeen) {
+        (void)ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    } else {
+        (void)ulTaskNotifyTake(pdTRUE, 0);
+    }
+
+    ticks = cycle->ticks;
+    if ((uint32_t)(ticks - cycle->ticksSeen) > 1U) {
+        cycle->overruns += ticks - cycle->ticksSeen - 1U;
+    }
+    cycle->ticksSeen = ticks;
+
+    now_us = esp_timer_get_time();
+    timeDifference_us = (uint32_t)(now_us - cycle->last_us);
+    cycle->last_us = now_us;
+    cycle->cycles++;
+    cycle->lastTimeDifference_us = timeDifference_us;
+    if (timeDifference_us > cycle->maxTimeDifference_us) {
+        cycle->maxTimeDifference_us = timeDifference_us;
+    }
+    return timeDifference_us;
+}
+
+static ODR_t co_cycle_read(OD_stream_t *stream, void *buf, OD_size_t count, OD_size_t *countRead) {
+    const co_cycle_t *cycle = (const co_cycle_t *)stream->object;
+
+    if (stream->dataOffset == 0U) {
+        OD_RAM.x210B_COcycleTimer.period = cycle->period_us;
+        OD_RAM.x210B_COcycleTimer.cycles = cycle->cycles;
+        OD_RAM.x210B_COcycleTimer.overruns = cycle->overruns;
+        OD_RAM.x210B_COcycleTimer.lastTimeDifference = cycle->lastTimeDifference_us;
+        OD_RAM.x210B_COcycleTimer.maxTimeDifference = cycle->maxTimeDifference_us;
+        OD_RAM.x210B_COcycleTimer.maxRunTime = cycle->maxRunTime_us;
+    }
+    return OD_readOriginal(stream, buf, count, countRead);
+}
+
+bool co_cycle_od_init(co_cycle_t *cycle) {
+    if (cycle == NULL || OD == NULL) {
+        return false;
+    }
+    s_cycleExt.object = cycle;
+    s_cycleExt.read = co_cycle_read;
+    s_cycleExt.write = NULL; /* read-only */
+    if (OD_extension_init(OD_ENTRY_H210B_COcycleTimer, &s_cycleExt) != ODR_OK) {
+        ESP_LOGW(TAG, "Could not register 0x210B extension");
+        return false;
+    }
+    return true;
+}
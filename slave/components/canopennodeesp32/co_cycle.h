@@ -0,0 +1,50 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "CANopen.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Shortest supported cycle. Below it esp_timer dispatch and the CANopen
+ * processing itself take a too large share of the CPU. */
+#define CO_CYCLE_PERIOD_MIN_US 250
+
+/** Fixed CANopen processing cycle from a periodic esp_timer, independent of
+ *  the FreeRTOS tick. The timer notifies the task, co_cycle_wait() returns
+ *  the measured time since the previous run and counts cycles, which the
+ *  task did not run in time (overruns). */
+typedef struct {
+    esp_timer_handle_t timer;
+    TaskHandle_t *task;            /* notified on every cycle */
+    uint32_t period_us;
+    volatile uint32_t ticks;       /* timer expirations, written by the timer */
+    uint32_t ticksSeen;            /* expirations consumed by co_cycle_wait() */
+    int64_t last_us;               /* start of the previous run */
+    uint32_t cycles;               /* runs, including early ones by other notifications */
+    uint32_t overruns;             /* expirations, which found the task still busy */
+    uint32_t lastTimeDifference_us;
+    uint32_t maxTimeDifference_us;
+    uint32_t maxRunTime_us;        /* from co_cycle_wait() return to the next call */
+} co_cycle_t;
+
+/** Start the cycle timer, period_us >= CO_CYCLE_PERIOD_MIN_US. task is read
+ *  on every expiration, so it may be set after the call. */
+bool co_cycle_start(co_cycle_t *cycle, TaskHandle_t *task, uint32_t period_us, const char *name);
+
+/** Block until the next cycle or another notification of the task (callbacks
+ *  pre), return the time since the previous return in microseconds. */
+uint32_t co_cycle_wait(co_cycle_t *cycle);
+
+/** Expose the statistics of cycle in OD 0x210B. Call after CO_CANopenInit()
+ *  on every communication reset. */
+bool co_cycle_od_init(co_cycle_t *cycle);
+
+#ifdef __cplusplus
+}
+#endif
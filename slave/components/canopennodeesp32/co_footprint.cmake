@@ -0,0 +1,34 @@
+# Prints RAM taken by the static CANopen objects (COO_* symbols of CANopen.c,
+# CO_CONFIG_STATIC_OBJECTS) after the build.
+#   cmake -DNM=<nm> -DELF=<file.elf> -P co_footprint.cmake
+# The same breakdown is readable at runtime from object 0x210C.
+
+if(NOT NM OR NOT ELF)
+    message(FATAL_ERROR "co_footprint.cmake: NM and ELF must be set")
+endif()
+
+execute_process(
+    COMMAND ${NM} --print-size --size-sort --radix=d ${ELF}
+    OUTPUT_VARIABLE symbols
+    RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(WARNING "co_footprint.cmake: ${NM} failed on ${ELF}")
+    return()
+endif()
+
+string(REGEX MATCHALL "[0-9]+ [0-9]+ [bBdD] COO[A-Za-z0-9_]*" objects "${symbols}")
+if(NOT objects)
+    message(STATUS "CANopen objects: heap allocated (CO_CONFIG_STATIC_OBJECTS 0)")
+    return()
+endif()
+
+set(total 0)
+foreach(object ${objects})
+    string(REGEX REPLACE "^[0-9]+ ([0-9]+) [bBdD] (.*)$" "\\1;\\2" fields "${object}")
+    list(GET fields 0 size)
+    list(GET fields 1 name)
+    math(EXPR size "${size}")
+    math(EXPR total "${total} + ${size}")
+    message(STATUS "  ${name}: ${size}")
+endforeach()
+message(STATUS "CANopen objects: ${total} bytes static")
@@ -0,0 +1,321 @@
+/*
+ * Execution time profiler for the CANopen processing stages.
+ *
+ * @file        co_profiler.c
+ * @ingroup     CO_driver
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "co_profiler.h"
+
+#if CO_CONFIG_PROFILER
+
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_rom_sys.h"
+#include "CANopen.h"
+#include "OD.h"
+
+static const char *TAG = "co_profiler";
+#endif
+
+/* Log scale histogram: values below 8 have their own bin, above that every
+ * power of two is split in 4 bins. 96 bins reach 2^25 ticks (140 ms at
+ * 240 MHz), longer runs are counted in the last one. */
+#define CO_PROF_BINS 96
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t min;
+    uint32_t max;
+    uint64_t sum;
+    uint32_t bins[CO_PROF_BINS];
+} co_prof_stats_t;
+
+#ifdef ESP_PLATFORM
+typedef struct
+{
+    TaskHandle_t handle;
+    uint32_t runTime0; /* run time counters at the start of the window */
+    uint32_t totalTime0;
+} co_prof_task_stats_t;
+#endif
+
+typedef struct
+{
+    co_prof_stats_t stage[CO_PROF_STAGE_CNT];
+    int64_t reset_us;
+#ifdef ESP_PLATFORM
+    co_prof_task_stats_t task[CO_PROF_TASK_CNT];
+    OD_extension_t ext;
+#endif
+} co_profiler_t;
+
+static co_profiler_t s_prof;
+
+#ifdef ESP_PLATFORM
+_Static_assert(sizeof(OD_RAM.x210D_COprofiler.report) == sizeof(co_prof_report_t),
+               "OD 0x210D report size must match co_prof_report_t");
+#endif
+
+static int64_t co_prof_time_us(void)
+{
+#ifdef ESP_PLATFORM
+    return esp_timer_get_time();
+#else
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#endif
+}
+
+static uint32_t co_prof_ticks_per_us(void)
+{
+#ifdef ESP_PLATFORM
+    return esp_rom_get_cpu_ticks_per_us();
+#else
+    return 1000U;
+#endif
+}
+
+static uint32_t co_prof_bin(uint32_t ticks)
+{
+    uint32_t msb;
+
+    if (ticks < 8U)
+    {
+        return ticks;
+    }
+    msb = 31U - (uint32_t)__builtin_clz(ticks);
+    if (msb > CO_PROF_BINS / 4U)
+    {
+        return CO_PROF_BINS - 1U;
+    }
+    return (msb - 1U) * 4U + ((ticks >> (msb - 2U)) & 3U);
+}
+
+/* Highest value counted in bin */
+static uint32_t co_prof_bin_max(uint32_t bin)
+{
+    uint32_t msb;
+
+    if (bin < 8U)
+    {
+        return bin;
+    }
+    msb = bin / 4U + 1U;
+    return ((4U + (bin & 3U) + 1U) << (msb - 2U)) - 1U;
+}
+
+/******************************************************************************/
+void co_prof_record(co_prof_stage_t stage, uint32_t ticks)
+{
+    co_prof_stats_t *st = &s_prof.stage[stage];
+
+    if ((st->count == 0U) || (ticks < st->min))
+    {
+        st->min = ticks;
+    }
+    if (ticks > st->max)
+    {
+        st->max = ticks;
+    }
+    st->sum += ticks;
+    st->bins[co_prof_bin(ticks)]++;
+    st->count++;
+}
+
+#ifdef ESP_PLATFORM
+static void co_prof_task_window(co_prof_task_stats_t *task)
+{
+#if configGENERATE_RUN_TIME_STATS
+    task->runTime0 = (uint32_t)ulTaskGetRunTimeCounter(task->handle);
+    task->totalTime0 = (uint32_t)portGET_RUN_TIME_COUNTER_VALUE();
+#else
+    (void)task;
+#endif
+}
+
+/******************************************************************************/
+void co_prof_task(co_prof_task_t task, TaskHandle_t handle)
+{
+    co_prof_task_stats_t *t = &s_prof.task[task];
+
+    t->handle = handle;
+    if (handle != NULL)
+    {
+        co_prof_task_window(t);
+    }
+}
+#endif
+
+/******************************************************************************/
+void co_prof_reset(void)
+{
+    memset(s_prof.stage, 0, sizeof(s_prof.stage));
+#ifdef ESP_PLATFORM
+    for (int i = 0; i < CO_PROF_TASK_CNT; i++)
+    {
+        if (s_prof.task[i].handle != NULL)
+        {
+            co_prof_task_window(&s_prof.task[i]);
+        }
+    }
+#endif
+    s_prof.reset_us = co_prof_time_us();
+}
+
+/* Smallest bin upper bound, below which permille of the samples are */
+static uint32_t co_prof_percentile(const co_prof_stats_t *st, uint32_t permille)
+{
+    uint32_t rank = (uint32_t)(((uint64_t)st->count * permille + 999U) / 1000U);
+    uint32_t seen = 0;
+
+    for (uint32_t bin = 0; bin < CO_PROF_BINS; bin++)
+    {
+        seen += st->bins[bin];
+        if (seen >= rank)
+        {
+            uint32_t value = co_prof_bin_max(bin);
+            return (value < st->max) ? value : st->max;
+        }
+    }
+    return st->max;
+}
+
+static uint32_t co_prof_ns(uint64_t ticks, uint32_t ticksPerUs)
+{
+    uint64_t ns = ticks * 1000U / ticksPerUs;
+    return (ns > UINT32_MAX) ? UINT32_MAX : (uint32_t)ns;
+}
+
+/******************************************************************************/
+/* Stages are written by their tasks meanwhile, a report may mix one sample
+ * more or less between the fields of a stage. */
+void co_prof_get_report(co_prof_report_t *report)
+{
+    uint32_t ticksPerUs = co_prof_ticks_per_us();
+
+    memset(report, 0, sizeof(*report));
+    report->version = CO_PROF_REPORT_VERSION;
+    report->ticksPerUs = ticksPerUs;
+    report->window_ms = (uint32_t)((co_prof_time_us() - s_prof.reset_us) / 1000);
+    report->stageCount = CO_PROF_STAGE_CNT;
+    report->taskCount = CO_PROF_TASK_CNT;
+
+    for (int i = 0; i < CO_PROF_STAGE_CNT; i++)
+    {
+        const co_prof_stats_t *st = &s_prof.stage[i];
+        co_prof_stage_report_t *r = &report->stage[i];
+
+        r->count = st->count;
+        if (st->count == 0U)
+        {
+            continue;
+        }
+        r->min_ns = co_prof_ns(st->min, ticksPerUs);
+        r->avg_ns = co_prof_ns(st->sum / st->count, ticksPerUs);
+        r->max_ns = co_prof_ns(st->max, ticksPerUs);
+        r->p50_ns = co_prof_ns(co_prof_percentile(st, 500), ticksPerUs);
+        r->p90_ns = co_prof_ns(co_prof_percentile(st, 900), ticksPerUs);
+        r->p99_ns = co_prof_ns(co_prof_percentile(st, 990), ticksPerUs);
+    }
+
+    for (int i = 0; i < CO_PROF_TASK_CNT; i++)
+    {
+        co_prof_task_report_t *r = &report->task[i];
+
+        r->cpuPermille = CO_PROF_NOT_AVAILABLE;
+#ifdef ESP_PLATFORM
+        const co_prof_task_stats_t *t = &s_prof.task[i];
+
+        if (t->handle == NULL)
+        {
+            continue;
+        }
+        r->stackFree = (uint32_t)uxTaskGetStackHighWaterMark(t->handle) * sizeof(StackType_t);
+#if configGENERATE_RUN_TIME_STATS
+        uint32_t run = (uint32_t)ulTaskGetRunTimeCounter(t->handle) - t->runTime0;
+        uint32_t total = (uint32_t)portGET_RUN_TIME_COUNTER_VALUE() - t->totalTime0;
+
+        r->cpuPermille = (total > 0U) ? (uint32_t)((uint64_t)run * 1000U / total) : 0U;
+#endif
+#endif
+    }
+}
+
+#ifdef ESP_PLATFORM
+static ODR_t co_prof_read(OD_stream_t *stream, void *buf, OD_size_t count, OD_size_t *countRead)
+{
+    if ((stream->subIndex == 2U) && (stream->dataOffset == 0U))
+    {
+        co_prof_report_t report;
+
+        co_prof_get_report(&report);
+        memcpy(OD_RAM.x210D_COprofiler.report, &report, sizeof(OD_RAM.x210D_COprofiler.report));
+    }
+    return OD_readOriginal(stream, buf, count, countRead);
+}
+
+/* Writing 1 to sub 1 clears the statistics, it reads back as 0 */
+static ODR_t co_prof_write(OD_stream_t *stream, const void *buf, OD_size_t count, OD_size_t *countWritten)
+{
+    if ((buf == NULL) || (count != stream->dataLength))
+    {
+        return ODR_TYPE_MISMATCH;
+    }
+    if (stream->subIndex == 1U)
+    {
+        if (CO_getUint8(buf) > 1U)
+        {
+            return ODR_INVALID_VALUE;
+        }
+        if (CO_getUint8(buf) == 1U)
+        {
+            co_prof_reset();
+        }
+        *countWritten = count;
+        return ODR_OK;
+    }
+    return OD_writeOriginal(stream, buf, count, countWritten);
+}
+
+/******************************************************************************/
+bool co_prof_od_init(void)
+{
+    if (OD == NULL)
+    {
+        return false;
+    }
+    if (s_prof.reset_us == 0)
+    {
+        s_prof.reset_us = co_prof_time_us();
+    }
+    s_prof.ext.object = &s_prof;
+    s_prof.ext.read = co_prof_read;
+    s_prof.ext.write = co_prof_write;
+    if (OD_extension_init(OD_ENTRY_H210D_COprofiler, &s_prof.ext) != ODR_OK)
+    {
+        ESP_LOGW(TAG, "Could not register 0x210D extension");
+        return false;
+    }
+    return true;
+}
+#endif /* ESP_PLATFORM */
+
+#endif /* CO_CONFIG_PROFILER */
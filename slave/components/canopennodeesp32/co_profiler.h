@@ -0,0 +1,165 @@
+/*
+ * Execution time profiler for the CANopen processing stages.
+ *
+ * @file        co_profiler.h
+ * @ingroup     CO_driver
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef CO_PROFILER_H
+#define CO_PROFILER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "301/CO_driver.h"
+
+/* Targets, which do not configure it (example blank), build without it */
+#ifndef CO_CONFIG_PROFILER
+#define CO_CONFIG_PROFILER 0
+#endif
+
+#if CO_CONFIG_PROFILER
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_cpu.h"
+#else
+#include <time.h>
+#endif
+#endif
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Processing stages measured by CO_PROF_BEGIN()/CO_PROF_END() in CANopen.c
+ */
+typedef enum
+{
+    CO_PROF_PROCESS, /**< whole CO_process(), when the node ID is configured */
+    CO_PROF_EM,
+    CO_PROF_NMT,
+    CO_PROF_SDO_SRV,
+    CO_PROF_HB_CONS,
+    CO_PROF_TIME,
+    CO_PROF_LSS,
+    CO_PROF_SYNC,
+    CO_PROF_RPDO,
+    CO_PROF_TPDO,
+    CO_PROF_STAGE_CNT
+} co_prof_stage_t;
+
+/**
+ * Tasks with CPU share and stack high water mark in the report
+ */
+typedef enum
+{
+    CO_PROF_TASK_MAIN,
+    CO_PROF_TASK_PERIODIC,
+    CO_PROF_TASK_TX,
+    CO_PROF_TASK_RX,
+    CO_PROF_TASK_CNT
+} co_prof_task_t;
+
+/* Report in OD 0x210D sub 2, read in one SDO upload. All values uint32_t,
+ * little endian, times in nanoseconds. */
+#define CO_PROF_REPORT_VERSION 1
+#define CO_PROF_NOT_AVAILABLE UINT32_MAX /* task values without FreeRTOS run time stats or on host */
+
+typedef struct
+{
+    uint32_t count;
+    uint32_t min_ns;
+    uint32_t avg_ns;
+    uint32_t max_ns;
+    uint32_t p50_ns; /**< percentiles are upper bounds of a histogram bin, */
+    uint32_t p90_ns; /**< at most 25 % above the real value */
+    uint32_t p99_ns;
+} co_prof_stage_report_t;
+
+typedef struct
+{
+    uint32_t cpuPermille; /**< of one core, since the statistics reset */
+    uint32_t stackFree;   /**< minimum free stack in bytes, 0 if not registered */
+} co_prof_task_report_t;
+
+typedef struct
+{
+    uint32_t version;
+    uint32_t ticksPerUs; /**< resolution of the raw measurement */
+    uint32_t window_ms;  /**< since the statistics reset */
+    uint32_t stageCount;
+    uint32_t taskCount;
+    co_prof_stage_report_t stage[CO_PROF_STAGE_CNT];
+    co_prof_task_report_t task[CO_PROF_TASK_CNT];
+} co_prof_report_t;
+
+#if CO_CONFIG_PROFILER
+
+/* CPU cycles on target, nanoseconds of the monotonic clock on the host.
+ * Differences are valid for intervals shorter than the 32 bit wrap around
+ * (17 s at 240 MHz, 4 s on host) and for a task, which does not change the
+ * core. */
+static inline uint32_t co_prof_now(void)
+{
+#ifdef ESP_PLATFORM
+    return (uint32_t)esp_cpu_get_cycle_count();
+#else
+    struct timespec ts;
+    (void)clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000U + (uint64_t)ts.tv_nsec);
+#endif
+}
+
+/** Add one measurement of ticks to stage. A stage is recorded by one task. */
+void co_prof_record(co_prof_stage_t stage, uint32_t ticks);
+
+/** Clear all statistics and start a new CPU share window. */
+void co_prof_reset(void);
+
+/** Fill report from the current statistics. */
+void co_prof_get_report(co_prof_report_t *report);
+
+#define CO_PROF_BEGIN(stage) const uint32_t co_prof_start_##stage = co_prof_now()
+#define CO_PROF_END(stage)   co_prof_record(CO_PROF_##stage, co_prof_now() - co_prof_start_##stage)
+
+#ifdef ESP_PLATFORM
+/** Register a task for the report, NULL removes it (task deleted). */
+void co_prof_task(co_prof_task_t task, TaskHandle_t handle);
+
+/** Expose the report in OD 0x210D. Call after CO_CANopenInit() on every
+ *  communication reset. */
+bool co_prof_od_init(void);
+
+#define CO_PROF_TASK(task, handle) co_prof_task(CO_PROF_TASK_##task, handle)
+#else
+/* Host: no FreeRTOS tasks and no OD 0x210D, the report is read directly */
+#define CO_PROF_TASK(task, handle) ((void)0)
+#endif
+
+#else /* CO_CONFIG_PROFILER */
+
+#define CO_PROF_BEGIN(stage)       ((void)0)
+#define CO_PROF_END(stage)         ((void)0)
+#define CO_PROF_TASK(task, handle) ((void)0)
+
+#endif /* CO_CONFIG_PROFILER */
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CO_PROFILER_H */
@@ -0,0 +1,506 @@
+/*
+ * CAN module object for Linux, SocketCAN or in-process virtual bus.
+ *
+ * @file        CO_driver_linux.c
+ * @ingroup     CO_driver
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations under the License.
+ */
+
+#include <errno.h>
+#include <poll.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <net/if.h>
+#include <sys/socket.h>
+#include <linux/can.h>
+#include <linux/can/error.h>
+#include <linux/can/raw.h>
+
+#include "301/CO_driver.h"
+
+/* Open SocketCAN raw socket on interface ifName, error frames enabled */
+static int
+CO_CANsocketOpen(const char* ifName) {
+    struct sockaddr_can addr;
+    can_err_mask_t errMask = CAN_ERR_CRTL | CAN_ERR_BUSOFF | CAN_ERR_RESTARTED;
+    int enable = 1;
+    int fd;
+
+    fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (fd < 0) {
+        return -1;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = (int)if_nametoindex(ifName);
+    if ((addr.can_ifindex == 0) || (setsockopt(fd, SOL_CAN_RAW, CAN_RAW_ERR_FILTER, &errMask, sizeof(errMask)) != 0)
+        || (setsockopt(fd, SOL_SOCKET, SO_RXQ_OVFL, &enable, sizeof(enable)) != 0)
+        || (bind(fd, (struct sockaddr*)&addr, sizeof(addr)) != 0)) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/* Receive timestamp, as esp_timer_get_time() on the ESP32 */
+static int64_t
+CO_CANtime_us(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((int64_t)ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+/* Pass frame to the transport. Returns false, if it has no space now. */
+static bool_t
+CO_CANwrite(CO_CANmodule_t* CANmodule, const CO_CANtx_t* buffer) {
+    bool_t rtr = (buffer->ident & 0x8000U) != 0U;
+
+    if (CANmodule->vbusPort != NULL) {
+        CO_vbusFrame_t frame;
+
+        frame.ident = (uint16_t)(buffer->ident & 0x07FFU);
+        frame.rtr = rtr;
+        frame.DLC = buffer->DLC;
+        memcpy(frame.data, buffer->data, sizeof(frame.data));
+        CO_vbus_send(CANmodule->vbusPort, &frame);
+    } else {
+        struct can_frame frame;
+
+        memset(&frame, 0, sizeof(frame));
+        frame.can_id = (buffer->ident & 0x07FFU) | (rtr ? CAN_RTR_FLAG : 0U);
+        frame.can_dlc = buffer->DLC;
+        memcpy(frame.data, buffer->data, sizeof(frame.data));
+        if (send(CANmodule->fd, &frame, sizeof(frame), MSG_DONTWAIT) != (ssize_t)sizeof(frame)) {
+            /* EAGAIN or ENOBUFS: kernel or interface queue is full */
+            return false;
+        }
+    }
+    CANmodule->txFrames++;
+    return true;
+}
+
+void
+CO_CANsetConfigurationMode(void* CANptr) {
+    /* Put CAN module in configuration mode */
+    (void)CANptr;
+}
+
+void
+CO_CANsetNormalMode(CO_CANmodule_t* CANmodule) {
+    /* Put CAN module in normal mode */
+    CANmodule->CANnormal = CANmodule->opened;
+}
+
+CO_ReturnError_t
+CO_CANmodule_init(CO_CANmodule_t* CANmodule, void* CANptr, CO_CANrx_t rxArray[], uint16_t rxSize, CO_CANtx_t txArray[],
+                  uint16_t txSize, uint16_t CANbitRate) {
+    const char* ifName = (CANptr != NULL) ? (const char*)CANptr : CO_CAN_VBUS_NAME;
+    uint16_t i;
+
+    /* verify arguments */
+    if (CANmodule == NULL || rxArray == NULL || txArray == NULL) {
+        return CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+    if (CANmodule->opened) {
+        CO_CANmodule_disable(CANmodule);
+    }
+
+    /* Configure object variables */
+    CANmodule->CANptr = CANptr;
+    CANmodule->rxArray = rxArray;
+    CANmodule->rxSize = rxSize;
+    CANmodule->txArray = txArray;
+    CANmodule->txSize = txSize;
+    CANmodule->CANerrorStatus = 0;
+    CANmodule->CANnormal = false;
+    CANmodule->useCANrxFilters = false; /* software filtering in CO_CANrxWait() */
+    CANmodule->bufferInhibitFlag = false;
+    CANmodule->firstCANtxMessage = true;
+    CANmodule->CANtxCount = 0U;
+    CANmodule->errOld = 0U;
+    CANmodule->fd = -1;
+    CANmodule->vbusPort = NULL;
+    CANmodule->txErrors = 0U;
+    CANmodule->rxErrors = 0U;
+    CANmodule->busOff = false;
+    CANmodule->rxDropped = 0U;
+    CANmodule->rxFrames = 0U;
+    CANmodule->txFrames = 0U;
+
+    for (i = 0U; i < rxSize; i++) {
+        rxArray[i].ident = 0U;
+        rxArray[i].mask = 0xFFFFU;
+        rxArray[i].object = NULL;
+        rxArray[i].CANrx_callback = NULL;
+    }
+    for (i = 0U; i < txSize; i++) {
+        txArray[i].bufferFull = false;
+    }
+
+    /* Mutexes live as long as the object, receive and timer threads may use them during communication reset */
+    if (!CANmodule->locksInit) {
+        pthread_mutex_init(&CANmodule->sendMutex, NULL);
+        pthread_mutex_init(&CANmodule->emcyMutex, NULL);
+        pthread_mutex_init(&CANmodule->odMutex, NULL);
+        CANmodule->locksInit = true;
+    }
+
+    /* Bitrate is configured outside, with "ip link set can0 type can bitrate 250000" */
+    (void)CANbitRate;
+
+    if (strcmp(ifName, CO_CAN_VBUS_NAME) == 0) {
+        CANmodule->vbusPort = CO_vbus_open();
+        if (CANmodule->vbusPort == NULL) {
+            return CO_ERROR_OUT_OF_MEMORY;
+        }
+    } else {
+        CANmodule->fd = CO_CANsocketOpen(ifName);
+        if (CANmodule->fd < 0) {
+            return CO_ERROR_SYSCALL;
+        }
+    }
+    CANmodule->opened = true;
+
+    return CO_ERROR_NO;
+}
+
+void
+CO_CANmodule_disable(CO_CANmodule_t* CANmodule) {
+    if ((CANmodule != NULL) && CANmodule->opened) {
+        CANmodule->CANnormal = false;
+        CANmodule->opened = false;
+        if (CANmodule->vbusPort != NULL) {
+            CO_vbus_close(CANmodule->vbusPort);
+            CANmodule->vbusPort = NULL;
+        }
+        if (CANmodule->fd >= 0) {
+            close(CANmodule->fd);
+            CANmodule->fd = -1;
+        }
+    }
+}
+
+CO_ReturnError_t
+CO_CANrxBufferInit(CO_CANmodule_t* CANmodule, uint16_t index, uint16_t ident, uint16_t mask, bool_t rtr, void* object,
+                   void (*CANrx_callback)(void* object, void* message)) {
+    CO_ReturnError_t ret = CO_ERROR_NO;
+
+    if ((CANmodule != NULL) && (object != NULL) && (CANrx_callback != NULL) && (index < CANmodule->rxSize)) {
+        /* buffer, which will be configured */
+        CO_CANrx_t* buffer = &CANmodule->rxArray[index];
+
+        /* Configure object variables */
+        buffer->object = object;
+        buffer->CANrx_callback = CANrx_callback;
+
+        /* CAN identifier and CAN mask, RTR in bit 11 */
+        buffer->ident = ident & 0x07FFU;
+        if (rtr) {
+            buffer->ident |= 0x0800U;
+        }
+        buffer->mask = (mask & 0x07FFU) | 0x0800U;
+    } else {
+        ret = CO_ERROR_ILLEGAL_ARGUMENT;
+    }
+
+    return ret;
+}
+
+CO_CANtx_t*
+CO_CANtxBufferInit(CO_CANmodule_t* CANmodule, uint16_t index, uint16_t ident, bool_t rtr, uint8_t noOfBytes,
+                   bool_t syncFlag) {
+    CO_CANtx_t* buffer = NULL;
+
+    if ((CANmodule != NULL) && (index < CANmodule->txSize)) {
+        /* get specific buffer */
+        buffer = &CANmodule->txArray[index];
+
+        /* CAN identifier and rtr */
+        buffer->ident = ((uint32_t)ident & 0x07FFU) | ((uint32_t)(rtr ? 0x8000U : 0U));
+        buffer->DLC = noOfBytes;
+        buffer->bufferFull = false;
+        buffer->syncFlag = syncFlag;
+    }
+
+    return buffer;
+}
+
+CO_ReturnError_t
+CO_CANsend(CO_CANmodule_t* CANmodule, CO_CANtx_t* buffer) {
+    CO_ReturnError_t err = CO_ERROR_NO;
+
+    /* Verify overflow */
+    if (buffer->bufferFull) {
+        if (!CANmodule->firstCANtxMessage) {
+            /* don't set error, if bootup message is still on buffers */
+            CANmodule->CANerrorStatus |= CO_CAN_ERRTX_OVERFLOW;
+        }
+        err = CO_ERROR_TX_OVERFLOW;
+    }
+
+    CO_LOCK_CAN_SEND(CANmodule);
+    /* send directly, if nothing is waiting, otherwise keep the order */
+    if (CANmodule->opened && (CANmodule->CANtxCount == 0U) && CO_CANwrite(CANmodule, buffer)) {
+        CANmodule->firstCANtxMessage = false;
+        CANmodule->bufferInhibitFlag = false;
+    } else if (!buffer->bufferFull) {
+        /* message will be sent by CO_CANmodule_process() */
+        buffer->bufferFull = true;
+        CANmodule->CANtxCount++;
+    }
+    CO_UNLOCK_CAN_SEND(CANmodule);
+
+    return err;
+}
+
+void
+CO_CANclearPendingSyncPDOs(CO_CANmodule_t* CANmodule) {
+    uint32_t tpdoDeleted = 0U;
+
+    CO_LOCK_CAN_SEND(CANmodule);
+    /* Frames already passed to the kernel can't be aborted, delete pending synchronous TPDOs in TX buffers */
+    if (CANmodule->CANtxCount != 0U) {
+        uint16_t i;
+        CO_CANtx_t* buffer = &CANmodule->txArray[0];
+        for (i = CANmodule->txSize; i > 0U; i--) {
+            if (buffer->bufferFull) {
+                if (buffer->syncFlag) {
+                    buffer->bufferFull = false;
+                    CANmodule->CANtxCount--;
+                    tpdoDeleted = 2U;
+                }
+            }
+            buffer++;
+        }
+    }
+    if (tpdoDeleted != 0U) {
+        CANmodule->CANerrorStatus |= CO_CAN_ERRTX_PDO_LATE;
+    }
+    CO_UNLOCK_CAN_SEND(CANmodule);
+}
+
+void
+CO_CANmodule_process(CO_CANmodule_t* CANmodule) {
+    uint32_t err;
+    uint16_t txErrors = CANmodule->txErrors;
+    uint16_t rxErrors = CANmodule->rxErrors;
+    uint16_t overflow;
+
+    /* send messages, which did not fit into the kernel queue */
+    CO_LOCK_CAN_SEND(CANmodule);
+    if (CANmodule->opened && (CANmodule->CANtxCount > 0U)) {
+        uint16_t i;
+        CO_CANtx_t* buffer = &CANmodule->txArray[0];
+
+        for (i = CANmodule->txSize; i > 0U; i--) {
+            if (buffer->bufferFull) {
+                if (!CO_CANwrite(CANmodule, buffer)) {
+                    break;
+                }
+                buffer->bufferFull = false;
+                CANmodule->CANtxCount--;
+                CANmodule->firstCANtxMessage = false;
+            }
+            buffer++;
+        }
+        /* Clear counter if no more messages */
+        if (i == 0U) {
+            CANmodule->CANtxCount = 0U;
+        }
+    }
+    CO_UNLOCK_CAN_SEND(CANmodule);
+
+    if (CANmodule->vbusPort != NULL) {
+        CANmodule->rxDropped = CO_vbus_overflowCount(CANmodule->vbusPort);
+    }
+    overflow = (CANmodule->rxDropped != 0U) ? 1U : 0U;
+
+    err = ((uint32_t)txErrors << 16) | ((uint32_t)rxErrors << 8) | overflow | (CANmodule->busOff ? 0x80U : 0U);
+
+    if (CANmodule->errOld != err) {
+        uint16_t status;
+
+        CO_LOCK_CAN_SEND(CANmodule);
+        status = CANmodule->CANerrorStatus;
+        CANmodule->errOld = err;
+
+        if (CANmodule->busOff) {
+            /* bus off */
+            status |= CO_CAN_ERRTX_BUS_OFF;
+        } else {
+            /* recalculate CANerrorStatus, first clear some flags */
+            status &= 0xFFFF
+                      ^ (CO_CAN_ERRTX_BUS_OFF | CO_CAN_ERRRX_WARNING | CO_CAN_ERRRX_PASSIVE | CO_CAN_ERRTX_WARNING
+                         | CO_CAN_ERRTX_PASSIVE);
+
+            /* rx bus warning or passive */
+            if (rxErrors >= 128) {
+                status |= CO_CAN_ERRRX_WARNING | CO_CAN_ERRRX_PASSIVE;
+            } else if (rxErrors >= 96) {
+                status |= CO_CAN_ERRRX_WARNING;
+            }
+
+            /* tx bus warning or passive */
+            if (txErrors >= 128) {
+                status |= CO_CAN_ERRTX_WARNING | CO_CAN_ERRTX_PASSIVE;
+            } else if (txErrors >= 96) {
+                status |= CO_CAN_ERRTX_WARNING;
+            }
+
+            /* if not tx passive clear also overflow */
+            if ((status & CO_CAN_ERRTX_PASSIVE) == 0) {
+                status &= 0xFFFF ^ CO_CAN_ERRTX_OVERFLOW;
+            }
+        }
+
+        if (overflow != 0) {
+            /* CAN RX bus overflow */
+            status |= CO_CAN_ERRRX_OVERFLOW;
+        }
+
+        CANmodule->CANerrorStatus = status;
+        CO_UNLOCK_CAN_SEND(CANmodule);
+    }
+}
+
+/* Error frame from SocketCAN, see linux/can/error.h */
+static void
+CO_CANerrorFrame(CO_CANmodule_t* CANmodule, const struct can_frame* frame) {
+    if ((frame->can_id & CAN_ERR_BUSOFF) != 0U) {
+        CANmodule->busOff = true;
+    }
+    if ((frame->can_id & CAN_ERR_RESTARTED) != 0U) {
+        CANmodule->busOff = false;
+    }
+    if ((frame->can_id & CAN_ERR_CRTL) != 0U) {
+        uint8_t crtl = frame->data[1];
+
+        if ((crtl & CAN_ERR_CRTL_RX_OVERFLOW) != 0U) {
+            CANmodule->rxDropped++;
+        }
+#ifdef CAN_ERR_CNT
+        if ((frame->can_id & CAN_ERR_CNT) != 0U) {
+            CANmodule->txErrors = frame->data[6];
+            CANmodule->rxErrors = frame->data[7];
+            return;
+        }
+#endif
+        /* no counters, derive them from the reported state */
+        if ((crtl & CAN_ERR_CRTL_TX_PASSIVE) != 0U) {
+            CANmodule->txErrors = 128U;
+        } else if ((crtl & CAN_ERR_CRTL_TX_WARNING) != 0U) {
+            CANmodule->txErrors = 96U;
+        }
+        if ((crtl & CAN_ERR_CRTL_RX_PASSIVE) != 0U) {
+            CANmodule->rxErrors = 128U;
+        } else if ((crtl & CAN_ERR_CRTL_RX_WARNING) != 0U) {
+            CANmodule->rxErrors = 96U;
+        }
+#ifdef CAN_ERR_CRTL_ACTIVE
+        if ((crtl & CAN_ERR_CRTL_ACTIVE) != 0U) {
+            CANmodule->txErrors = 0U;
+            CANmodule->rxErrors = 0U;
+        }
+#endif
+    }
+}
+
+/* Receive one frame from SocketCAN. Returns true for data frame. */
+static bool_t
+CO_CANsocketReceive(CO_CANmodule_t* CANmodule, CO_CANrxMsg_t* rcvMsg, bool_t* rtr, int timeout_ms) {
+    struct pollfd pfd = {.fd = CANmodule->fd, .events = POLLIN};
+    struct can_frame frame;
+    struct iovec iov = {.iov_base = &frame, .iov_len = sizeof(frame)};
+    char control[CMSG_SPACE(sizeof(uint32_t))];
+    struct msghdr msg;
+    struct cmsghdr* cmsg;
+
+    if ((poll(&pfd, 1, timeout_ms) <= 0) || ((pfd.revents & POLLIN) == 0)) {
+        return false;
+    }
+    memset(&msg, 0, sizeof(msg));
+    msg.msg_iov = &iov;
+    msg.msg_iovlen = 1;
+    msg.msg_control = control;
+    msg.msg_controllen = sizeof(control);
+    if (recvmsg(CANmodule->fd, &msg, MSG_DONTWAIT) != (ssize_t)sizeof(frame)) {
+        return false;
+    }
+    for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+        if ((cmsg->cmsg_level == SOL_SOCKET) && (cmsg->cmsg_type == SO_RXQ_OVFL)) {
+            uint32_t dropped;
+
+            memcpy(&dropped, CMSG_DATA(cmsg), sizeof(dropped));
+            CANmodule->rxDropped = dropped;
+        }
+    }
+
+    if ((frame.can_id & CAN_ERR_FLAG) != 0U) {
+        CO_CANerrorFrame(CANmodule, &frame);
+        return false;
+    }
+    if ((frame.can_id & CAN_EFF_FLAG) != 0U) {
+        /* CANopen uses 11-bit identifiers only */
+        return false;
+    }
+    rcvMsg->ident = (uint16_t)(frame.can_id & CAN_SFF_MASK);
+    rcvMsg->DLC = frame.can_dlc;
+    memcpy(rcvMsg->data, frame.data, sizeof(rcvMsg->data));
+    *rtr = (frame.can_id & CAN_RTR_FLAG) != 0U;
+    return true;
+}
+
+int
+CO_CANrxWait(CO_CANmodule_t* CANmodule, int timeout_ms) {
+    CO_CANrxMsg_t rcvMsg;
+    bool_t rtr = false;
+    uint16_t rcvIdWFlag;
+    uint16_t index;
+    CO_CANrx_t* buffer;
+
+    if (!CANmodule->opened) {
+        return -1;
+    }
+
+    if (CANmodule->vbusPort != NULL) {
+        CO_vbusFrame_t frame;
+
+        if (!CO_vbus_receive(CANmodule->vbusPort, &frame, timeout_ms)) {
+            return 0;
+        }
+        rcvMsg.ident = frame.ident;
+        rcvMsg.DLC = frame.DLC;
+        memcpy(rcvMsg.data, frame.data, sizeof(rcvMsg.data));
+        rtr = frame.rtr;
+    } else if (!CO_CANsocketReceive(CANmodule, &rcvMsg, &rtr, timeout_ms)) {
+        return 0;
+    }
+    rcvMsg.timestamp_us = CO_CANtime_us();
+    CANmodule->rxFrames++;
+
+    /* Search rxArray form CANmodule for the same CAN-ID. */
+    rcvIdWFlag = rcvMsg.ident | (rtr ? 0x0800U : 0U);
+    buffer = &CANmodule->rxArray[0];
+    for (index = CANmodule->rxSize; index > 0U; index--) {
+        if (((rcvIdWFlag ^ buffer->ident) & buffer->mask) == 0U) {
+            /* Call specific function, which will process the message */
+            if (buffer->CANrx_callback != NULL) {
+                buffer->CANrx_callback(buffer->object, (void*)&rcvMsg);
+            }
+            break;
+        }
+        buffer++;
+    }
+
+    return 1;
+}
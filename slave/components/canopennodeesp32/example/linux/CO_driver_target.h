@@ -0,0 +1,188 @@
+/*
+ * Device and application specific definitions for CANopenNode on Linux.
+ *
+ * @file        CO_driver_target.h
+ * @ingroup     CO_driver
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations under the License.
+ */
+
+#ifndef CO_DRIVER_TARGET_H
+#define CO_DRIVER_TARGET_H
+
+/* This file contains device and application specific definitions. It is included from CO_driver.h, which contains
+ * documentation for common definitions below. */
+
+#include <stddef.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <pthread.h>
+
+#include "CO_vbus.h"
+
+#ifdef CO_DRIVER_CUSTOM
+#include "CO_driver_custom.h"
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Stack configuration override default values. For more information see file CO_config.h. */
+
+/* Main thread is woken by callbacks and sleeps until timerNext_us */
+#define CO_CONFIG_GLOBAL_FLAG_CALLBACK_PRE    CO_CONFIG_FLAG_CALLBACK_PRE
+#define CO_CONFIG_GLOBAL_RT_FLAG_CALLBACK_PRE CO_CONFIG_FLAG_CALLBACK_PRE
+#define CO_CONFIG_GLOBAL_FLAG_TIMERNEXT       CO_CONFIG_FLAG_TIMERNEXT
+
+/* Stage execution times of CO_process() etc., see co_profiler.h */
+#ifndef CO_CONFIG_PROFILER
+#define CO_CONFIG_PROFILER 1
+#endif
+
+/* Basic definitions. If big endian, CO_SWAP_xx macros must swap bytes. */
+#define CO_LITTLE_ENDIAN
+#define CO_SWAP_16(x) x
+#define CO_SWAP_32(x) x
+#define CO_SWAP_64(x) x
+/* NULL is defined in stddef.h */
+/* true and false are defined in stdbool.h */
+/* int8_t to uint64_t are defined in stdint.h */
+typedef uint_fast8_t bool_t;
+typedef float float32_t;
+typedef double float64_t;
+
+/* Received CAN message, as passed to CANrx_callback */
+typedef struct {
+    uint16_t ident;
+    uint8_t DLC;
+    uint8_t data[8];
+    int64_t timestamp_us; /* CLOCK_MONOTONIC right after reception */
+} CO_CANrxMsg_t;
+
+/* Access to received CAN message */
+#define CO_CANrxMsg_readIdent(msg) (((const CO_CANrxMsg_t*)(msg))->ident)
+#define CO_CANrxMsg_readDLC(msg)   (((const CO_CANrxMsg_t*)(msg))->DLC)
+#define CO_CANrxMsg_readData(msg)  (((const CO_CANrxMsg_t*)(msg))->data)
+#define CO_CANrxMsg_readTimestamp(msg) (((const CO_CANrxMsg_t*)(msg))->timestamp_us)
+
+/* Receive lanes of CO_driver_rxlanes.c, as in the ESP32 driver */
+typedef enum {
+    CO_CAN_RX_LANE_HIGH = 0, /* NMT, SYNC, EMCY, TIME */
+    CO_CAN_RX_LANE_FAST,     /* RPDO */
+    CO_CAN_RX_LANE_NORMAL,   /* all other frames */
+    CO_CAN_RX_LANE_COUNT
+} CO_CANrxLane_t;
+
+/* Received message object */
+typedef struct {
+    uint16_t ident;
+    uint16_t mask;
+    void* object;
+    void (*CANrx_callback)(void* object, void* message);
+} CO_CANrx_t;
+
+/* Transmit message object */
+typedef struct {
+    uint32_t ident;
+    uint8_t DLC;
+    uint8_t data[8];
+    volatile bool_t bufferFull;
+    volatile bool_t syncFlag;
+} CO_CANtx_t;
+
+/* CAN module object */
+typedef struct {
+    void* CANptr;
+    CO_CANrx_t* rxArray;
+    uint16_t rxSize;
+    CO_CANtx_t* txArray;
+    uint16_t txSize;
+    uint16_t CANerrorStatus;
+    volatile bool_t CANnormal;
+    volatile bool_t useCANrxFilters;
+    volatile bool_t bufferInhibitFlag;
+    volatile bool_t firstCANtxMessage;
+    volatile uint16_t CANtxCount;
+    uint32_t errOld;
+    /* Linux specific */
+    bool_t opened;              /* socket or virtual bus port is open */
+    int fd;                     /* SocketCAN socket, -1 on virtual bus */
+    CO_vbusPort_t* vbusPort;    /* virtual bus port, NULL on SocketCAN */
+    volatile uint16_t txErrors; /* from SocketCAN error frames */
+    volatile uint16_t rxErrors;
+    volatile bool_t busOff;
+    volatile uint32_t rxDropped; /* frames lost in kernel or virtual bus receive queue */
+    uint32_t rxFrames;
+    uint32_t txFrames;
+    bool_t locksInit;
+    pthread_mutex_t sendMutex;
+    pthread_mutex_t emcyMutex;
+    pthread_mutex_t odMutex;
+} CO_CANmodule_t;
+
+/* Data storage object for one entry */
+typedef struct {
+    void* addr;
+    size_t len;
+    uint8_t subIndexOD;
+    uint8_t attr;
+    /* Additional variables (target specific) */
+    void* addrNV;
+} CO_storage_entry_t;
+
+/* (un)lock critical section in CO_CANsend() */
+#define CO_LOCK_CAN_SEND(CAN_MODULE)   pthread_mutex_lock(&(CAN_MODULE)->sendMutex)
+#define CO_UNLOCK_CAN_SEND(CAN_MODULE) pthread_mutex_unlock(&(CAN_MODULE)->sendMutex)
+
+/* (un)lock critical section in CO_errorReport() or CO_errorReset() */
+#define CO_LOCK_EMCY(CAN_MODULE)   pthread_mutex_lock(&(CAN_MODULE)->emcyMutex)
+#define CO_UNLOCK_EMCY(CAN_MODULE) pthread_mutex_unlock(&(CAN_MODULE)->emcyMutex)
+
+/* (un)lock critical section when accessing Object Dictionary */
+#define CO_LOCK_OD(CAN_MODULE)   pthread_mutex_lock(&(CAN_MODULE)->odMutex)
+#define CO_UNLOCK_OD(CAN_MODULE) pthread_mutex_unlock(&(CAN_MODULE)->odMutex)
+
+/* Synchronization between CAN receive and message processing threads. */
+#define CO_MemoryBarrier() __sync_synchronize()
+#define CO_FLAG_READ(rxNew) ((rxNew) != NULL)
+#define CO_FLAG_SET(rxNew)                                                                                             \
+    {                                                                                                                  \
+        CO_MemoryBarrier();                                                                                            \
+        rxNew = (void*)1L;                                                                                             \
+    }
+#define CO_FLAG_CLEAR(rxNew)                                                                                           \
+    {                                                                                                                  \
+        CO_MemoryBarrier();                                                                                            \
+        rxNew = NULL;                                                                                                  \
+    }
+
+/* Name of the in-process virtual bus, pass it (or NULL) as CANptr to CO_CANinit(). Any other string is the name
+ * of SocketCAN interface, for example "can0" or "vcan0". */
+#define CO_CAN_VBUS_NAME "vbus"
+
+/**
+ * Wait for one CAN frame and pass it to the matching CANrx_callback.
+ *
+ * Linux has no CAN interrupt, receive thread calls this function in a loop. SocketCAN error frames update error
+ * counters, which are evaluated by CO_CANmodule_process().
+ *
+ * @param CANmodule This object.
+ * @param timeout_ms Time to wait, 0 for no wait.
+ *
+ * @return Number of received data frames (0 or 1), -1 if module is not open.
+ */
+int CO_CANrxWait(CO_CANmodule_t* CANmodule, int timeout_ms);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CO_DRIVER_TARGET_H */
@@ -0,0 +1,147 @@
+/*
+ * In-process virtual CAN bus for CANopenNode Linux driver.
+ *
+ * @file        CO_vbus.c
+ * @ingroup     CO_driver
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations under the License.
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <time.h>
+
+#include "CO_vbus.h"
+
+#if (CO_VBUS_RX_QUEUE_LEN & (CO_VBUS_RX_QUEUE_LEN - 1U)) != 0U
+#error CO_VBUS_RX_QUEUE_LEN must be power of two
+#endif
+
+struct CO_vbusPort {
+    bool used;
+    bool condInit; /* cond is kept over close, receiver may still wait on it */
+    pthread_cond_t cond;
+    uint32_t head; /* next frame to write, free running */
+    uint32_t tail; /* next frame to read, free running */
+    uint32_t overflow;
+    CO_vbusFrame_t queue[CO_VBUS_RX_QUEUE_LEN];
+};
+
+/* One bus per process, all ports share one mutex */
+static pthread_mutex_t vbus_mutex = PTHREAD_MUTEX_INITIALIZER;
+static CO_vbusPort_t vbus_ports[CO_VBUS_PORTS_MAX];
+
+CO_vbusPort_t*
+CO_vbus_open(void) {
+    CO_vbusPort_t* port = NULL;
+    uint16_t i;
+
+    pthread_mutex_lock(&vbus_mutex);
+    for (i = 0U; i < CO_VBUS_PORTS_MAX; i++) {
+        if (!vbus_ports[i].used) {
+            port = &vbus_ports[i];
+            port->used = true;
+            port->head = 0U;
+            port->tail = 0U;
+            port->overflow = 0U;
+            if (!port->condInit) {
+                pthread_condattr_t attr;
+
+                pthread_condattr_init(&attr);
+                pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+                pthread_cond_init(&port->cond, &attr);
+                pthread_condattr_destroy(&attr);
+                port->condInit = true;
+            }
+            break;
+        }
+    }
+    pthread_mutex_unlock(&vbus_mutex);
+
+    return port;
+}
+
+void
+CO_vbus_close(CO_vbusPort_t* port) {
+    if (port == NULL) {
+        return;
+    }
+    pthread_mutex_lock(&vbus_mutex);
+    port->used = false;
+    /* wake receiver, if any, it returns without frame */
+    pthread_cond_broadcast(&port->cond);
+    pthread_mutex_unlock(&vbus_mutex);
+}
+
+void
+CO_vbus_send(CO_vbusPort_t* port, const CO_vbusFrame_t* frame) {
+    uint16_t i;
+
+    pthread_mutex_lock(&vbus_mutex);
+    for (i = 0U; i < CO_VBUS_PORTS_MAX; i++) {
+        CO_vbusPort_t* rx = &vbus_ports[i];
+
+        if (!rx->used || rx == port) {
+            continue;
+        }
+        if ((rx->head - rx->tail) >= CO_VBUS_RX_QUEUE_LEN) {
+            rx->overflow++;
+            continue;
+        }
+        rx->queue[rx->head & (CO_VBUS_RX_QUEUE_LEN - 1U)] = *frame;
+        rx->head++;
+        pthread_cond_signal(&rx->cond);
+    }
+    pthread_mutex_unlock(&vbus_mutex);
+}
+
+bool
+CO_vbus_receive(CO_vbusPort_t* port, CO_vbusFrame_t* frame, int timeout_ms) {
+    struct timespec deadline;
+    bool received = false;
+
+    if (timeout_ms > 0) {
+        clock_gettime(CLOCK_MONOTONIC, &deadline);
+        deadline.tv_sec += timeout_ms / 1000;
+        deadline.tv_nsec += (long)(timeout_ms % 1000) * 1000000L;
+        if (deadline.tv_nsec >= 1000000000L) {
+            deadline.tv_sec++;
+            deadline.tv_nsec -= 1000000000L;
+        }
+    }
+
+    pthread_mutex_lock(&vbus_mutex);
+    while (port->used && (port->head == port->tail) && (timeout_ms != 0)) {
+        int ret = (timeout_ms < 0) ? pthread_cond_wait(&port->cond, &vbus_mutex)
+                                   : pthread_cond_timedwait(&port->cond, &vbus_mutex, &deadline);
+        if (ret == ETIMEDOUT) {
+            break;
+        }
+    }
+    if (port->used && (port->head != port->tail)) {
+        *frame = port->queue[port->tail & (CO_VBUS_RX_QUEUE_LEN - 1U)];
+        port->tail++;
+        received = true;
+    }
+    pthread_mutex_unlock(&vbus_mutex);
+
+    return received;
+}
+
+uint32_t
+CO_vbus_overflowCount(CO_vbusPort_t* port) {
+    uint32_t overflow;
+
+    pthread_mutex_lock(&vbus_mutex);
+    overflow = port->overflow;
+    pthread_mutex_unlock(&vbus_mutex);
+
+    return overflow;
+}
@@ -0,0 +1,105 @@
+/*
+ * In-process virtual CAN bus for CANopenNode Linux driver.
+ *
+ * @file        CO_vbus.h
+ * @ingroup     CO_driver
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations under the License.
+ */
+
+#ifndef CO_VBUS_H
+#define CO_VBUS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Maximum number of ports attached to the bus */
+#ifndef CO_VBUS_PORTS_MAX
+#define CO_VBUS_PORTS_MAX 8U
+#endif
+
+/* Receive queue length of each port, power of two */
+#ifndef CO_VBUS_RX_QUEUE_LEN
+#define CO_VBUS_RX_QUEUE_LEN 256U
+#endif
+
+/**
+ * CAN frame on the virtual bus.
+ */
+typedef struct {
+    uint16_t ident; /**< 11-bit CAN identifier */
+    bool rtr;       /**< Remote transmission request */
+    uint8_t DLC;    /**< Data length code */
+    uint8_t data[8];
+} CO_vbusFrame_t;
+
+/**
+ * Port of the virtual bus, opaque.
+ */
+typedef struct CO_vbusPort CO_vbusPort_t;
+
+/**
+ * Attach new port to the process wide virtual bus.
+ *
+ * Frames sent from one port are received by all other ports, in the order of sending. There is no arbitration,
+ * no bit timing and no error frames. Bus needs no kernel modules or hardware, so more CANopen devices and test
+ * code can communicate inside one process.
+ *
+ * @return Port or NULL, if CO_VBUS_PORTS_MAX ports are already open.
+ */
+CO_vbusPort_t* CO_vbus_open(void);
+
+/**
+ * Detach port from the bus. Frames waiting in its receive queue are discarded.
+ *
+ * @param port This object.
+ */
+void CO_vbus_close(CO_vbusPort_t* port);
+
+/**
+ * Send frame to all other ports.
+ *
+ * Function does not block. If receive queue of some other port is full, frame is lost for that port and its
+ * overflow counter is incremented.
+ *
+ * @param port This object.
+ * @param frame Frame to send.
+ */
+void CO_vbus_send(CO_vbusPort_t* port, const CO_vbusFrame_t* frame);
+
+/**
+ * Receive next frame.
+ *
+ * @param port This object.
+ * @param [out] frame Received frame.
+ * @param timeout_ms Time to wait for the frame, 0 for no wait, negative for infinite wait.
+ *
+ * @return true, if frame was received, false on timeout.
+ */
+bool CO_vbus_receive(CO_vbusPort_t* port, CO_vbusFrame_t* frame, int timeout_ms);
+
+/**
+ * Get number of frames lost because receive queue of the port was full.
+ *
+ * @param port This object.
+ *
+ * @return Free running counter.
+ */
+uint32_t CO_vbus_overflowCount(CO_vbusPort_t* port);
+
+#ifdef __cplusplus
+}
+#endif /* __cplusplus */
+
+#endif /* CO_VBUS_H */
@@ -0,0 +1,595 @@
+/*
+ * CANopen main program file for Linux, SocketCAN or in-process virtual bus.
+ *
+ * @file        main_linux.c
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations under the License.
+ */
+
+#include <net/if.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+#include <linux/can.h>
+#include <linux/can/raw.h>
+
+#include "CANopen.h"
+#include "OD.h"
+#include "co_profiler.h"
+
+#define log_printf(macropar_message, ...) printf(macropar_message, ##__VA_ARGS__)
+
+/* default values for CO_CANopenInit() */
+#define NMT_CONTROL                                                                                                    \
+    CO_NMT_STARTUP_TO_OPERATIONAL                                                                                      \
+    | CO_NMT_ERR_ON_ERR_REG | CO_ERR_REG_GENERIC_ERR | CO_ERR_REG_COMMUNICATION
+#define FIRST_HB_TIME        500
+#define SDO_SRV_TIMEOUT_TIME 1000
+#define SDO_CLI_TIMEOUT_TIME 500
+#define SDO_CLI_BLOCK        false
+#define OD_STATUS_BITS       NULL
+
+/* interval of realtime thread (SYNC, PDO) and maximum sleep of main thread */
+#define TMR_TASK_INTERVAL_US 1000
+#define MAIN_MAX_SLEEP_US    10000
+/* longest receive wait, the receive thread stops within it at communication reset */
+#define RX_WAIT_MS           1
+/* SDO response timeout in benchmark */
+#define BENCH_TIMEOUT_MS 100
+/* bootup timeout after NMT reset communication and pause before the next reset */
+#define RESET_TIMEOUT_MS 2000
+#define RESET_PAUSE_US   50000
+
+/* Global variables and objects */
+CO_t* CO = NULL; /* CANopen object */
+
+static volatile bool_t appRun = true; /* cleared by signal or by finished benchmark */
+static volatile bool_t threadsRun = false;
+static bool_t benchFailed = false;
+
+/* Main thread sleeps on this condition, CANopen callbacks and realtime thread wake it */
+static pthread_mutex_t mainMutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t mainCond;
+static bool_t mainWake = false;
+
+static uint64_t
+time_us(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000U) + ((uint64_t)ts.tv_nsec / 1000U);
+}
+
+static void
+sigHandler(int sig) {
+    (void)sig;
+    appRun = false;
+}
+
+/* callback from CANopen objects, new message needs processing */
+static void
+wakeupMain(void* object) {
+    (void)object;
+    pthread_mutex_lock(&mainMutex);
+    mainWake = true;
+    pthread_cond_signal(&mainCond);
+    pthread_mutex_unlock(&mainMutex);
+}
+
+static void
+waitMain(uint32_t sleep_us) {
+    struct timespec deadline;
+    uint64_t ns;
+
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    ns = (uint64_t)deadline.tv_nsec + ((uint64_t)sleep_us * 1000U);
+    deadline.tv_sec += (time_t)(ns / 1000000000U);
+    deadline.tv_nsec = (long)(ns % 1000000000U);
+
+    pthread_mutex_lock(&mainMutex);
+    while (!mainWake && appRun) {
+        if (pthread_cond_timedwait(&mainCond, &mainMutex, &deadline) != 0) {
+            break;
+        }
+    }
+    mainWake = false;
+    pthread_mutex_unlock(&mainMutex);
+}
+
+/* receive thread replaces CAN interrupt ********************************************/
+static void*
+rxTask_thread(void* arg) {
+    (void)arg;
+    while (threadsRun) {
+        if (CO_CANrxWait(CO->CANmodule, RX_WAIT_MS) < 0) {
+            usleep(1000);
+        }
+    }
+    return NULL;
+}
+
+/* timer thread executes in constant intervals ********************************/
+static void*
+tmrTask_thread(void* arg) {
+    struct timespec next;
+    uint64_t last = time_us();
+
+    (void)arg;
+    clock_gettime(CLOCK_MONOTONIC, &next);
+    while (threadsRun) {
+        uint64_t now;
+
+        next.tv_nsec += TMR_TASK_INTERVAL_US * 1000;
+        if (next.tv_nsec >= 1000000000L) {
+            next.tv_sec++;
+            next.tv_nsec -= 1000000000L;
+        }
+        clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &next, NULL);
+
+        now = time_us();
+        CO_LOCK_OD(CO->CANmodule);
+        if (!CO->nodeIdUnconfigured && CO->CANmodule->CANnormal) {
+            bool_t syncWas = false;
+            /* get time difference since last function call */
+            uint32_t timeDifference_us = (uint32_t)(now - last);
+
+#if (CO_CONFIG_SYNC) & CO_CONFIG_SYNC_ENABLE
+            syncWas = CO_process_SYNC(CO, timeDifference_us, NULL);
+#endif
+#if (CO_CONFIG_PDO) & CO_CONFIG_RPDO_ENABLE
+            CO_process_RPDO(CO, syncWas, timeDifference_us, NULL);
+#endif
+#if (CO_CONFIG_PDO) & CO_CONFIG_TPDO_ENABLE
+            CO_process_TPDO(CO, syncWas, timeDifference_us, NULL);
+#endif
+            (void)syncWas;
+            (void)timeDifference_us;
+        }
+        CO_UNLOCK_OD(CO->CANmodule);
+        last = now;
+    }
+    return NULL;
+}
+
+/* Benchmarks from another port of the virtual bus or another SocketCAN socket ***/
+typedef struct {
+    const char* ifName;
+    uint8_t nodeId;  /* node under test, own node-id by default */
+    uint32_t count;  /* SDO round trips */
+    uint32_t resets; /* NMT reset communication to bootup measurements */
+} bench_t;
+
+typedef struct {
+    CO_vbusPort_t* vbus;
+    int fd;
+} benchPort_t;
+
+typedef struct {
+    uint32_t ok;
+    uint64_t sum, min, max;
+} benchStats_t;
+
+static bool_t
+benchOpen(benchPort_t* port, const char* ifName) {
+    struct sockaddr_can addr;
+
+    port->vbus = NULL;
+    port->fd = -1;
+    if (strcmp(ifName, CO_CAN_VBUS_NAME) == 0) {
+        port->vbus = CO_vbus_open();
+        return port->vbus != NULL;
+    }
+    port->fd = socket(PF_CAN, SOCK_RAW, CAN_RAW);
+    if (port->fd < 0) {
+        return false;
+    }
+    memset(&addr, 0, sizeof(addr));
+    addr.can_family = AF_CAN;
+    addr.can_ifindex = (int)if_nametoindex(ifName);
+    if ((addr.can_ifindex == 0) || (bind(port->fd, (struct sockaddr*)&addr, sizeof(addr)) != 0)) {
+        close(port->fd);
+        port->fd = -1;
+        return false;
+    }
+    return true;
+}
+
+static void
+benchClose(benchPort_t* port) {
+    if (port->vbus != NULL) {
+        CO_vbus_close(port->vbus);
+    }
+    if (port->fd >= 0) {
+        close(port->fd);
+    }
+}
+
+static void
+benchSend(benchPort_t* port, const CO_vbusFrame_t* frame) {
+    struct can_frame cf;
+
+    if (port->vbus != NULL) {
+        CO_vbus_send(port->vbus, frame);
+        return;
+    }
+    memset(&cf, 0, sizeof(cf));
+    cf.can_id = frame->ident;
+    cf.can_dlc = frame->DLC;
+    memcpy(cf.data, frame->data, sizeof(cf.data));
+    if (write(port->fd, &cf, sizeof(cf)) != (ssize_t)sizeof(cf)) {
+        log_printf("Bench: CAN write failed\n");
+    }
+}
+
+static bool_t
+benchReceive(benchPort_t* port, CO_vbusFrame_t* frame, int timeout_ms) {
+    struct pollfd pfd = {.fd = port->fd, .events = POLLIN};
+    struct can_frame cf;
+
+    if (port->vbus != NULL) {
+        return CO_vbus_receive(port->vbus, frame, timeout_ms);
+    }
+    if ((poll(&pfd, 1, timeout_ms) <= 0) || (read(port->fd, &cf, sizeof(cf)) != (ssize_t)sizeof(cf))
+        || ((cf.can_id & (CAN_EFF_FLAG | CAN_ERR_FLAG)) != 0U)) {
+        return false;
+    }
+    frame->ident = (uint16_t)(cf.can_id & CAN_SFF_MASK);
+    frame->rtr = (cf.can_id & CAN_RTR_FLAG) != 0U;
+    frame->DLC = cf.can_dlc;
+    memcpy(frame->data, cf.data, sizeof(frame->data));
+    return true;
+}
+
+static void
+benchStatsAdd(benchStats_t* stats, uint64_t value_us) {
+    if ((stats->ok == 0U) || (value_us < stats->min)) {
+        stats->min = value_us;
+    }
+    if (value_us > stats->max) {
+        stats->max = value_us;
+    }
+    stats->sum += value_us;
+    stats->ok++;
+}
+
+static void
+benchStatsPrint(const char* name, const benchStats_t* stats, uint32_t count) {
+    if (stats->ok > 0U) {
+        log_printf("Bench: %s %u/%u ok, min %llu us, avg %llu us, max %llu us\n", name, stats->ok, count,
+                   (unsigned long long)stats->min, (unsigned long long)(stats->sum / stats->ok),
+                   (unsigned long long)stats->max);
+    } else {
+        log_printf("Bench: %s 0/%u ok\n", name, count);
+    }
+}
+
+/* SDO round trip: expedited upload of 0x1000:00, Device type */
+static bool_t
+benchSdo(benchPort_t* port, const bench_t* bench) {
+    CO_vbusFrame_t req = {.ident = (uint16_t)(0x600U + bench->nodeId), .rtr = false, .DLC = 8U};
+    benchStats_t stats = {0};
+    uint32_t i;
+
+    req.data[0] = 0x40U;
+    req.data[1] = 0x00U;
+    req.data[2] = 0x10U;
+    req.data[3] = 0x00U;
+
+    for (i = 0U; (i < bench->count) && appRun; i++) {
+        CO_vbusFrame_t rsp;
+        uint64_t start = time_us();
+
+        benchSend(port, &req);
+        while ((time_us() - start) < (BENCH_TIMEOUT_MS * 1000U)) {
+            if (benchReceive(port, &rsp, BENCH_TIMEOUT_MS) && (rsp.ident == (0x580U + bench->nodeId))) {
+                if ((rsp.data[0] & 0xE0U) == 0x40U) {
+                    benchStatsAdd(&stats, time_us() - start);
+                }
+                break;
+            }
+        }
+    }
+    benchStatsPrint("SDO upload round trip", &stats, bench->count);
+    return stats.ok == bench->count;
+}
+
+/* NMT reset communication until the bootup message of the node. This is the
+ * time the node is away from the network, it works for any node on SocketCAN. */
+static bool_t
+benchReset(benchPort_t* port, const bench_t* bench) {
+    CO_vbusFrame_t nmt = {.ident = 0x000U, .rtr = false, .DLC = 2U};
+    benchStats_t stats = {0};
+    uint32_t i;
+
+    nmt.data[0] = (uint8_t)CO_NMT_RESET_COMMUNICATION;
+    nmt.data[1] = bench->nodeId;
+
+    for (i = 0U; (i < bench->resets) && appRun; i++) {
+        CO_vbusFrame_t rsp;
+        uint64_t start;
+
+        while (benchReceive(port, &rsp, 0)) {}
+        start = time_us();
+        benchSend(port, &nmt);
+        while ((time_us() - start) < (RESET_TIMEOUT_MS * 1000U)) {
+            if (benchReceive(port, &rsp, RESET_TIMEOUT_MS) && (rsp.ident == (0x700U + bench->nodeId))
+                && (rsp.DLC == 1U) && (rsp.data[0] == 0U)) {
+                benchStatsAdd(&stats, time_us() - start);
+                break;
+            }
+        }
+        usleep(RESET_PAUSE_US);
+    }
+    benchStatsPrint("NMT reset communication to bootup", &stats, bench->resets);
+    return stats.ok == bench->resets;
+}
+
+static void*
+bench_thread(void* arg) {
+    bench_t* bench = (bench_t*)arg;
+    benchPort_t port;
+
+    if (!benchOpen(&port, bench->ifName)) {
+        log_printf("Bench: can't open %s\n", bench->ifName);
+        benchFailed = true;
+        appRun = false;
+        wakeupMain(NULL);
+        return NULL;
+    }
+
+    /* wait for bootup of the device */
+    usleep(100000);
+
+    if ((bench->count > 0U) && !benchSdo(&port, bench)) {
+        benchFailed = true;
+    }
+    if ((bench->resets > 0U) && !benchReset(&port, bench)) {
+        benchFailed = true;
+    }
+    benchClose(&port);
+    appRun = false;
+    wakeupMain(NULL);
+    return NULL;
+}
+
+static void
+printUsage(const char* progName) {
+    log_printf("Usage: %s [options]\n"
+               "  -i <ifname>  SocketCAN interface (can0, vcan0) or \"%s\" (default)\n"
+               "  -n <id>      CANopen node-id, default 10\n"
+               "  -b <count>   run SDO round trip benchmark and exit\n"
+               "  -r <count>   measure NMT reset communication to bootup time and exit\n"
+               "  -t <id>      node-id under benchmark, default own node-id\n",
+               progName, CO_CAN_VBUS_NAME);
+}
+
+/* main ***********************************************************************/
+int
+main(int argc, char* argv[]) {
+    CO_ReturnError_t err;
+    CO_NMT_reset_cmd_t reset = CO_RESET_NOT;
+    uint32_t heapMemoryUsed;
+    char* CANptr = CO_CAN_VBUS_NAME; /* CAN interface name */
+    uint8_t pendingNodeId = 10;      /* configurable by LSS slave */
+    uint8_t activeNodeId = 10;       /* Copied from CO_pendingNodeId in the communication reset section */
+    uint16_t pendingBitRate = 125;   /* configurable by LSS slave, informative on Linux */
+    bench_t bench = {0};
+    bool_t benchRunning = false;
+    pthread_t benchThread;
+    pthread_condattr_t condAttr;
+    uint32_t processMax_us = 0U;
+    int opt;
+
+    while ((opt = getopt(argc, argv, "i:n:b:r:t:h")) != -1) {
+        switch (opt) {
+            case 'i': CANptr = optarg; break;
+            case 'n':
+                pendingNodeId = (uint8_t)strtoul(optarg, NULL, 0);
+                activeNodeId = pendingNodeId;
+                break;
+            case 'b': bench.count = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 'r': bench.resets = (uint32_t)strtoul(optarg, NULL, 0); break;
+            case 't': bench.nodeId = (uint8_t)strtoul(optarg, NULL, 0); break;
+            default: printUsage(argv[0]); return EXIT_FAILURE;
+        }
+    }
+    bench.ifName = CANptr;
+
+    signal(SIGINT, sigHandler);
+    signal(SIGTERM, sigHandler);
+    pthread_condattr_init(&condAttr);
+    pthread_condattr_setclock(&condAttr, CLOCK_MONOTONIC);
+    pthread_cond_init(&mainCond, &condAttr);
+    pthread_condattr_destroy(&condAttr);
+
+    /* Allocate memory */
+    CO = CO_new(NULL, &heapMemoryUsed);
+    if (CO == NULL) {
+        log_printf("Error: Can't allocate memory\n");
+        return EXIT_FAILURE;
+    } else {
+        log_printf("Allocated %u bytes for CANopen objects\n", heapMemoryUsed);
+    }
+
+    while ((reset != CO_RESET_APP) && appRun) {
+        pthread_t rxThread, tmrThread;
+        uint64_t last;
+
+        /* CANopen communication reset - initialize CANopen objects *******************/
+        log_printf("CANopenNode - Reset communication...\n");
+
+        /* Enter CAN configuration. */
+        CO->CANmodule->CANnormal = false;
+        CO_CANsetConfigurationMode((void*)CANptr);
+        CO_CANmodule_disable(CO->CANmodule);
+
+        /* initialize CANopen */
+        err = CO_CANinit(CO, (void*)CANptr, pendingBitRate);
+        if (err != CO_ERROR_NO) {
+            log_printf("Error: CAN initialization failed on %s: %d\n", CANptr, err);
+            return EXIT_FAILURE;
+        }
+
+        CO_LSS_address_t lssAddress = {.identity = {.vendorID = OD_PERSIST_COMM.x1018_identity.vendor_ID,
+                                                    .productCode = OD_PERSIST_COMM.x1018_identity.productCode,
+                                                    .revisionNumber = OD_PERSIST_COMM.x1018_identity.revisionNumber,
+                                                    .serialNumber = OD_PERSIST_COMM.x1018_identity.serialNumber}};
+        err = CO_LSSinit(CO, &lssAddress, &pendingNodeId, &pendingBitRate);
+        if (err != CO_ERROR_NO) {
+            log_printf("Error: LSS slave initialization failed: %d\n", err);
+            return EXIT_FAILURE;
+        }
+
+        activeNodeId = pendingNodeId;
+        uint32_t errInfo = 0;
+
+        err = CO_CANopenInit(CO,                   /* CANopen object */
+                             NULL,                 /* alternate NMT */
+                             NULL,                 /* alternate em */
+                             OD,                   /* Object dictionary */
+                             OD_STATUS_BITS,       /* Optional OD_statusBits */
+                             NMT_CONTROL,          /* CO_NMT_control_t */
+                             FIRST_HB_TIME,        /* firstHBTime_ms */
+                             SDO_SRV_TIMEOUT_TIME, /* SDOserverTimeoutTime_ms */
+                             SDO_CLI_TIMEOUT_TIME, /* SDOclientTimeoutTime_ms */
+                             SDO_CLI_BLOCK,        /* SDOclientBlockTransfer */
+                             activeNodeId, &errInfo);
+        if (err != CO_ERROR_NO && err != CO_ERROR_NODE_ID_UNCONFIGURED_LSS) {
+            if (err == CO_ERROR_OD_PARAMETERS) {
+                log_printf("Error: Object Dictionary entry 0x%X\n", errInfo);
+            } else {
+                log_printf("Error: CANopen initialization failed: %d\n", err);
+            }
+            return EXIT_FAILURE;
+        }
+
+        err = CO_CANopenInitPDO(CO, CO->em, OD, activeNodeId, &errInfo);
+        if (err != CO_ERROR_NO && err != CO_ERROR_NODE_ID_UNCONFIGURED_LSS) {
+            if (err == CO_ERROR_OD_PARAMETERS) {
+                log_printf("Error: Object Dictionary entry 0x%X\n", errInfo);
+            } else {
+                log_printf("Error: PDO initialization failed: %d\n", err);
+            }
+            return EXIT_FAILURE;
+        }
+
+        /* Configure CANopen callbacks, they wake the main thread */
+        CO_NMT_initCallbackPre(CO->NMT, NULL, wakeupMain);
+        CO_EM_initCallbackPre(CO->em, NULL, wakeupMain);
+        CO_SDOserver_initCallbackPre(&CO->SDOserver[0], NULL, wakeupMain);
+#if (CO_CONFIG_HB_CONS) & CO_CONFIG_HB_CONS_ENABLE
+        CO_HBconsumer_initCallbackPre(CO->HBcons, NULL, wakeupMain);
+#endif
+#if (CO_CONFIG_TIME) & CO_CONFIG_TIME_ENABLE
+        CO_TIME_initCallbackPre(CO->TIME, NULL, wakeupMain);
+#endif
+#if (CO_CONFIG_LSS) & CO_CONFIG_LSS_SLAVE
+        CO_LSSslave_initCallbackPre(CO->LSSslave, NULL, wakeupMain);
+#endif
+        if (CO->nodeIdUnconfigured) {
+            log_printf("CANopenNode - Node-id not initialized\n");
+        }
+
+        /* start CAN, receive and timer threads */
+        CO_CANsetNormalMode(CO->CANmodule);
+        threadsRun = true;
+        if ((pthread_create(&rxThread, NULL, rxTask_thread, NULL) != 0)
+            || (pthread_create(&tmrThread, NULL, tmrTask_thread, NULL) != 0)) {
+            log_printf("Error: can't create threads\n");
+            return EXIT_FAILURE;
+        }
+        if (((bench.count > 0U) || (bench.resets > 0U)) && !benchRunning) {
+            if (bench.nodeId == 0U) {
+                bench.nodeId = activeNodeId;
+            }
+            if (pthread_create(&benchThread, NULL, bench_thread, &bench) != 0) {
+                log_printf("Error: can't create benchmark thread\n");
+                return EXIT_FAILURE;
+            }
+            benchRunning = true;
+        }
+
+        reset = CO_RESET_NOT;
+
+        log_printf("CANopenNode - Running on %s, node-id %u\n", CANptr, activeNodeId);
+        fflush(stdout);
+
+        last = time_us();
+        while ((reset == CO_RESET_NOT) && appRun) {
+            /* loop for normal program execution ******************************************/
+            uint64_t now = time_us();
+            uint32_t timeDifference_us = (uint32_t)(now - last);
+            uint32_t timerNext_us = MAIN_MAX_SLEEP_US;
+            uint32_t duration_us;
+
+            last = now;
+
+            /* CANopen process */
+            reset = CO_process(CO, false, timeDifference_us, &timerNext_us);
+            duration_us = (uint32_t)(time_us() - now);
+            if (duration_us > processMax_us) {
+                processMax_us = duration_us;
+            }
+
+            /* retry frames, which did not fit into the kernel queue, soon */
+            if ((CO->CANmodule->CANtxCount != 0U) && (timerNext_us > TMR_TASK_INTERVAL_US)) {
+                timerNext_us = TMR_TASK_INTERVAL_US;
+            }
+            /* NMT reset is executed at once */
+            if (reset == CO_RESET_NOT) {
+                waitMain(timerNext_us);
+            }
+        }
+
+        /* stop threads */
+        threadsRun = false;
+        pthread_join(rxThread, NULL);
+        pthread_join(tmrThread, NULL);
+    }
+
+    /* program exit ***************************************************************/
+    if (benchRunning) {
+        pthread_join(benchThread, NULL);
+    }
+    log_printf("CANopenNode - frames rx %u, tx %u, rx dropped %u, CO_process() max %u us\n",
+               CO->CANmodule->rxFrames, CO->CANmodule->txFrames, CO->CANmodule->rxDropped, processMax_us);
+#if CO_CONFIG_PROFILER
+    {
+        static const char* const stageName[CO_PROF_STAGE_CNT] = {"process", "EM",   "NMT",  "SDO srv", "HB cons",
+                                                                 "TIME",    "LSS",  "SYNC", "RPDO",    "TPDO"};
+        co_prof_report_t report;
+        int i;
+
+        co_prof_get_report(&report);
+        for (i = 0; i < CO_PROF_STAGE_CNT; i++) {
+            const co_prof_stage_report_t* st = &report.stage[i];
+
+            if (st->count > 0U) {
+                log_printf("  %-8s %8u runs, avg %6u ns, p99 %7u ns, max %7u ns\n", stageName[i], st->count,
+                           st->avg_ns, st->p99_ns, st->max_ns);
+            }
+        }
+    }
+#endif
+
+    /* delete objects from memory */
+    CO_CANsetConfigurationMode((void*)CANptr);
+    CO_CANmodule_disable(CO->CANmodule);
+    CO_delete(CO);
+
+    log_printf("CANopenNode finished\n");
+
+    return benchFailed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
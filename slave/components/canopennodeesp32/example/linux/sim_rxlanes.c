@@ -0,0 +1,246 @@
+/*
+ * Host flood simulation of the receive lanes, CO_driver_rxlanes.c, against the former batch dispatch.
+ *
+ * @file        sim_rxlanes.c
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations under the License.
+ */
+
+/* Discrete time model with 1 us resolution. A 1 Mbit/s bus is fully loaded, one 111 bit frame every 111 us:
+ * SYNC about every ms, EMCY, NMT, foreign PDOs and SDO segments in the gaps. The RX task takes frames from the
+ * TWAI driver queue at 2 us each and dispatches them at a fixed cost per class. The SDO cost is varied, it
+ * stands for a slow SDO server callback. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CO_driver_rxlanes.h"
+
+#define SIM_US          2000000L
+#define FRAME_US        111L
+#define RECEIVE_US      2L  /* twai_receive() of one frame */
+#define BATCH_MAX       32U /* DRV_RX_BATCH_MAX */
+#define DRV_QUEUE_MAX   32U
+
+typedef enum { SCHEME_BATCH, SCHEME_LANES } scheme_t;
+
+typedef struct {
+    long sent[CO_CAN_RX_LANE_COUNT];
+    long driverLost[CO_CAN_RX_LANE_COUNT]; /* TWAI driver queue full */
+    long laneLost[CO_CAN_RX_LANE_COUNT];   /* lane full */
+    long dispatched[CO_CAN_RX_LANE_COUNT];
+    long highWaitMax_us;                   /* high frames, end of frame on the bus to dispatch */
+    long highLaneWaitMax_us;               /* high frames, lane push to dispatch */
+} simStats_t;
+
+static long now_us, nextFrame_us, frameCount, sdoCost_us;
+static CO_CANrxMsg_t drvQueue[DRV_QUEUE_MAX];
+static long drvArrival_us[DRV_QUEUE_MAX];
+static unsigned drvHead, drvCount, drvQueueLen;
+static simStats_t stats;
+
+static CO_CANrxLane_t
+laneOf(uint16_t ident) {
+    return (ident < 0x180U) ? CO_CAN_RX_LANE_HIGH : (ident < 0x580U) ? CO_CAN_RX_LANE_FAST : CO_CAN_RX_LANE_NORMAL;
+}
+
+static long
+dispatchCost_us(uint16_t ident) {
+    static const long cost[CO_CAN_RX_LANE_COUNT] = {8L, 25L, 0L};
+    CO_CANrxLane_t lane = laneOf(ident);
+
+    return (lane == CO_CAN_RX_LANE_NORMAL) ? sdoCost_us : cost[lane];
+}
+
+static uint16_t
+nextIdent(void) {
+    frameCount++;
+    if ((frameCount % 9) == 0) {
+        return 0x080U; /* SYNC */
+    }
+    if ((frameCount % 61) == 0) {
+        return 0x081U; /* EMCY */
+    }
+    if ((frameCount % 451) == 0) {
+        return 0x000U; /* NMT */
+    }
+    if ((frameCount % 3) == 0) {
+        return 0x1A5U; /* foreign TPDO */
+    }
+    return 0x605U; /* SDO segment */
+}
+
+/* Frames put on the bus until now_us enter the driver queue, if there is room */
+static void
+advance(long us) {
+    now_us += us;
+    while (nextFrame_us <= now_us) {
+        uint16_t ident = nextIdent();
+        CO_CANrxLane_t lane = laneOf(ident);
+
+        stats.sent[lane]++;
+        if (drvCount < drvQueueLen) {
+            unsigned i = (drvHead + drvCount) % DRV_QUEUE_MAX;
+
+            drvQueue[i].ident = ident;
+            drvQueue[i].DLC = 8U;
+            drvArrival_us[i] = nextFrame_us;
+            drvCount++;
+        } else {
+            stats.driverLost[lane]++;
+        }
+        nextFrame_us += FRAME_US;
+    }
+}
+
+static bool_t
+driverReceive(CO_CANrxMsg_t* msg, long* arrival_us) {
+    if (drvCount == 0U) {
+        return false;
+    }
+    *msg = drvQueue[drvHead];
+    *arrival_us = drvArrival_us[drvHead];
+    drvHead = (drvHead + 1U) % DRV_QUEUE_MAX;
+    drvCount--;
+    advance(RECEIVE_US);
+    return true;
+}
+
+static void
+dispatch(const CO_CANrxMsg_t* msg, long arrival_us) {
+    CO_CANrxLane_t lane = laneOf(msg->ident);
+
+    if ((lane == CO_CAN_RX_LANE_HIGH) && ((now_us - arrival_us) > stats.highWaitMax_us)) {
+        stats.highWaitMax_us = now_us - arrival_us;
+    }
+    advance(dispatchCost_us(msg->ident));
+    stats.dispatched[lane]++;
+}
+
+/* Former RX task: batch of up to 32 frames, high and RPDO frames of the batch first, then the rest */
+static void
+runBatch(void) {
+    static CO_CANrxMsg_t batch[BATCH_MAX];
+    static long arrival_us[BATCH_MAX];
+
+    while (now_us < SIM_US) {
+        unsigned n = 0U, pass, i;
+
+        while ((n < BATCH_MAX) && driverReceive(&batch[n], &arrival_us[n])) {
+            n++;
+        }
+        if (n == 0U) {
+            advance(1L);
+            continue;
+        }
+        for (pass = 0U; pass < 2U; pass++) {
+            for (i = 0U; i < n; i++) {
+                bool_t fast = laneOf(batch[i].ident) != CO_CAN_RX_LANE_NORMAL;
+
+                if (fast == (pass == 0U)) {
+                    dispatch(&batch[i], arrival_us[i]);
+                }
+            }
+        }
+    }
+}
+
+/* Arrival and push time travel with the frame, in its (unused) data bytes */
+static void
+lanesPoll(CO_CANrxLanes_t* lanes) {
+    CO_CANrxMsg_t msg;
+    long arrival_us;
+    unsigned n = 0U;
+
+    while ((n < BATCH_MAX) && driverReceive(&msg, &arrival_us)) {
+        CO_CANrxLane_t lane = laneOf(msg.ident);
+
+        uint32_t time_us[2] = {(uint32_t)arrival_us, (uint32_t)now_us};
+
+        memcpy(msg.data, time_us, sizeof(time_us));
+        if (!CO_CANrxLanes_push(lanes, lane, &msg)) {
+            stats.laneLost[lane]++;
+        }
+        n++;
+    }
+}
+
+/* RX task with lanes: poll the driver queue after every dispatched frame, as CO_rxTask() does */
+static void
+runLanes(void) {
+    static const uint16_t laneSize[CO_CAN_RX_LANE_COUNT] = {16U, 32U, 32U};
+    static CO_CANrxLanes_t lanes;
+    CO_CANrxMsg_t msg;
+    CO_CANrxLane_t lane;
+
+    if (!CO_CANrxLanes_init(&lanes, laneSize)) {
+        printf("Lanes exceed CO_CAN_RXLANES_SLOTS\n");
+        exit(EXIT_FAILURE);
+    }
+    while (now_us < SIM_US) {
+        if (drvCount == 0U) {
+            advance(1L);
+            continue;
+        }
+        lanesPoll(&lanes);
+        while ((now_us < SIM_US) && CO_CANrxLanes_pop(&lanes, &msg, &lane)) {
+            uint32_t time_us[2];
+
+            memcpy(time_us, msg.data, sizeof(time_us));
+            if ((lane == CO_CAN_RX_LANE_HIGH) && ((now_us - (long)time_us[1]) > stats.highLaneWaitMax_us)) {
+                stats.highLaneWaitMax_us = now_us - (long)time_us[1];
+            }
+            dispatch(&msg, (long)time_us[0]);
+            lanesPoll(&lanes);
+        }
+    }
+}
+
+static void
+simulate(scheme_t scheme, long cost_us) {
+    memset(&stats, 0, sizeof(stats));
+    now_us = 0L;
+    nextFrame_us = 0L;
+    frameCount = 0L;
+    drvHead = 0U;
+    drvCount = 0U;
+    sdoCost_us = cost_us;
+    if (scheme == SCHEME_BATCH) {
+        drvQueueLen = 5U; /* TWAI driver default */
+        runBatch();
+    } else {
+        drvQueueLen = 32U; /* DRV_TWAI_RX_QUEUE_LEN */
+        runLanes();
+    }
+
+    printf("%-6s  %11ld  %9ld/%-4ld  %8ld  %8ld  %12ld", (scheme == SCHEME_BATCH) ? "batch" : "lanes", cost_us,
+           stats.driverLost[CO_CAN_RX_LANE_HIGH] + stats.laneLost[CO_CAN_RX_LANE_HIGH], stats.sent[CO_CAN_RX_LANE_HIGH],
+           stats.driverLost[CO_CAN_RX_LANE_FAST] + stats.laneLost[CO_CAN_RX_LANE_FAST],
+           stats.driverLost[CO_CAN_RX_LANE_NORMAL] + stats.laneLost[CO_CAN_RX_LANE_NORMAL], stats.highWaitMax_us);
+    if (scheme == SCHEME_LANES) {
+        printf("  %12ld", stats.highLaneWaitMax_us);
+    }
+    printf("\n");
+}
+
+int
+main(void) {
+    static const long sdoCost_us[] = {50L, 300L, 1000L};
+    unsigned i;
+
+    printf("1 Mbit/s bus at 100 %% load for %ld ms\n", SIM_US / 1000L);
+    printf("scheme  SDO cost us  high lost/sent  PDO lost  SDO lost  high wait us  lane wait us\n");
+    for (i = 0U; i < (sizeof(sdoCost_us) / sizeof(sdoCost_us[0])); i++) {
+        simulate(SCHEME_BATCH, sdoCost_us[i]);
+        simulate(SCHEME_LANES, sdoCost_us[i]);
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,133 @@
+/*
+ * Host throughput simulation of the bus analyzer: SLCAN encoder and frame ring, CO_driver_slcan.c.
+ *
+ * @file        sim_slcan.c
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations under the License.
+ */
+
+/* Frames of a 100 % loaded 1 Mbit/s bus (densest frames, no stuff bits) travel over the virtual bus into the frame
+ * ring, as the RX task hook of can_analyzer.c does. The analyzer task model encodes them in 1 kB chunks into the
+ * 8 kB UART driver TX buffer and blocks while it is full, the UART sends it at baud / 10 bytes per second. Time
+ * steps are 1 us of bus time, frames lost in the ring are counted. */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "CO_driver_slcan.h"
+#include "CO_vbus.h"
+
+#define SIM_US          1000000L
+#define BIT_RATE_KBPS   1000U
+#define UART_TX_BUF     8192U /* CAN_ANALYZER_UART_TX_BUF */
+#define CHUNK           1024U /* CAN_ANALYZER_CHUNK */
+#define ENCODE_FRAMES   5000000U
+
+#define FRAME_BITS(DLC) (47U + (8U * (uint32_t)(DLC)))
+
+static CO_CANslcan_t slcan;
+
+static uint64_t
+time_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+static double
+benchEncode(void) {
+    CO_CANslcanFrame_t frame = {0};
+    char buf[CO_CAN_SLCAN_FRAME_MAX];
+    volatile size_t bytes = 0U;
+    uint64_t start;
+    uint32_t i;
+
+    frame.DLC = 8U;
+    for (i = 0U; i < 8U; i++) {
+        frame.data[i] = (uint8_t)(i * 37U);
+    }
+    start = time_ns();
+    for (i = 0U; i < ENCODE_FRAMES; i++) {
+        frame.ident = i & 0x7FFU;
+        frame.timestamp_us = i * 111U;
+        bytes += CO_CANslcan_encode(&frame, true, buf);
+    }
+    return (double)(time_ns() - start) / ENCODE_FRAMES;
+}
+
+static void
+simulate(uint8_t DLC, uint32_t baud) {
+    CO_vbusPort_t* bus = CO_vbus_open();
+    CO_vbusPort_t* analyzer = CO_vbus_open();
+    CO_vbusFrame_t tx = {0}, rx;
+    static char chunk[CHUNK];
+    const double uartBytesPerUs = (double)baud / 10.0 / 1000000.0;
+    const uint32_t frameUs = FRAME_BITS(DLC) * 1000U / BIT_RATE_KBPS;
+    double uartBuf = 0.0;                /* bytes in the UART driver TX buffer */
+    size_t chunkLen = 0U, chunkPos = 0U; /* uart_write_bytes() in progress */
+    uint32_t frames = 0U;
+    long now, nextFrame = 0L;
+
+    if ((bus == NULL) || (analyzer == NULL)) {
+        printf("No virtual bus ports\n");
+        exit(EXIT_FAILURE);
+    }
+    CO_CANslcan_init(&slcan, true);
+    tx.DLC = DLC;
+
+    for (now = 0L; now < SIM_US; now++) {
+        if (now >= nextFrame) {
+            tx.ident = (uint16_t)(frames & 0x7FFU);
+            CO_vbus_send(bus, &tx);
+            while (CO_vbus_receive(analyzer, &rx, 0)) {
+                (void)CO_CANslcan_push(&slcan, rx.ident, rx.DLC, rx.data, (uint32_t)now);
+            }
+            frames++;
+            nextFrame += frameUs;
+        }
+
+        uartBuf = (uartBuf > uartBytesPerUs) ? (uartBuf - uartBytesPerUs) : 0.0;
+
+        if (chunkPos == chunkLen) {
+            chunkLen = CO_CANslcan_read(&slcan, chunk, sizeof(chunk));
+            chunkPos = 0U;
+        }
+        if (chunkPos < chunkLen) {
+            size_t room = UART_TX_BUF - (size_t)uartBuf;
+            size_t n = ((chunkLen - chunkPos) < room) ? (chunkLen - chunkPos) : room;
+
+            uartBuf += (double)n;
+            chunkPos += n;
+        }
+    }
+
+    printf("%3u  %7u  %8u  %8u  %6u  %10u\n", DLC, baud, frames, slcan.streamed, slcan.lost, slcan.highWater);
+    CO_vbus_close(bus);
+    CO_vbus_close(analyzer);
+}
+
+int
+main(void) {
+    static const uint8_t DLC[] = {0U, 8U};
+    static const uint32_t baud[] = {2000000U, 3000000U};
+    unsigned d, b;
+
+    printf("SLCAN encoder: %.1f ns/frame, DLC 8 with timestamp\n", benchEncode());
+    printf("1 Mbit/s bus at 100 %% load for %ld ms, ring of %u frames\n", SIM_US / 1000L, CO_CAN_SLCAN_LEN);
+    printf("DLC     baud    frames  streamed    lost  high water\n");
+    for (d = 0U; d < (sizeof(DLC) / sizeof(DLC[0])); d++) {
+        for (b = 0U; b < (sizeof(baud) / sizeof(baud[0])); b++) {
+            simulate(DLC[d], baud[b]);
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,152 @@
+/*
+ * Host model of the TX traffic shaper: TPDO delay while the node streams SDO segments.
+ *
+ * @file        sim_txshaper.c
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations under the License.
+ */
+
+/* Discrete time model with 1 us resolution of a 500 kbit/s bus. The master sends SYNC every 1 ms, the node answers
+ * with one 8 byte TPDO. Meanwhile the node streams SDO segments (as in an OTA transfer), the SDO server refills its
+ * buffer 50 us after each segment is taken. The TX task hands the highest priority buffer to the 5 deep TWAI TX
+ * queue, bulk (SDO) frames only with tokens from the bucket, as CO_CANtxShaperTake() does. Delay is measured from
+ * the end of SYNC to the end of the TPDO. */
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SIM_US          2000000L
+#define BIT_RATE_KBPS   500U
+#define SYNC_PERIOD_US  1000L
+#define SDO_REFILL_US   50L
+#define TWAI_TX_QUEUE   5U /* plus the frame in the TX buffer of the controller */
+#define PDO_MAX         (SIM_US / SYNC_PERIOD_US + 1L)
+
+#define FRAME_BITS(DLC) (47U + (8U * (uint32_t)(DLC)))
+#define FRAME_US(DLC)   ((long)(FRAME_BITS(DLC) * 1000U / BIT_RATE_KBPS))
+
+typedef enum { FRAME_NONE, FRAME_PDO, FRAME_SDO } frame_t;
+
+typedef struct {
+    long min_us, median_us, p99_us, max_us;
+    double sdoLoad;
+} simResult_t;
+
+static int
+compareLong(const void* a, const void* b) {
+    long x = *(const long*)a, y = *(const long*)b;
+
+    return (x > y) - (x < y);
+}
+
+static void
+simulate(uint16_t share_permille, uint16_t burstFrames, simResult_t* result) {
+    static long delay_us[PDO_MAX];
+    frame_t twaiQueue[TWAI_TX_QUEUE + 1U];
+    long twaiQueued_us[TWAI_TX_QUEUE + 1U];
+    unsigned twaiHead = 0U, twaiCount = 0U, delays = 0U;
+    const uint64_t depth = (uint64_t)burstFrames * FRAME_BITS(8U) * 1000U;
+    const uint64_t rate = (uint64_t)BIT_RATE_KBPS * share_permille; /* 1/1000 bit per ms */
+    const uint64_t cost = (uint64_t)FRAME_BITS(8U) * 1000U;
+    uint64_t tokens = depth;
+    long now = 0L, busFree = 0L, syncNext = 0L, sdoReady = 0L, lastRefill = 0L, sdoSent = 0L;
+    long pdoQueued = -1L, sdoQueued = -1L; /* txArray buffers, -1 if empty */
+    frame_t hold = FRAME_NONE;             /* taken by the TX task, waits for room in the TWAI queue */
+    long holdQueued = 0L;
+
+    for (now = 0L; now < SIM_US; now++) {
+        /* SYNC from the master, TPDO is queued at its reception */
+        if ((now >= syncNext) && (busFree <= now)) {
+            busFree = now + FRAME_US(0U);
+            syncNext += SYNC_PERIOD_US;
+            pdoQueued = busFree;
+        }
+        if ((sdoQueued < 0L) && (now >= sdoReady)) {
+            sdoQueued = now;
+        }
+
+        /* TX task: highest priority buffer first, bulk frame only with tokens */
+        while ((hold == FRAME_NONE) && ((pdoQueued >= 0L) || (sdoQueued >= 0L))) {
+            if (pdoQueued >= 0L) {
+                if (pdoQueued > now) {
+                    break;
+                }
+                hold = FRAME_PDO;
+                holdQueued = pdoQueued;
+                pdoQueued = -1L;
+                break;
+            }
+            if (share_permille < 1000U) {
+                tokens += ((uint64_t)(now - lastRefill) * rate) / 1000U;
+                lastRefill = now;
+                if (tokens > depth) {
+                    tokens = depth;
+                }
+                if (tokens < cost) {
+                    break;
+                }
+                tokens -= cost;
+            }
+            hold = FRAME_SDO;
+            holdQueued = sdoQueued;
+            sdoQueued = -1L;
+            sdoReady = now + SDO_REFILL_US;
+        }
+        if ((hold != FRAME_NONE) && (twaiCount < (TWAI_TX_QUEUE + 1U))) {
+            unsigned i = (twaiHead + twaiCount) % (TWAI_TX_QUEUE + 1U);
+
+            twaiQueue[i] = hold;
+            twaiQueued_us[i] = holdQueued;
+            twaiCount++;
+            hold = FRAME_NONE;
+        }
+
+        /* Bus: frames of the node in TWAI queue order, SYNC wins its slot */
+        if ((twaiCount > 0U) && (busFree <= now) && (now < syncNext)) {
+            busFree = now + FRAME_US(8U);
+            if (twaiQueue[twaiHead] == FRAME_PDO) {
+                delay_us[delays++] = busFree - twaiQueued_us[twaiHead];
+            } else {
+                sdoSent++;
+            }
+            twaiHead = (twaiHead + 1U) % (TWAI_TX_QUEUE + 1U);
+            twaiCount--;
+        }
+    }
+
+    qsort(delay_us, delays, sizeof(delay_us[0]), compareLong);
+    result->min_us = delay_us[0];
+    result->median_us = delay_us[delays / 2U];
+    result->p99_us = delay_us[(delays * 99U) / 100U];
+    result->max_us = delay_us[delays - 1U];
+    result->sdoLoad = (double)sdoSent * FRAME_BITS(8U) / ((double)BIT_RATE_KBPS * SIM_US / 1000.0);
+}
+
+int
+main(void) {
+    static const uint16_t burstFrames[] = {8U, 2U};
+    static const uint16_t share_permille[] = {1000U, 500U, 300U, 100U};
+    unsigned b, s;
+
+    printf("%u kbit/s, SYNC every %ld us, SDO stream, TWAI TX queue %u\n", BIT_RATE_KBPS, SYNC_PERIOD_US,
+           TWAI_TX_QUEUE);
+    printf("burst  share %%  TPDO delay us: min  median   p99   max  SDO bus use %%\n");
+    for (b = 0U; b < (sizeof(burstFrames) / sizeof(burstFrames[0])); b++) {
+        for (s = 0U; s < (sizeof(share_permille) / sizeof(share_permille[0])); s++) {
+            simResult_t r;
+
+            simulate(share_permille[s], burstFrames[b], &r);
+            printf("%5u  %7.1f  %18ld  %6ld  %5ld  %4ld  %13.1f\n", burstFrames[b], share_permille[s] / 10.0, r.min_us,
+                   r.median_us, r.p99_us, r.max_us, r.sdoLoad * 100.0);
+        }
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,219 @@
+/*
+ * Host test of the acceptance filter synthesis, CO_driver_filter.c.
+ *
+ * @file        test_filter.c
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations under the License.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "CO_driver_filter.h"
+
+#define RX_SIZE_MAX 64U
+#define RANDOM_SETS 3000U
+
+static uint32_t seed = 0x12345678U;
+static unsigned failures = 0U;
+
+static uint32_t
+rnd(void) {
+    /* xorshift32, same sets on every run */
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+static void
+dummyCallback(void* object, void* message) {
+    (void)object;
+    (void)message;
+}
+
+/* rxArray entry as CO_CANrxBufferInit() sets it */
+static void
+rxSet(CO_CANrx_t* rx, uint16_t ident, uint16_t mask) {
+    rx->ident = ident & 0x07FFU;
+    rx->mask = (mask & 0x07FFU) | 0x0800U;
+    rx->object = rx;
+    rx->CANrx_callback = dummyCallback;
+}
+
+static void
+fail(const char* set, const char* what, unsigned value) {
+    if (failures < 20U) {
+        printf("FAIL %s: %s (%u)\n", set, what, value);
+    }
+    failures++;
+}
+
+/* Smallest single code/mask pair over all used buffers, as reference */
+static uint16_t
+singleIds(const CO_CANrx_t rx[], uint16_t n) {
+    uint16_t care = 0x07FFU, first = 0U, i;
+    bool_t used = false;
+
+    for (i = 0U; i < n; i++) {
+        if (rx[i].CANrx_callback == NULL) {
+            continue;
+        }
+        if (!used) {
+            first = rx[i].ident;
+            used = true;
+        }
+        care &= rx[i].mask & (uint16_t)~(rx[i].ident ^ first);
+    }
+    if (!used) {
+        return CO_CAN_FILTER_ID_SPACE;
+    }
+    return (uint16_t)(1U << (11 - __builtin_popcount(care & 0x07FFU)));
+}
+
+/* Checks the filter of one set of buffers, returns false accepted identifiers */
+static unsigned
+checkSet(const char* name, CO_CANrx_t rx[], uint16_t n) {
+    CO_CANfilter_t filter;
+    uint8_t configured[CO_CAN_FILTER_ID_SPACE] = {0};
+    unsigned accepted = 0U, configuredCount = 0U;
+    uint16_t id, i;
+
+    CO_CANfilter_build(rx, n, &filter);
+
+    for (i = 0U; i < n; i++) {
+        if (rx[i].CANrx_callback == NULL) {
+            continue;
+        }
+        for (id = 0U; id < CO_CAN_FILTER_ID_SPACE; id++) {
+            if (((id ^ rx[i].ident) & rx[i].mask & 0x07FFU) == 0U) {
+                configured[id] = 1U;
+            }
+        }
+    }
+
+    for (id = 0U; id < CO_CAN_FILTER_ID_SPACE; id++) {
+        bool_t pass = CO_CANfilter_accepts(&filter, id);
+
+        if (configured[id] != 0U) {
+            configuredCount++;
+            /* no configured identifier may be rejected in hardware */
+            if (!pass) {
+                fail(name, "configured identifier rejected", id);
+            }
+        }
+        accepted += pass ? 1U : 0U;
+    }
+
+    /* acceptedIds is computed from the masks, it must match the real count */
+    if (accepted != filter.acceptedIds) {
+        fail(name, "acceptedIds differs from exhaustive count", filter.acceptedIds);
+    }
+    /* dual filter is taken only, if it is better than the single one */
+    if (filter.acceptedIds > singleIds(rx, n)) {
+        fail(name, "filter wider than single filter", filter.acceptedIds);
+    }
+    if ((filter.count == 2U) && (filter.acceptedIds >= singleIds(rx, n))) {
+        fail(name, "dual filter not narrower than single", filter.acceptedIds);
+    }
+    if (!CO_CANfilter_covers(&filter, rx, n)) {
+        fail(name, "filter does not cover its own buffers", n);
+    }
+
+    /* covers() is exact for a new single identifier buffer */
+    if (n < RX_SIZE_MAX) {
+        uint16_t extra = (uint16_t)(rnd() & 0x07FFU);
+
+        rxSet(&rx[n], extra, 0x07FFU);
+        if (CO_CANfilter_covers(&filter, rx, n + 1U) != CO_CANfilter_accepts(&filter, extra)) {
+            fail(name, "covers() differs from accepts() for added identifier", extra);
+        }
+        rx[n].CANrx_callback = NULL;
+    }
+
+    return accepted - configuredCount;
+}
+
+/* Buffers of a CANopen slave: NMT, SYNC, TIME, SDO, 4 RPDO, HB consumers */
+static uint16_t
+canopenSet(CO_CANrx_t rx[], uint8_t nodeId, uint8_t hbConsumers) {
+    static const uint16_t fixed[] = {0x000U, 0x080U, 0x100U, 0x7E5U};
+    uint16_t n = 0U, i;
+
+    for (i = 0U; i < (sizeof(fixed) / sizeof(fixed[0])); i++) {
+        rxSet(&rx[n++], fixed[i], 0x07FFU);
+    }
+    rxSet(&rx[n++], (uint16_t)(0x600U + nodeId), 0x07FFU);
+    for (i = 0U; i < 4U; i++) {
+        rxSet(&rx[n++], (uint16_t)(0x200U + (i * 0x100U) + nodeId), 0x07FFU);
+    }
+    for (i = 0U; i < hbConsumers; i++) {
+        rxSet(&rx[n++], (uint16_t)(0x700U + 1U + ((nodeId + i) % 127U)), 0x07FFU);
+    }
+    return n;
+}
+
+int
+main(void) {
+    static CO_CANrx_t rx[RX_SIZE_MAX + 1U];
+    unsigned falseAccepts = 0U, sets = 0U, worst = 0U;
+    CO_CANfilter_t filter;
+    uint16_t n, i;
+    uint8_t node;
+
+    /* nothing configured: filter stays open */
+    memset(rx, 0, sizeof(rx));
+    CO_CANfilter_build(rx, 8U, &filter);
+    if ((filter.count != 0U) || (filter.acceptedIds != CO_CAN_FILTER_ID_SPACE)) {
+        fail("empty", "filter not open", filter.count);
+    }
+
+    /* typical slave for every node-id */
+    for (node = 1U; node <= 127U; node++) {
+        memset(rx, 0, sizeof(rx));
+        n = canopenSet(rx, node, (uint8_t)(node % 5U));
+        falseAccepts += checkSet("canopen", rx, n);
+        sets++;
+    }
+    printf("CANopen slave sets: %u, false accepted identifiers avg %u\n", sets, falseAccepts / sets);
+
+    /* arbitrary identifiers, some buffers with don't-care bits, unused gaps */
+    falseAccepts = 0U;
+    for (i = 0U; i < RANDOM_SETS; i++) {
+        uint16_t k;
+        unsigned fa;
+
+        memset(rx, 0, sizeof(rx));
+        n = (uint16_t)(1U + (rnd() % RX_SIZE_MAX));
+        for (k = 0U; k < n; k++) {
+            uint32_t r = rnd();
+
+            if ((r & 0x0FU) == 0U) {
+                continue;
+            }
+            rxSet(&rx[k], (uint16_t)(r >> 8), ((r & 0xF0U) == 0U) ? (uint16_t)(0x07FFU & ~(r >> 20)) : 0x07FFU);
+        }
+        fa = checkSet("random", rx, n);
+        falseAccepts += fa;
+        if (fa > worst) {
+            worst = fa;
+        }
+    }
+    printf("Random sets: %u, false accepted identifiers avg %u, max %u\n", RANDOM_SETS, falseAccepts / RANDOM_SETS,
+           worst);
+
+    if (failures > 0U) {
+        printf("%u checks FAILED\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("All filter checks passed\n");
+    return EXIT_SUCCESS;
+}
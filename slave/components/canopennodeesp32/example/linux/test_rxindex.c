@@ -0,0 +1,231 @@
+/*
+ * Host test and lookup benchmark of the receive dispatch index, CO_driver_rxindex.c.
+ *
+ * @file        test_rxindex.c
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations under the License.
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "CO_driver_rxindex.h"
+
+#define RX_SIZE_MAX     512U
+#define LOOKUP_FRAMES   4096U /* received identifiers per benchmark round */
+#define LOOKUP_ROUNDS   200U
+#define CONCURRENT_MS   300U
+
+static uint32_t seed = 0x2468ACE1U;
+static unsigned failures = 0U;
+static CO_CANrx_t rxArray[RX_SIZE_MAX];
+static uint16_t rxSize = RX_SIZE_MAX;
+static CO_CANrxIndex_t rxIndex;
+
+static uint32_t
+rnd(void) {
+    /* xorshift32, same sets on every run */
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+static uint64_t
+time_ns(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000U) + (uint64_t)ts.tv_nsec;
+}
+
+static void
+dummyCallback(void* object, void* message) {
+    (void)object;
+    (void)message;
+}
+
+/* Configure rxArray[index] and update the index, as CO_CANrxBufferInit() does */
+static void
+rxSet(uint16_t index, uint16_t ident, uint16_t mask) {
+    CO_CANrx_t* rx = &rxArray[index];
+    uint16_t oldIdent = rx->ident, oldMask = rx->mask;
+
+    rx->ident = ident & 0x07FFU;
+    rx->mask = (mask & 0x07FFU) | 0x0800U;
+    rx->object = rx;
+    rx->CANrx_callback = dummyCallback;
+    CO_CANrxIndex_update(&rxIndex, rxArray, rxSize, index, oldIdent, oldMask);
+}
+
+static void
+rxReset(void) {
+    uint16_t i;
+
+    for (i = 0U; i < RX_SIZE_MAX; i++) {
+        rxArray[i].ident = 0U;
+        rxArray[i].mask = 0xFFFFU;
+        rxArray[i].object = NULL;
+        rxArray[i].CANrx_callback = NULL;
+    }
+    CO_CANrxIndex_init(&rxIndex);
+}
+
+/* size receivers with distinct identifiers, one masked (EMCY consumer like) in the middle */
+static void
+rxConfigure(uint16_t size) {
+    static uint8_t taken[2048];
+    uint16_t i;
+
+    rxReset();
+    rxSize = size;
+    memset(taken, 0, sizeof(taken));
+    for (i = 0U; i < size; i++) {
+        uint16_t id;
+
+        if (i == (size / 2U)) {
+            rxSet(i, 0x080U, 0x0780U);
+            continue;
+        }
+        do {
+            id = (uint16_t)(0x100U + (rnd() % 0x700U));
+        } while (taken[id] != 0U);
+        taken[id] = 1U;
+        rxSet(i, id, 0x07FFU);
+    }
+}
+
+/* Received identifiers: 3/4 of configured receivers, rest random */
+static void
+framesOf(uint16_t size, uint16_t frames[LOOKUP_FRAMES]) {
+    uint16_t i;
+
+    for (i = 0U; i < LOOKUP_FRAMES; i++) {
+        uint32_t r = rnd();
+
+        frames[i] = ((r & 3U) != 0U) ? rxArray[r % size].ident : (uint16_t)(r & 0x07FFU);
+        if (rxArray[r % size].mask != 0x0FFFU) {
+            frames[i] = (uint16_t)(0x080U + (r % 0x7FU) + 1U);
+        }
+    }
+}
+
+static void
+checkLookups(uint16_t size, const uint16_t frames[LOOKUP_FRAMES]) {
+    uint16_t i;
+
+    for (i = 0U; i < LOOKUP_FRAMES; i++) {
+        if (CO_CANrxIndex_find(&rxIndex, rxArray, rxSize, frames[i])
+            != CO_CANrxIndex_scan(rxArray, rxSize, frames[i])) {
+            if (failures < 20U) {
+                printf("FAIL %u receivers: index and scan differ for 0x%03X\n", size, frames[i]);
+            }
+            failures++;
+        }
+    }
+}
+
+/* Average ns per lookup over LOOKUP_ROUNDS rounds of LOOKUP_FRAMES */
+static double
+benchLookup(bool_t indexed, const uint16_t frames[LOOKUP_FRAMES]) {
+    volatile uintptr_t sink = 0U;
+    uint64_t start = time_ns();
+    uint32_t r, i;
+
+    for (r = 0U; r < LOOKUP_ROUNDS; r++) {
+        for (i = 0U; i < LOOKUP_FRAMES; i++) {
+            CO_CANrx_t* rx = indexed ? CO_CANrxIndex_find(&rxIndex, rxArray, rxSize, frames[i])
+                                     : CO_CANrxIndex_scan(rxArray, rxSize, frames[i]);
+            sink += (uintptr_t)rx;
+        }
+    }
+    (void)sink;
+    return (double)(time_ns() - start) / ((double)LOOKUP_ROUNDS * LOOKUP_FRAMES);
+}
+
+/* Receive task: masked receiver 0 must be found during all updates */
+static volatile bool_t concurrentRun;
+static unsigned concurrentMissed = 0U;
+static unsigned long concurrentLookups = 0U;
+
+static void*
+concurrentReader(void* arg) {
+    (void)arg;
+    while (concurrentRun) {
+        if (CO_CANrxIndex_find(&rxIndex, rxArray, rxSize, 0x081U) != &rxArray[0]) {
+            concurrentMissed++;
+        }
+        concurrentLookups++;
+    }
+    return NULL;
+}
+
+static void
+checkConcurrent(void) {
+    pthread_t reader;
+    uint64_t end;
+    unsigned long updates = 0U;
+
+    rxReset();
+    rxSize = 2U;
+    rxSet(0U, 0x080U, 0x0780U);
+    rxSet(1U, 0x201U, 0x07FFU);
+    concurrentRun = true;
+    if (pthread_create(&reader, NULL, concurrentReader, NULL) != 0) {
+        printf("FAIL concurrent: no thread\n");
+        failures++;
+        return;
+    }
+    /* PDO COB-ID changes, each rebuilds the masked list */
+    end = time_ns() + ((uint64_t)CONCURRENT_MS * 1000000U);
+    while (time_ns() < end) {
+        rxSet(1U, (uint16_t)(0x200U + (updates & 0x7FU)), 0x07FFU);
+        updates++;
+    }
+    concurrentRun = false;
+    pthread_join(reader, NULL);
+
+    printf("Concurrent: %lu updates, %lu lookups, masked receiver missed %u times\n", updates, concurrentLookups,
+           concurrentMissed);
+    if (concurrentMissed != 0U) {
+        failures++;
+    }
+}
+
+int
+main(void) {
+    static const uint16_t sizes[] = {4U, 8U, 16U, 32U, 64U, 128U, 256U, 512U};
+    static uint16_t frames[LOOKUP_FRAMES];
+    uint16_t s;
+
+    printf("receivers  scan ns/frame  index ns/frame\n");
+    for (s = 0U; s < (sizeof(sizes) / sizeof(sizes[0])); s++) {
+        double scan, index;
+
+        rxConfigure(sizes[s]);
+        framesOf(sizes[s], frames);
+        checkLookups(sizes[s], frames);
+        scan = benchLookup(false, frames);
+        index = benchLookup(true, frames);
+        printf("%9u  %13.1f  %14.1f\n", sizes[s], scan, index);
+    }
+
+    checkConcurrent();
+
+    if (failures > 0U) {
+        printf("%u checks FAILED\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("All rxindex checks passed\n");
+    return EXIT_SUCCESS;
+}
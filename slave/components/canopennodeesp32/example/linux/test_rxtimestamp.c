@@ -0,0 +1,106 @@
+/*
+ * Host test of the receive timestamp, CO_CANrxMsg_readTimestamp() in a receive callback of CO_driver_linux.c.
+ *
+ * @file        test_rxtimestamp.c
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License"); you may not use this
+ * file except in compliance with the License. You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software distributed under the License is
+ * distributed on an "AS IS" BASIS, WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and limitations under the License.
+ */
+
+/* Frames are sent from a second virtual bus port and received with CO_CANrxWait(), as the receive thread of
+ * main_linux.c does. The callback checks that every stamp is non-zero, not older than the previous one and taken
+ * between the send and the return of CO_CANrxWait(). */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "301/CO_driver.h"
+
+#define FRAMES 1000U
+
+static unsigned failures = 0U;
+static unsigned received = 0U;
+static int64_t lastStamp_us = 0;
+
+static int64_t
+time_us(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((int64_t)ts.tv_sec * 1000000) + (ts.tv_nsec / 1000);
+}
+
+static void
+rxCallback(void* object, void* message) {
+    int64_t stamp_us = CO_CANrxMsg_readTimestamp(message);
+
+    (void)object;
+    if ((stamp_us == 0) || (stamp_us < lastStamp_us)) {
+        if (failures < 20U) {
+            printf("FAIL frame %u: stamp %lld after %lld\n", received, (long long)stamp_us, (long long)lastStamp_us);
+        }
+        failures++;
+    }
+    lastStamp_us = stamp_us;
+    received++;
+}
+
+int
+main(void) {
+    static CO_CANmodule_t CANmodule;
+    static CO_CANrx_t rxArray[1];
+    static CO_CANtx_t txArray[1];
+    static int object;
+    CO_vbusPort_t* sender;
+    CO_vbusFrame_t frame = {.ident = 0x181U, .DLC = 8U};
+    unsigned i;
+
+    if ((CO_CANmodule_init(&CANmodule, CO_CAN_VBUS_NAME, rxArray, 1U, txArray, 1U, 1000U) != CO_ERROR_NO)
+        || (CO_CANrxBufferInit(&CANmodule, 0U, 0x181U, 0x7FFU, false, &object, rxCallback) != CO_ERROR_NO)
+        || ((sender = CO_vbus_open()) == NULL)) {
+        printf("FAIL no virtual bus\n");
+        return EXIT_FAILURE;
+    }
+
+    for (i = 0U; i < FRAMES; i++) {
+        int64_t sent_us = time_us();
+        int64_t returned_us;
+
+        frame.data[0] = (uint8_t)i;
+        CO_vbus_send(sender, &frame);
+        if (CO_CANrxWait(&CANmodule, 100) != 1) {
+            printf("FAIL frame %u not received\n", i);
+            failures++;
+            continue;
+        }
+        returned_us = time_us();
+        if ((lastStamp_us < sent_us) || (lastStamp_us > returned_us)) {
+            if (failures < 20U) {
+                printf("FAIL frame %u: stamp %lld outside %lld..%lld\n", i, (long long)lastStamp_us,
+                       (long long)sent_us, (long long)returned_us);
+            }
+            failures++;
+        }
+    }
+    if (received != FRAMES) {
+        printf("FAIL %u of %u frames reached the callback\n", received, FRAMES);
+        failures++;
+    }
+
+    CO_vbus_close(sender);
+    CO_CANmodule_disable(&CANmodule);
+
+    if (failures > 0U) {
+        printf("%u checks FAILED\n", failures);
+        return EXIT_FAILURE;
+    }
+    printf("All rxtimestamp checks passed, %u frames\n", received);
+    return EXIT_SUCCESS;
+}